@@ -0,0 +1,101 @@
+/*
+ * Cost of going through the C API rather than the model itself.
+ *
+ *   ./neuralmic_call_overhead model.onnx [seconds] [frames_per_call]
+ *
+ * Times neuralmic_process() from the outside and compares it with the
+ * model time the library measures inside, so the difference is the
+ * wrapper: argument checks, the frame loop, stats and the call itself.
+ * Empty calls (count 0) time the bare boundary crossing.
+ */
+
+#define _POSIX_C_SOURCE 199309L   /* clock_gettime */
+
+#include <neuralmic.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s model.onnx [seconds] [frames_per_call]\n", argv[0]);
+        return 1;
+    }
+    const int seconds = argc >= 3 ? atoi(argv[2]) : 10;
+    const int frames_per_call = argc >= 4 ? atoi(argv[3]) : 1;
+
+    neuralmic_config config;
+    neuralmic_config_init(&config);
+    config.model_path = argv[1];
+
+    neuralmic_context* ctx = NULL;
+    if (neuralmic_create(&config, &ctx) != NEURALMIC_OK)
+    {
+        fprintf(stderr, "create failed: %s\n", neuralmic_last_error(NULL));
+        return 1;
+    }
+
+    const size_t frame = (size_t)neuralmic_frame_size();
+    const size_t call_samples = frame * (size_t)frames_per_call;
+    const size_t total = (size_t)seconds * (size_t)neuralmic_sample_rate() / call_samples * call_samples;
+
+    /* A tone under noise, so the model does real work */
+    float* signal = malloc(total * sizeof(float));
+    srand(1234);
+    for (size_t i = 0; i < total; ++i)
+    {
+        float noise = ((float)rand() / RAND_MAX - 0.5f) * 0.1f;
+        signal[i] = 0.2f * sinf(2.0f * 3.14159265f * 300.0f * i / neuralmic_sample_rate()) + noise;
+    }
+
+    /* Warm-up, then reset the counters' baseline */
+    neuralmic_process(ctx, signal, call_samples);
+    neuralmic_stats before;
+    neuralmic_get_stats(ctx, &before);
+
+    double t0 = now_ns();
+    for (size_t pos = 0; pos < total; pos += call_samples)
+    {
+        neuralmic_process(ctx, signal + pos, call_samples);
+    }
+    double outside_ns = now_ns() - t0;
+
+    neuralmic_stats after;
+    neuralmic_get_stats(ctx, &after);
+    double inside_ns = (double)(after.total_ns - before.total_ns);
+    double calls = (double)(total / call_samples);
+    double frames = (double)(after.frames - before.frames);
+
+    const int empty_calls = 1000000;
+    t0 = now_ns();
+    for (int i = 0; i < empty_calls; ++i)
+    {
+        neuralmic_process(ctx, signal, 0);
+    }
+    double empty_ns = (now_ns() - t0) / empty_calls;
+
+    printf("=== C API Call Overhead (%d s, %d frame(s) per call) ===\n", seconds, frames_per_call);
+    printf("  library %s, latency %d samples\n", neuralmic_version(), neuralmic_latency(ctx));
+    printf("  per call:    %.2f us outside, %.2f us in the model\n",
+           outside_ns / calls / 1000.0, inside_ns / calls / 1000.0);
+    printf("  overhead:    %.0f ns/call (%.3f%% of the call)\n",
+           (outside_ns - inside_ns) / calls, 100.0 * (outside_ns - inside_ns) / outside_ns);
+    printf("  empty call:  %.1f ns\n", empty_ns);
+    printf("  max frame:   %.1f us, %.1fx realtime\n",
+           after.max_frame_ns / 1000.0, seconds * 1e9 / outside_ns);
+    printf("  frames: %.0f, errors: %llu\n", frames, (unsigned long long)after.errors);
+
+    free(signal);
+    neuralmic_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Denoises raw 48 kHz mono float samples through the C API.
+ *
+ *   ffmpeg -i in.wav -f f32le -ac 1 -ar 48000 in.raw
+ *   ./neuralmic_denoise_raw model.onnx in.raw out.raw [strength_db]
+ *   ffmpeg -f f32le -ac 1 -ar 48000 -i out.raw out.wav
+ *
+ * Output is delayed by neuralmic_latency() samples; this example trims
+ * that from the front and flushes it out at the end with silence.
+ */
+
+#include <neuralmic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        fprintf(stderr, "usage: %s model.onnx in.raw out.raw [strength_db]\n", argv[0]);
+        return 1;
+    }
+
+    neuralmic_config config;
+    neuralmic_config_init(&config);
+    config.model_path = argv[1];
+    config.strength_db = argc >= 5 ? (float)atof(argv[4]) : 0.0f;
+
+    neuralmic_context* ctx = NULL;
+    if (neuralmic_create(&config, &ctx) != NEURALMIC_OK)
+    {
+        fprintf(stderr, "create failed: %s\n", neuralmic_last_error(NULL));
+        return 1;
+    }
+
+    FILE* in = fopen(argv[2], "rb");
+    FILE* out = fopen(argv[3], "wb");
+    if (!in || !out)
+    {
+        fprintf(stderr, "cannot open input or output\n");
+        neuralmic_destroy(ctx);
+        return 1;
+    }
+
+    const size_t frame = (size_t)neuralmic_frame_size();
+    const size_t latency = (size_t)neuralmic_latency(ctx);
+    float* samples = malloc(frame * sizeof(float));
+    size_t read_total = 0;   /* input samples */
+    size_t pos = 0;          /* samples through the denoiser */
+    int eof = 0;
+
+    for (;;)
+    {
+        size_t got = 0;
+        if (!eof)
+        {
+            got = fread(samples, sizeof(float), frame, in);
+            read_total += got;
+            eof = got < frame;
+        }
+        if (eof && pos >= read_total + latency) break;
+        memset(samples + got, 0, (frame - got) * sizeof(float));
+
+        if (neuralmic_process(ctx, samples, frame) != NEURALMIC_OK)
+        {
+            fprintf(stderr, "process failed: %s\n", neuralmic_last_error(ctx));
+            break;
+        }
+
+        /* output sample i + latency belongs to input sample i */
+        size_t begin = pos > latency ? pos : latency;
+        size_t end = pos + frame < read_total + latency ? pos + frame : read_total + latency;
+        if (begin < end)
+        {
+            fwrite(samples + (begin - pos), sizeof(float), end - begin, out);
+        }
+        pos += frame;
+    }
+
+    neuralmic_stats stats;
+    neuralmic_get_stats(ctx, &stats);
+    fprintf(stderr, "%llu frames, %.1f us/frame avg, %.1f us max\n",
+            (unsigned long long)stats.frames,
+            stats.frames ? stats.total_ns / 1000.0 / stats.frames : 0.0,
+            stats.max_frame_ns / 1000.0);
+
+    free(samples);
+    fclose(in);
+    fclose(out);
+    neuralmic_destroy(ctx);
+    return 0;
+}
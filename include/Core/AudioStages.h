@@ -0,0 +1,130 @@
+#pragma once
+#include "Core/ProcessingGraph.h"
+#include <vector>
+#include <atomic>
+
+class NoiseSuppressor;
+
+// Second-order Butterworth high-pass (rumble, handling noise)
+class HighPassStage : public AudioStage {
+public:
+    explicit HighPassStage(float cutoff_hz = 80.0f);
+    const char* name() const override { return "highpass"; }
+    void prepare(unsigned int sample_rate, size_t max_block) override;
+    void reset() override;
+    void process(float* samples, size_t count) override;
+
+private:
+    float cutoff_hz_;
+    float b0_, b1_, b2_, a1_, a2_;
+    float z1_, z2_;
+};
+
+// Slow RMS-tracking gain towards a target level; never boosts silence
+class AgcStage : public AudioStage {
+public:
+    explicit AgcStage(float target_db = -20.0f);
+    const char* name() const override { return "agc"; }
+    void prepare(unsigned int sample_rate, size_t max_block) override;
+    void reset() override;
+    void process(float* samples, size_t count) override;
+
+private:
+    float target_rms_;
+    float envelope_;
+    float gain_;
+    float env_coef_;
+    float gain_coef_;
+};
+
+// Peak limiter with instant attack and smooth release
+class LimiterStage : public AudioStage {
+public:
+    explicit LimiterStage(float ceiling_db = -1.0f);
+    const char* name() const override { return "limiter"; }
+    void prepare(unsigned int sample_rate, size_t max_block) override;
+    void reset() override;
+    void process(float* samples, size_t count) override;
+
+private:
+    float ceiling_;
+    float gain_;
+    float release_coef_;
+};
+
+// Remembers the unprocessed signal for a later DryWetStage
+class DryTapStage : public AudioStage {
+public:
+    const char* name() const override { return "drytap"; }
+    void prepare(unsigned int sample_rate, size_t max_block) override;
+    void reset() override;
+    void process(float* samples, size_t count) override;
+
+    // Dry sample written `delay` samples before the current block's i-th
+    float delayed(size_t i, size_t delay) const;
+
+private:
+    std::vector<float> history_;
+    size_t write_pos_;
+    size_t block_start_;
+};
+
+// Blends processed and dry signal; the dry path is delayed to match the
+// latency of the stages in between
+class DryWetStage : public AudioStage {
+public:
+    DryWetStage(const DryTapStage& tap, float wet, size_t delay);
+    const char* name() const override { return "mix"; }
+    void process(float* samples, size_t count) override;
+
+private:
+    const DryTapStage& tap_;
+    float wet_;
+    size_t delay_;
+};
+
+// EBU R128 style loudness meter (K-weighted, 400 ms momentary,
+// absolute-gated integrated). Measures only, leaves samples untouched.
+class LoudnessMeterStage : public AudioStage {
+public:
+    const char* name() const override { return "loudness"; }
+    void prepare(unsigned int sample_rate, size_t max_block) override;
+    void reset() override;
+    void process(float* samples, size_t count) override;
+
+    float momentaryLufs() const { return momentary_lufs_.load(std::memory_order_relaxed); }
+    float integratedLufs() const { return integrated_lufs_.load(std::memory_order_relaxed); }
+
+private:
+    struct Biquad {
+        float b0, b1, b2, a1, a2;
+        float z1 = 0.0f, z2 = 0.0f;
+        float run(float x);
+    };
+
+    Biquad shelf_;
+    Biquad highpass_;
+    size_t block_samples_;       // 100 ms
+    size_t block_fill_;
+    double block_energy_;
+    double recent_[4];           // last four 100 ms blocks
+    size_t recent_count_;
+    double gated_sum_;
+    uint64_t gated_blocks_;
+    std::atomic<float> momentary_lufs_;
+    std::atomic<float> integrated_lufs_;
+};
+
+// A noise suppression engine in hop-sized blocks, in place, with its own state
+class DenoiserStage : public AudioStage {
+public:
+    explicit DenoiserStage(NoiseSuppressor& model);
+    const char* name() const override { return "denoise"; }
+    void reset() override;
+    void process(float* samples, size_t count) override;
+    size_t latency() const override;
+    size_t blockSize() const override;
+
+private:
+    NoiseSuppressor& model_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+// Line-based control socket for a running session.
+//
+//   $ echo "set atten -20" | socat - UNIX-CONNECT:/tmp/neuralmic.ctl
+//   ok atten -20
+//
+// Each request is one line: a command word followed by arguments. The
+// handler's return value is sent back as one line. Handlers run on the
+// control thread, never on the audio thread. Register commands before
+// start(); the table is not locked afterwards.
+using ControlHandler = std::function<std::string(const std::vector<std::string>& args)>;
+
+class ControlServer {
+public:
+    ControlServer();
+    ~ControlServer();
+
+    void addCommand(const std::string& name, const std::string& usage, ControlHandler handler);
+
+    bool start(const std::string& socket_path);
+    void stop();
+
+private:
+    struct Command {
+        std::string usage;
+        ControlHandler handler;
+    };
+
+    void serve();
+    std::string dispatch(const std::string& line);
+
+    std::map<std::string, Command> commands_;
+    std::string socket_path_;
+    int listen_fd_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+};
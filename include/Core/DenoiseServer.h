@@ -0,0 +1,104 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <semaphore>
+#include <climits>
+#include <cstdint>
+#include "Core/MemoryProfile.h"
+
+class DeepFilterNet;
+
+// Wire protocol (Unix stream socket):
+//   server -> client  DenoiseHello, once after accept
+//   client -> server  HOP_SIZE float32 samples per frame
+//   server -> client  HOP_SIZE enhanced float32 samples per frame, in order
+// A server at capacity closes the connection without sending the hello.
+struct DenoiseHello {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sample_rate;
+    uint32_t hop_size;
+};
+
+struct DenoiseClientStats {
+    uint64_t frames = 0;
+    double total_ms = 0.0;      // receive complete -> reply sent
+    double wait_ms = 0.0;       // time spent waiting for an inference slot
+    double max_ms = 0.0;
+    uint64_t over_budget = 0;   // frames slower than one hop (10 ms)
+};
+
+// Keeps one model loaded and serves many client streams, each with its own
+// recurrent state. Inference concurrency is capped at the worker count so
+// extra clients queue for a slot instead of oversubscribing the cores; a
+// client that stops reading replies stalls only its own stream.
+class DenoiseServer {
+public:
+    DenoiseServer();
+    ~DenoiseServer();
+
+    // Low-memory profiles also hand the arena back when the last client leaves
+    bool loadModel(const std::string& model_path, const MemoryProfile& memory = {});
+    // Clients connecting afterwards start from this saved state instead of zeros
+    bool loadWarmState(const std::string& path);
+    void setNoiseSuppressionStrength(float db);
+
+    bool start(const std::string& socket_path, int workers, int max_clients);
+    void run();    // blocks until SIGINT or stop()
+    void stop();
+
+private:
+    struct Client {
+        int fd = -1;
+        int id = 0;
+        std::thread thread;
+        std::atomic<bool> done{false};
+        DenoiseClientStats stats;
+    };
+
+    void acceptClient();
+    void serveClient(Client* client);
+    void reapClients(bool wait_all);
+    void printStats();
+    void printMemory();
+
+    std::unique_ptr<DeepFilterNet> model_;
+    std::unique_ptr<std::counting_semaphore<INT_MAX>> inference_slots_;
+
+    std::string socket_path_;
+    int listen_fd_;
+    int max_clients_;
+    int next_client_id_;
+    std::atomic<bool> running_;
+
+    std::mutex clients_mutex_;
+    std::vector<std::unique_ptr<Client>> clients_;
+
+    std::atomic<uint64_t> frames_served_;
+    uint64_t last_report_frames_;   // accept loop only
+};
+
+// Minimal blocking client for the protocol above
+class DenoiseClient {
+public:
+    DenoiseClient();
+    ~DenoiseClient();
+
+    bool connect(const std::string& socket_path);
+    bool processFrame(const float* in, float* out);
+    void close();
+
+    int hopSize() const { return hop_size_; }
+
+private:
+    int fd_;
+    int hop_size_;
+};
+
+// Spawns paced clients against a running daemon and reports round-trip
+// latency per client. Returns non-zero if any client failed.
+int runDenoiseLoadTest(const std::string& socket_path, int clients, int seconds);
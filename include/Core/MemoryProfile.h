@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Session memory settings. The default favours speed; LowMemory() trades
+// some per-Run allocation work for a smaller arena that can be handed back.
+struct MemoryProfile {
+    bool use_arena = true;          // off: allocations go straight to malloc
+    bool arena_exact = false;       // grow by what is requested, not powers of two
+    size_t arena_limit = 0;         // bytes, 0 = unlimited
+    bool mem_pattern = true;        // pre-planned Run buffers; faster, larger
+    bool shrink_on_idle = false;    // ReleaseIdleMemory() returns free arena chunks
+
+    static MemoryProfile LowMemory();
+    // "default", "low" or "low:<MiB arena cap>"
+    static bool Parse(const std::string& spec, MemoryProfile& profile);
+};
+
+struct ModelMemoryUsage {
+    size_t model_bytes = 0;   // RSS growth while creating the session (weights + graph)
+    size_t arena_bytes = 0;   // RSS growth over the warm-up run
+    size_t state_bytes = 0;   // built-in stream state and K-hop queues
+};
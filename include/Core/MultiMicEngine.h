@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <semaphore>
+#include <climits>
+#include <cstdint>
+#include "Core/MemoryProfile.h"
+#include "Utils/MicReader.h"
+
+class DeepFilterNet;
+struct StreamState;
+
+struct MicStreamStats {
+    int id = 0;
+    std::string device;
+    uint64_t frames = 0;
+    uint64_t bypassed = 0;      // no inference slot within the hop budget; passed through dry
+    uint64_t over_budget = 0;   // hops slower than 10 ms end to end
+    double avg_ms = 0.0;
+    double max_ms = 0.0;
+    XrunStats xruns;
+};
+
+// Several capture devices denoised at once in one process. All streams
+// share one loaded model (weights and session) and keep their own
+// recurrent state; inference concurrency is capped at the worker count.
+// A stream that cannot get a slot within its hop budget passes that hop
+// through dry, delayed to line up with the model's output, rather than
+// falling behind the device; its state carries on across the gap.
+class MultiMicEngine {
+public:
+    MultiMicEngine();
+    ~MultiMicEngine();
+
+    bool loadModel(const std::string& model_path, int workers, const MemoryProfile& memory = {});
+    // Streams added afterwards start from this saved state instead of zeros
+    bool loadWarmState(const std::string& path);
+    void setNoiseSuppressionStrength(float db);
+
+    std::vector<std::string> listMicrophones();
+    bool addMicrophone(int index);
+    // Each stream publishes to "<prefix><stream id>"
+    bool enableSharedOutput(const std::string& prefix);
+
+    bool initialize();
+    void run();    // blocks until Ctrl+C
+    void stop();
+
+    std::vector<MicStreamStats> stats() const;
+    void printStats() const;
+
+    // Paced synthetic streams, one more at a time, until more than 1% of
+    // hops miss the budget. Reports the sustainable streams per core.
+    int benchmarkStreams(int seconds, int max_streams);
+
+private:
+    struct Stream {
+        int id = 0;
+        std::string device;
+        std::unique_ptr<MicrophoneReader> reader;
+        std::unique_ptr<StreamState> state;
+        std::vector<float> frame;
+        std::vector<int16_t> dry_delay;   // raw input, model latency behind
+        size_t dry_pos = 0;
+        std::thread thread;
+
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> bypassed{0};
+        std::atomic<uint64_t> over_budget{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+    };
+
+    std::unique_ptr<Stream> createStream(int id, const std::string& device);
+    void processHop(Stream& stream, int16_t* samples, size_t count);
+
+    std::unique_ptr<DeepFilterNet> model_;
+    std::unique_ptr<std::counting_semaphore<INT_MAX>> inference_slots_;
+    int workers_;
+
+    std::vector<std::unique_ptr<Stream>> streams_;
+    std::vector<std::string> available_mics_;
+    std::string shm_prefix_;
+    bool initialized_;
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <functional>
+
+// Streaming noise suppression engine: 48 kHz mono in HOP_SIZE frames, with
+// state carried between calls. DeepFilterNet is the neural engine;
+// SpectralGate is the DSP fallback for hosts that can't afford it.
+class NoiseSuppressor {
+public:
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int HOP_SIZE = 480;
+
+    virtual ~NoiseSuppressor() = default;
+
+    virtual const char* EngineName() const = 0;
+    virtual void reset() = 0;
+    // dB, 0 (engine default) down to -100 (most aggressive)
+    virtual void SetNoiseSuppressionStrength(float db) = 0;
+
+    // Receives offline output in order, a run at a time
+    using OfflineSink = std::function<void(const float* samples, size_t count)>;
+
+    // Offline: whole signal in, whole (delay-compensated) signal out
+    virtual std::vector<float> ApplyNoiseSuppression(const std::vector<float>& audio) = 0;
+    // Same without copies: output[i] lines up with input[i], input reads as
+    // silence past its end, and output may be any length
+    virtual void ApplyNoiseSuppression(std::span<const float> input, std::span<float> output) = 0;
+    // Same, handing output_length samples to a sink as they are produced
+    virtual void ApplyNoiseSuppression(std::span<const float> input, size_t output_length,
+                                       const OfflineSink& sink) = 0;
+    // Streaming: exactly HOP_SIZE samples; `out` may alias `frame`
+    virtual void ProcessRealtimeFrame(const float* frame, float* out) = 0;
+    // Output delay of the streaming path, in samples
+    virtual int StreamLatency() const = 0;
+};
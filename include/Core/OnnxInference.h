@@ -0,0 +1,151 @@
+#pragma once
+#include <onnxruntime_cxx_api.h>
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <iosfwd>
+#include "Core/MemoryProfile.h"
+#include "Core/NoiseSuppressor.h"
+#include "Core/StagePipeline.h"
+
+// Recurrent state of one stream. Double-buffered so each Run() writes the
+// next state straight into place and the halves swap afterwards; the
+// enhanced output lands in its own buffer, so callers may process in place.
+struct StreamState {
+    std::vector<float> current;
+    std::vector<float> next;
+    std::vector<float> enhanced;
+
+    void reset();
+
+    // Checkpoint of `current`, which is everything the model carries from
+    // one hop to the next: "NMST", version, size, then native floats.
+    // load() throws on a file that isn't one or doesn't fit this model.
+    void save(std::ostream& out) const;
+    void load(std::istream& in);
+    void save(const std::string& path) const;
+    void load(const std::string& path);
+};
+
+// DeepFilterNetV3 streaming inference (48 kHz, 480-sample hop)
+class DeepFilterNet : public NoiseSuppressor {
+public:
+    static constexpr int FFT_SIZE = 960;
+    static constexpr int STATE_SIZE = 45304;
+
+    // hops_per_run: hops fed to each Run(). 0 takes whatever the export's
+    // input_frame shape fixes (1 for the stock model); exports with a
+    // dynamic frame dimension accept any K. Larger K trades K-1 hops of
+    // streaming latency for fewer, cheaper Run() calls.
+    // profile_prefix: non-empty turns on ORT session profiling, written
+    // to <prefix>_<date>.json by EndProfiling()
+    // console_output: model summary and progress lines on stdout; embedding
+    // hosts turn it off per instance
+    explicit DeepFilterNet(const std::string& model_path, int hops_per_run = 0,
+                           const MemoryProfile& memory = {},
+                           const std::string& profile_prefix = {},
+                           bool console_output = true);
+    ~DeepFilterNet() override;
+
+    const char* EngineName() const override { return "deepfilternet"; }
+    void reset() override;
+    // Safe to call from any thread; picked up by the next frame
+    void SetNoiseSuppressionStrength(float db) override;
+
+    // Offline: whole signal in, whole (delay-compensated) signal out,
+    // rounded up to whole hops
+    std::vector<float> ApplyNoiseSuppression(const std::vector<float>& audio) override;
+    // Copy-free: runs read the input in place (only the last, partial run
+    // is staged), padding and delay trimming are done by offsets
+    void ApplyNoiseSuppression(std::span<const float> input, std::span<float> output) override;
+    void ApplyNoiseSuppression(std::span<const float> input, size_t output_length,
+                               const OfflineSink& sink) override;
+
+    // Streaming: exactly HOP_SIZE samples in/out, state carried between calls.
+    // With K > 1 hops are queued and run K at a time, so output lags by
+    // StreamLatency() instead of the model's own look-ahead.
+    std::vector<float> ProcessRealtimeFrame(const std::vector<float>& frame);
+    // Same, without allocating; `out` may alias `frame`
+    void ProcessRealtimeFrame(const float* frame, float* out) override;
+
+    int HopsPerRun() const { return hops_per_run_; }
+    int StreamLatency() const override {
+        return FFT_SIZE - HOP_SIZE + (hops_per_run_ - 1) * HOP_SIZE + (pipeline_ ? HOP_SIZE : 0);
+    }
+
+    // Streams ProcessRealtimeFrame() through two stage exports on their own
+    // threads instead of this session, one hop later. Offline and
+    // caller-state processing keep using the full model. Needs K = 1 and
+    // no warm state; the stages keep their own state, so warm states and
+    // SaveState()/RestoreState() throw once a pipeline is enabled.
+    void EnablePipeline(const PipelineConfig& config);
+    const StagePipeline* Pipeline() const { return pipeline_.get(); }
+
+    // Streaming against caller-owned recurrent state. The session is shared
+    // and Run() is thread-safe, so one loaded model can serve many streams.
+    // Run() itself does not touch the heap on our side; ORT's own
+    // allocations are counted under the "onnxruntime" exemption.
+    StreamState CreateStreamState() const;
+    void ProcessStreamFrame(const float* frame, float* out, StreamState& state);
+    // `hops` consecutive hops in one Run(), state carried through inside the model
+    void ProcessStreamFrames(const float* frames, float* out, int hops, StreamState& state);
+
+    // Warm start: once set, reset() and CreateStreamState() start from this
+    // state instead of zeros, so new streams skip the cold-start period.
+    // Set it before streams are created; it is read without locking.
+    void SetWarmState(const StreamState& warm);
+    void LoadWarmState(const std::string& path);
+    bool HasWarmState() const { return !warm_state_.current.empty(); }
+    // Runs `audio` from a zero state on scratch state and returns where it
+    // ends up, for capturing warm states from typical input
+    StreamState CaptureState(std::span<const float> audio);
+
+    // Handoff of this object's own stream to another instance, thread or
+    // process: the recurrent state plus hops queued for the next K-hop run
+    void SaveState(std::ostream& out) const;
+    void RestoreState(std::istream& in);
+
+    float GetNoiseSuppressionStrength() const { return atten_lim_db_.load(std::memory_order_relaxed); }
+
+    ModelMemoryUsage GetMemoryUsage() const;
+    const MemoryProfile& GetMemoryProfile() const { return memory_profile_; }
+    // With shrink_on_idle, runs one throwaway hop that hands unused arena
+    // chunks back to the OS. Call when streams go quiet, not per frame.
+    void ReleaseIdleMemory();
+    // Stops profiling and returns the JSON file's path. The constructor's
+    // warm-up is the first model_run in it.
+    std::string EndProfiling();
+
+private:
+    std::vector<float> GetEnhancedFrame(const std::vector<float>& frame);
+    void PrintModelSummary() const;
+    void ApplyMemoryProfile();
+    void RunModel(const float* frames, float* out, int hops, StreamState& state,
+                  const Ort::RunOptions& run_options);
+
+    Ort::Env env_;
+    Ort::SessionOptions session_options_;
+    Ort::Session session_;
+    Ort::MemoryInfo memory_info_;
+    Ort::AllocatorWithDefaultOptions allocator;
+
+    StreamState state_;
+    StreamState warm_state_;   // empty unless a warm start is set
+    std::unique_ptr<StagePipeline> pipeline_;
+    std::atomic<float> atten_lim_db_;
+
+    int model_frame_hops_;   // fixed by the export, 0 if dynamic
+    size_t model_frame_rank_;
+    size_t model_output_rank_;
+    int hops_per_run_;
+    std::vector<float> batch_in_;
+    std::vector<float> batch_out_;
+    int batch_fill_;
+
+    MemoryProfile memory_profile_;
+    ModelMemoryUsage memory_usage_;
+
+    bool console_output_;
+};
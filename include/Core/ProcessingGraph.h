@@ -0,0 +1,104 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+// One in-place processing step. prepare() runs off the audio thread and is
+// where a stage allocates; process() must not allocate or copy the block.
+class AudioStage {
+public:
+    virtual ~AudioStage() = default;
+
+    virtual const char* name() const = 0;
+    virtual void prepare(unsigned int /*sample_rate*/, size_t /*max_block*/) {}
+    virtual void reset() {}
+    virtual void process(float* samples, size_t count) = 0;
+
+    // Delay this stage adds, in samples; offline runs compensate for it
+    virtual size_t latency() const { return 0; }
+    // Blocks must be a multiple of this (e.g. the model hop)
+    virtual size_t blockSize() const { return 1; }
+};
+
+struct StageTiming {
+    std::string name;
+    uint64_t calls = 0;
+    double mean_us = 0.0;
+    double max_us = 0.0;
+};
+
+// Ordered chain of in-place stages sharing one preallocated block.
+// The same graph runs per hop in realtime mode and over a whole signal in
+// file mode. Stages can be bypassed at run time without touching the chain.
+class ProcessingGraph {
+public:
+    ProcessingGraph();
+    ~ProcessingGraph();
+
+    void addStage(std::unique_ptr<AudioStage> stage);
+    void clear();
+
+    void prepare(unsigned int sample_rate, size_t max_block);
+    void reset();
+
+    // Realtime: count <= max_block and a multiple of blockSize()
+    void process(float* samples, size_t count);
+
+    // File mode: pads, runs in max_block steps and removes the graph's
+    // latency in place, so the output lines up with the input
+    void processOffline(std::vector<float>& audio);
+    // Same over caller-owned storage: the first `count` samples are the
+    // signal and the span must hold offlineSize(count), so nothing is
+    // reallocated or copied
+    void processOffline(std::span<float> storage, size_t count);
+    size_t offlineSize(size_t count) const;
+
+    bool setStageEnabled(const std::string& name, bool enabled);
+    size_t latency() const;
+    size_t blockSize() const;
+    size_t stageCount() const { return stages_.size(); }
+
+    std::vector<StageTiming> timings() const;
+    void printTimings() const;
+
+private:
+    struct Slot {
+        std::unique_ptr<AudioStage> stage;
+        std::atomic<bool> enabled{true};
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+    };
+
+    std::vector<std::unique_ptr<Slot>> stages_;
+    unsigned int sample_rate_;
+    size_t max_block_;
+};
+
+// Stage factories by name, filled at build time by AudioStages.cpp.
+// Graph specs are comma-separated "name[:param]" lists, e.g.
+//   highpass:80,agc,denoise,limiter:-1,loudness
+// "denoise" is supplied by the caller since it wraps a loaded model.
+// "mix:<wet>" expands to a dry tap before denoise and a dry/wet mix after.
+using StageFactory = std::function<std::unique_ptr<AudioStage>(const std::string& param)>;
+
+class StageRegistry {
+public:
+    static StageRegistry& instance();
+
+    void add(const std::string& name, StageFactory factory);
+    std::unique_ptr<AudioStage> create(const std::string& name, const std::string& param) const;
+    std::vector<std::string> names() const;
+
+private:
+    std::map<std::string, StageFactory> factories_;
+};
+
+// Builds a graph from a spec; throws std::invalid_argument on unknown names
+void buildGraph(const std::string& spec, ProcessingGraph& graph,
+                std::unique_ptr<AudioStage> denoise_stage);
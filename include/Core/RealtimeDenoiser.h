@@ -0,0 +1,163 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include "Core/RuntimeControl.h"
+#include "Core/ProcessingGraph.h"
+#include "Core/MemoryProfile.h"
+#include "Core/StagePipeline.h"
+#include "Utils/MemoryStats.h"
+#include "Utils/SessionRecorder.h"
+#include "Core/SpectralGate.h"
+
+class DeepFilterNet;
+class MicrophoneReader;
+class ControlServer;
+
+class RealtimeDenoiser {
+public:
+    RealtimeDenoiser();
+    ~RealtimeDenoiser();
+
+    // hops_per_run > 1 batches hops per inference call at K-1 hops of
+    // extra latency; 0 uses what the model export fixes
+    bool loadModel(const std::string& model_path, int hops_per_run = 0);
+    // Same, on a background thread, so devices can be probed and opened
+    // meanwhile. Audio passes through (delayed to match the model) until
+    // the model is warm, then crossfades over as a hot swap would.
+    bool loadModelAsync(const std::string& model_path, int hops_per_run = 0);
+    // Applies to models loaded or swapped in afterwards
+    void setMemoryProfile(const MemoryProfile& profile) { memory_profile_ = profile; }
+    // Saved stream state that models loaded or swapped in afterwards start
+    // from, instead of converging from zeros on live audio
+    void setWarmState(const std::string& path) { warm_state_path_ = path; }
+    // Runs models loaded or swapped in afterwards as two pipelined stages
+    // on their own threads, one hop later (see StagePipeline)
+    void setPipeline(const PipelineConfig& config) { pipeline_config_ = config; }
+
+    // Loads and warms up a model on a background thread, then crossfades
+    // to it at a frame boundary without stopping the stream. Returns false
+    // if a swap is already in progress.
+    bool swapModel(const std::string& model_path);
+    void setNoiseSuppressionStrength(float strength);
+
+    // "dfn" (the model), "gate" (SpectralGate) or "auto": the model, falling
+    // back to the gate while it can't keep up with the hop budget.
+    // Switches crossfade over 40 ms; safe while streaming.
+    bool setEngineMode(const std::string& mode);
+    std::string engineStatus() const;
+
+    std::vector<std::string> listMicrophones();
+    std::vector<std::string> listSpeakers();
+    bool selectMicrophone(int index);
+    bool selectSpeaker(int index);
+    void enableMonitoring(bool enable);
+    bool enableSharedOutput(const std::string& shm_name);
+    bool enableControlSocket(const std::string& socket_path);
+
+    // Writes <prefix>-raw.wav and <prefix>-denoised.wav from a background
+    // thread; can start and stop while streaming
+    bool startRecording(const std::string& path_prefix);
+    void stopRecording();
+
+    // Stages around the model, e.g. "highpass,denoise,limiter" (see
+    // ProcessingGraph.h). Defaults to "denoise" alone.
+    bool setGraph(const std::string& spec);
+
+    // Lock-free parameter targets, applied at the next frame boundary
+    RuntimeControl& control() { return control_; }
+
+    bool initialize();
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    MemoryReport memoryReport() const;
+
+private:
+    void processAudioFrame(int16_t* samples, size_t count);
+    void denoiseFrames(float* samples, size_t count);
+    void runModelHop(float* frame);
+    void completeModelHandover();
+    void updateAutoFallback(bool model_ran);
+    void convertToFloat(const int16_t* samples, float* out, size_t count);
+    void runModelSwap(std::string model_path, int hops_per_run);
+    void ensureMicReader();
+    void recordStartupPhase(const char* name, std::chrono::steady_clock::time_point start);
+    void printStartupReport();
+    void finishModelSwap();
+    bool modelLoaded() const { return live_hops_per_run_.load(std::memory_order_acquire) > 0; }
+    void publishLiveModel();
+    void convertToInt16(const float* samples, int16_t* out, size_t count);
+
+    MemoryProfile memory_profile_;
+    std::string warm_state_path_;
+    PipelineConfig pipeline_config_;
+    std::unique_ptr<DeepFilterNet> denoiser_;     // replaced by the audio thread while streaming
+    // denoiser_'s K, 0 while no model is live: what other threads read
+    // instead of touching denoiser_
+    std::atomic<int> live_hops_per_run_;
+    std::atomic<size_t> live_model_bytes_;        // denoiser_'s ModelMemoryUsage, for memoryReport()
+    std::atomic<size_t> live_arena_bytes_;
+    std::atomic<size_t> live_state_bytes_;
+    std::unique_ptr<MicrophoneReader> mic_reader_;
+    std::unique_ptr<ControlServer> control_server_;
+
+    RuntimeControl control_;
+    ParamRamper ramper_;        // audio thread only
+
+    // Hot swap: loader thread -> audio thread -> loader thread
+    std::thread swap_thread_;
+    std::atomic<bool> swap_in_progress_;
+    std::atomic<bool> swap_abort_;
+    std::atomic<DeepFilterNet*> pending_model_;   // loaded, waiting for a frame boundary
+    std::atomic<DeepFilterNet*> retired_model_;   // replaced, waiting to be destroyed
+    DeepFilterNet* incoming_model_;               // audio thread only, crossfading in
+    int crossfade_frame_;
+    std::vector<float> swap_frame_;               // incoming model's output during the crossfade
+    std::vector<float> bypass_delay_;             // dry path while no model is loaded yet
+    size_t bypass_pos_;
+
+    // Fallback engine
+    enum class EngineMode { Model, Gate, Auto };
+    SpectralGate fallback_;
+    std::vector<float> gate_frame_;
+    std::atomic<int> engine_mode_;
+    std::atomic<bool> fallback_active_;           // published for status
+    std::atomic<uint64_t> auto_fallbacks_;
+    float gate_mix_;                              // audio thread only: 0 model .. 1 gate
+    float model_load_;                            // smoothed model time over the hop budget
+    bool on_fallback_;
+    bool model_skipped_;
+    int fallback_hops_;
+
+    // Startup timing: phases from the main and loader threads, milestones
+    // stamped by the audio thread
+    struct StartupPhase {
+        std::string name;
+        double start_ms;
+        double duration_ms;
+    };
+    std::chrono::steady_clock::time_point created_at_;
+    std::mutex startup_mutex_;
+    std::vector<StartupPhase> startup_phases_;
+    std::atomic<int64_t> first_audio_ns_;
+    std::atomic<int64_t> model_live_ns_;
+
+    ProcessingGraph graph_;
+    std::string graph_spec_;
+    std::vector<float> float_frame_;              // one hop, processed in place
+    SessionRecorder recorder_;
+
+    std::vector<std::string> available_mics_;
+    std::vector<std::string> available_speakers_;
+
+    bool initialized_;
+    std::atomic<bool> running_;
+    bool monitoring_enabled_;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Runtime-tunable parameters as seen at one frame boundary
+struct RuntimeParams {
+    float atten_lim_db = 0.0f;
+    bool monitor_enabled = false;
+    float gate_threshold_db = -100.0f;   // -100 dBFS and below = gate off
+    float output_gain_db = 0.0f;
+};
+
+// Parameter targets shared between control threads and the audio thread.
+// Setters may be called from anywhere; the audio thread takes one snapshot
+// per frame. Relaxed atomics only: no locks, no I/O, no allocation.
+class RuntimeControl {
+public:
+    void setAttenuation(float db);
+    void setMonitorEnabled(bool enabled);
+    void setGateThreshold(float db);
+    void setOutputGain(float db);
+
+    RuntimeParams snapshot() const;
+
+private:
+    std::atomic<float> atten_lim_db_{0.0f};
+    std::atomic<bool> monitor_enabled_{false};
+    std::atomic<float> gate_threshold_db_{-100.0f};
+    std::atomic<float> output_gain_db_{0.0f};
+};
+
+// Audio-thread follower for RuntimeControl snapshots. Attenuation moves a
+// few dB per frame; gain and gate are ramped per sample across each frame
+// so no update ever steps the waveform.
+class ParamRamper {
+public:
+    ParamRamper();
+
+    void reset(const RuntimeParams& params);
+
+    // Call once per frame; returns the attenuation to feed the model
+    float beginFrame(const RuntimeParams& target);
+
+    // Applies output gain and the noise gate in place
+    void process(float* samples, size_t count);
+
+private:
+    float atten_db_;
+    float gain_;
+    float gain_target_;
+    float gate_;
+    float gate_threshold_db_;
+    int gate_hold_frames_;
+};
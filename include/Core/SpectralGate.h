@@ -0,0 +1,54 @@
+#pragma once
+#include "Core/NoiseSuppressor.h"
+#include <vector>
+#include <atomic>
+
+// Non-neural fallback: 960-sample sqrt-Hann STFT at the model's hop, a
+// per-bin noise floor from minimum tracking of the smoothed power, and a
+// decision-directed Wiener gain with a floor set by the strength. Costs
+// tens of microseconds per hop and has the same 480-sample delay as the
+// model, so the two can be crossfaded sample-aligned.
+class SpectralGate : public NoiseSuppressor {
+public:
+    static constexpr int WINDOW_SIZE = 960;
+    static constexpr int FFT_SIZE = 1024;    // window zero-padded to a power of two
+    static constexpr int BINS = FFT_SIZE / 2 + 1;
+    static constexpr float DEFAULT_FLOOR_DB = -25.0f;   // max attenuation at strength 0
+
+    SpectralGate();
+
+    const char* EngineName() const override { return "spectral-gate"; }
+    void reset() override;
+    void SetNoiseSuppressionStrength(float db) override;
+
+    std::vector<float> ApplyNoiseSuppression(const std::vector<float>& audio) override;
+    void ApplyNoiseSuppression(std::span<const float> input, std::span<float> output) override;
+    void ApplyNoiseSuppression(std::span<const float> input, size_t output_length,
+                               const OfflineSink& sink) override;
+    void ProcessRealtimeFrame(const float* frame, float* out) override;
+    int StreamLatency() const override { return WINDOW_SIZE - HOP_SIZE; }
+
+private:
+    void fft(float* re, float* im) const;
+    void updateGains();
+
+    std::atomic<float> strength_db_;
+
+    // Fixed tables
+    std::vector<float> window_;
+    std::vector<float> twiddle_re_;
+    std::vector<float> twiddle_im_;
+    std::vector<int> bit_reverse_;
+
+    // Per-stream state
+    std::vector<float> input_;       // last WINDOW_SIZE samples
+    std::vector<float> overlap_;     // second half of the previous synthesis frame
+    std::vector<float> re_;
+    std::vector<float> im_;
+    std::vector<float> power_;
+    std::vector<float> smoothed_;
+    std::vector<float> noise_;
+    std::vector<float> prev_clean_;  // |G X|^2 of the previous frame
+    std::vector<float> gain_;
+    bool primed_;
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <onnxruntime_cxx_api.h>
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include "Core/MemoryProfile.h"
+
+// Two stage exports of the model, e.g. the encoder and the ERB/DF decoders
+struct PipelineConfig {
+    std::string stage_paths[2];
+    int stage_cpus[2] = {-1, -1};   // -1 leaves the thread unpinned
+
+    bool enabled() const { return !stage_paths[0].empty(); }
+
+    // "stage1.onnx,stage2.onnx[@cpu1,cpu2]"
+    static bool Parse(const std::string& spec, PipelineConfig& config);
+    // Built with NEURALMIC_STAGE_PIPELINE; the stage exports it needs are
+    // not produced by anything in this repo
+    static bool Available();
+};
+
+struct PipelineTiming {
+    uint64_t hops = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// Runs the model as two sessions on their own (optionally pinned) threads,
+// so stage 1 works on hop i while stage 2 finishes hop i-1. The caller's
+// per-hop cost drops from the whole graph to a handoff, and one core no
+// longer has to fit the full model in a hop; output comes one hop later.
+//
+// Stage exports follow the streaming model's names. Stage 1 takes
+// input_frame and optionally states / atten_lim_db; stage 2 gives
+// enhanced_audio_frame. Each stage keeps its own states -> new_states
+// pair. Every other stage 1 output is an intermediate that stage 2 takes
+// as an input of the same name; stage 2 may also take input_frame. All
+// shapes must be fixed, so every buffer is allocated up front.
+class StagePipeline {
+public:
+    // Loads both stages and starts their threads. Throws if a stage fails
+    // to load or the two don't fit together.
+    StagePipeline(const PipelineConfig& config, const MemoryProfile& memory,
+                  const std::atomic<float>& atten_lim_db);
+    ~StagePipeline();
+
+    StagePipeline(const StagePipeline&) = delete;
+    StagePipeline& operator=(const StagePipeline&) = delete;
+
+    // Audio thread: queues this hop and returns the previous one's output
+    // (silence on the first call). `out` may alias `frame`.
+    void process(const float* frame, float* out);
+    // Audio thread, never blocks: each stage zeroes its own state before the
+    // next hop queued, and that hop's call outputs silence instead of the
+    // last pre-reset hop
+    void reset();
+
+    PipelineTiming stageTiming(int stage) const;
+    // Time the caller spent waiting on stage 2 for the previous hop
+    PipelineTiming waitTiming() const;
+    void printStats() const;
+
+private:
+    // Where a stage input comes from or an output goes
+    enum class Role { Frame, State, Atten, Intermediate, Enhanced, NextState, Scratch };
+
+    struct Tensor {
+        std::string name;
+        std::vector<int64_t> shape;
+        size_t size = 0;
+        Role role = Role::Scratch;
+        int source = -1;   // Intermediate: stage 1 output index
+    };
+
+    struct Stage {
+        Ort::Session session{nullptr};
+        std::vector<Tensor> inputs;
+        std::vector<Tensor> outputs;
+        std::vector<const char*> input_names;
+        std::vector<const char*> output_names;
+        std::vector<Ort::Value> input_values;    // rebuilt in place each run
+        std::vector<Ort::Value> output_values;
+        std::vector<float> state;
+        std::vector<float> next_state;
+        std::vector<std::vector<float>> scratch;   // by output index, outputs nobody reads
+        std::thread thread;
+        int cpu = -1;
+        uint64_t reset_hop = 0;   // stage thread only: last reset applied
+
+        std::atomic<uint64_t> hops{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+        std::atomic<uint64_t> errors{0};
+    };
+
+    // Per-hop buffers; hop n uses slot n % SLOTS
+    static const int SLOTS = 2;
+    struct Slot {
+        std::vector<float> frame;
+        std::vector<std::vector<float>> intermediates;   // by stage 1 output index
+        std::vector<float> enhanced;
+    };
+
+    void loadStage(int index, const std::string& path, const MemoryProfile& memory);
+    void bindStages();
+    void stageLoop(int index);
+    void runStage(Stage& stage, Slot& slot);
+    float* bufferFor(Stage& stage, const Tensor& tensor, size_t index, Slot& slot, float& atten);
+    bool waitBeyond(const std::atomic<uint64_t>& counter, uint64_t value) const;
+
+    Ort::Env env_;
+    Ort::MemoryInfo memory_info_;
+    const std::atomic<float>& atten_lim_db_;
+
+    std::array<Stage, 2> stages_;
+    std::array<Slot, SLOTS> slots_;
+
+    // Hop counters: queued by the caller, finished by each stage
+    std::atomic<uint64_t> submitted_{0};
+    std::array<std::atomic<uint64_t>, 2> completed_{};
+    std::atomic<bool> stop_{false};
+    uint64_t next_hop_ = 0;   // caller only
+    // Hops from this one on start from zeroed states; written by the caller
+    // before it submits that hop
+    std::atomic<uint64_t> reset_hop_{0};
+
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> wait_total_ns_{0};
+    std::atomic<uint64_t> wait_max_ns_{0};
+};
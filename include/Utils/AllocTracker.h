@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocation checks for the realtime path.
+//
+// Built with NEURALMIC_ALLOC_TRACKING, the global operator new and the
+// malloc family are replaced with versions that keep thread-local scope
+// state. Any allocation made while a RealtimeScope is active on the same
+// thread is a violation: it is counted, reported with a backtrace, and
+// with AllocPolicy::Abort the process stops there. Code we do not own
+// (ONNX Runtime) runs under an AllocExemptScope; its allocations are
+// counted per label instead, so they stay visible without failing.
+//
+// Without the option the scopes are empty and cost nothing.
+
+enum class AllocPolicy {
+    Report,
+    Abort
+};
+
+class AllocTracker {
+public:
+    static bool enabled();
+    static void setPolicy(AllocPolicy policy);
+
+    static uint64_t violations();
+    static uint64_t realtimeSections();   // outermost RealtimeScopes entered
+    static void printReport();
+};
+
+#if NEURALMIC_ALLOC_TRACKING
+
+class RealtimeScope {
+public:
+    explicit RealtimeScope(const char* name);
+    ~RealtimeScope();
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+
+private:
+    const char* previous_;
+};
+
+class AllocExemptScope {
+public:
+    explicit AllocExemptScope(const char* label);
+    ~AllocExemptScope();
+    AllocExemptScope(const AllocExemptScope&) = delete;
+    AllocExemptScope& operator=(const AllocExemptScope&) = delete;
+
+private:
+    const char* previous_;
+};
+
+#else
+
+class RealtimeScope {
+public:
+    explicit RealtimeScope(const char*) {}
+};
+
+class AllocExemptScope {
+public:
+    explicit AllocExemptScope(const char*) {}
+};
+
+#endif
@@ -1,5 +1,5 @@
 // Simple Audio File Reader/Writer and Utilities
-// Supports WAV and MP3 formats
+// Supports WAV and MP3 formats, plus FLAC output
 // Uses minimp3 for MP3 decoding and LAME for MP3 encoding
 #ifndef AUDIOFILE_H
 #define AUDIOFILE_H
@@ -12,6 +12,10 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <memory>
+#include "Utils/FlacWriter.h"
+#include "Utils/AudioBuffer.h"
 
 // ============================================================================
 // Audio Data Container
@@ -152,6 +156,181 @@ inline bool writeWav(const std::string& filename, const AudioFile& audio) {
     return true;
 }
 
+// ============================================================================
+// Streaming Interfaces
+// ============================================================================
+// Block-at-a-time access to interleaved 16-bit samples, so files of any
+// length go through in bounded memory
+
+class AudioStreamReader {
+public:
+    virtual ~AudioStreamReader() = default;
+    virtual uint32_t sampleRate() const = 0;
+    virtual uint16_t channels() const = 0;
+    // Up to max_samples interleaved samples; 0 once the stream is exhausted
+    virtual size_t read(int16_t* out, size_t max_samples) = 0;
+    // Samples the stream will deliver, if the header says; 0 if unknown
+    virtual size_t totalSamples() const { return 0; }
+};
+
+class AudioStreamWriter {
+public:
+    virtual ~AudioStreamWriter() = default;
+    virtual void write(const int16_t* samples, size_t count) = 0;
+    virtual void close() = 0;   // flushes and finalises headers
+};
+
+class WavStreamReader : public AudioStreamReader {
+public:
+    explicit WavStreamReader(const std::string& filename)
+        : file_(filename, std::ios::binary), sampleRate_(0), channels_(0), remaining_(0), total_(0) {
+        if (!file_.is_open()) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+        
+        char riff[4];
+        uint32_t fileSize;
+        char wave[4];
+        file_.read(riff, 4);
+        file_.read(reinterpret_cast<char*>(&fileSize), 4);
+        file_.read(wave, 4);
+        
+        if (std::string(riff, 4) != "RIFF" || std::string(wave, 4) != "WAVE") {
+            throw std::runtime_error("Invalid WAV file");
+        }
+        
+        uint16_t audioFormat = 0;
+        uint16_t bitsPerSample = 0;
+        
+        while (file_.good()) {
+            char chunkId[4];
+            uint32_t chunkSize;
+            
+            file_.read(chunkId, 4);
+            file_.read(reinterpret_cast<char*>(&chunkSize), 4);
+            
+            if (std::string(chunkId, 4) == "fmt ") {
+                file_.read(reinterpret_cast<char*>(&audioFormat), 2);
+                file_.read(reinterpret_cast<char*>(&channels_), 2);
+                file_.read(reinterpret_cast<char*>(&sampleRate_), 4);
+                file_.seekg(6, std::ios::cur);  // skip byteRate, blockAlign
+                file_.read(reinterpret_cast<char*>(&bitsPerSample), 2);
+                if (chunkSize > 16) {
+                    file_.seekg(chunkSize - 16, std::ios::cur);
+                }
+            }
+            else if (std::string(chunkId, 4) == "data") {
+                if (audioFormat != 1 || bitsPerSample != 16) {
+                    throw std::runtime_error("Only 16-bit PCM is supported");
+                }
+                remaining_ = chunkSize / 2;
+                total_ = remaining_;
+                return;
+            }
+            else {
+                file_.seekg(chunkSize, std::ios::cur);
+            }
+        }
+        
+        throw std::runtime_error("No data chunk found in WAV file");
+    }
+    
+    uint32_t sampleRate() const override { return sampleRate_; }
+    uint16_t channels() const override { return channels_; }
+    size_t totalSamples() const override { return total_; }
+    
+    size_t read(int16_t* out, size_t max_samples) override {
+        size_t count = std::min(max_samples, remaining_);
+        file_.read(reinterpret_cast<char*>(out), count * 2);
+        count = static_cast<size_t>(file_.gcount()) / 2;
+        remaining_ = count ? remaining_ - count : 0;
+        return count;
+    }
+    
+private:
+    std::ifstream file_;
+    uint32_t sampleRate_;
+    uint16_t channels_;
+    size_t remaining_;
+    size_t total_;
+};
+
+class WavStreamWriter : public AudioStreamWriter {
+public:
+    WavStreamWriter(const std::string& filename, uint32_t sampleRate, uint16_t channels)
+        : file_(filename, std::ios::binary), dataSize_(0) {
+        if (!file_.is_open()) {
+            throw std::runtime_error("Cannot create file: " + filename);
+        }
+        
+        // Sizes are patched in close()
+        uint32_t placeholder = 0;
+        uint16_t audioFormat = 1;
+        uint16_t bitsPerSample = 16;
+        uint32_t byteRate = sampleRate * channels * 2;
+        uint16_t blockAlign = channels * 2;
+        uint32_t fmtSize = 16;
+        
+        file_.write("RIFF", 4);
+        file_.write(reinterpret_cast<const char*>(&placeholder), 4);
+        file_.write("WAVE", 4);
+        file_.write("fmt ", 4);
+        file_.write(reinterpret_cast<const char*>(&fmtSize), 4);
+        file_.write(reinterpret_cast<const char*>(&audioFormat), 2);
+        file_.write(reinterpret_cast<const char*>(&channels), 2);
+        file_.write(reinterpret_cast<const char*>(&sampleRate), 4);
+        file_.write(reinterpret_cast<const char*>(&byteRate), 4);
+        file_.write(reinterpret_cast<const char*>(&blockAlign), 2);
+        file_.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
+        file_.write("data", 4);
+        file_.write(reinterpret_cast<const char*>(&placeholder), 4);
+    }
+    
+    ~WavStreamWriter() override { close(); }
+    
+    void write(const int16_t* samples, size_t count) override {
+        file_.write(reinterpret_cast<const char*>(samples), count * 2);
+        dataSize_ += static_cast<uint32_t>(count * 2);
+    }
+    
+    void close() override {
+        if (!file_.is_open()) return;
+        uint32_t fileSize = 36 + dataSize_;
+        file_.seekp(4);
+        file_.write(reinterpret_cast<const char*>(&fileSize), 4);
+        file_.seekp(40);
+        file_.write(reinterpret_cast<const char*>(&dataSize_), 4);
+        file_.close();
+    }
+    
+private:
+    std::ofstream file_;
+    uint32_t dataSize_;
+};
+
+// ============================================================================
+// FLAC Output (built-in encoder, see FlacWriter.h)
+// ============================================================================
+
+class FlacStreamWriter : public AudioStreamWriter {
+public:
+    FlacStreamWriter(const std::string& filename, uint32_t sampleRate, uint16_t channels, int threads = 0)
+        : writer_(filename, sampleRate, channels, threads) {}
+    
+    void write(const int16_t* samples, size_t count) override { writer_.write(samples, count); }
+    void close() override { writer_.close(); }
+    
+private:
+    FlacWriter writer_;
+};
+
+inline bool writeFlac(const std::string& filename, const AudioFile& audio, int threads = 0) {
+    FlacWriter writer(filename, audio.sampleRate, audio.channels, threads);
+    writer.write(audio.samples.data(), audio.samples.size());
+    writer.close();
+    return true;
+}
+
 // ============================================================================
 // MP3 Support (Optional - requires minimp3 and LAME)
 // ============================================================================
@@ -160,67 +339,129 @@ inline bool writeWav(const std::string& filename, const AudioFile& audio) {
 #include "External/minimp3_ex.h"
 #include <lame/lame.h>
 
-inline bool readMp3(const std::string& filename, AudioFile& audio) {
-    mp3dec_t mp3d;
-    mp3dec_file_info_t info;
-    
-    if (mp3dec_load(&mp3d, filename.c_str(), &info, NULL, NULL)) {
-        throw std::runtime_error("Cannot read MP3 file");
+// Streams through minimp3_ex, which maps the file instead of decoding it
+// into one buffer. It also reads the Xing/LAME tag and trims the encoder
+// delay and padding, so samples line up with what was encoded.
+class Mp3StreamReader : public AudioStreamReader {
+public:
+    explicit Mp3StreamReader(const std::string& filename) {
+        if (mp3dec_ex_open(&decoder_, filename.c_str(), MP3D_SEEK_TO_SAMPLE)) {
+            throw std::runtime_error("Cannot read MP3 file: " + filename);
+        }
+        if (decoder_.info.channels == 0) {
+            mp3dec_ex_close(&decoder_);
+            throw std::runtime_error("No MP3 frames in " + filename);
+        }
     }
     
-    audio.sampleRate = info.hz;
-    audio.channels = info.channels;
-    audio.samples.assign(info.buffer, info.buffer + info.samples);
+    ~Mp3StreamReader() override {
+        mp3dec_ex_close(&decoder_);
+    }
     
-    free(info.buffer);
-    return true;
-}
-
-inline bool writeMp3(const std::string& filename, const AudioFile& audio, int bitrate = 128) {
-    lame_t lame = lame_init();
-    if (!lame) return false;
+    Mp3StreamReader(const Mp3StreamReader&) = delete;
+    Mp3StreamReader& operator=(const Mp3StreamReader&) = delete;
     
-    lame_set_num_channels(lame, audio.channels);
-    lame_set_in_samplerate(lame, audio.sampleRate);
-    lame_set_brate(lame, bitrate);
-    lame_set_quality(lame, 2);  // 2 = high quality
+    uint32_t sampleRate() const override { return static_cast<uint32_t>(decoder_.info.hz); }
+    uint16_t channels() const override { return static_cast<uint16_t>(decoder_.info.channels); }
+    // From the frame scan at open, after delay and padding are trimmed
+    size_t totalSamples() const override { return decoder_.samples; }
     
-    if (lame_init_params(lame) < 0) {
-        lame_close(lame);
-        return false;
+    size_t read(int16_t* out, size_t max_samples) override {
+        size_t count = mp3dec_ex_read(&decoder_, out, max_samples);
+        if (count < max_samples && decoder_.last_error) {
+            throw std::runtime_error("MP3 decode error " + std::to_string(decoder_.last_error));
+        }
+        return count;
     }
     
-    FILE* outfile = fopen(filename.c_str(), "wb");
-    if (!outfile) {
-        lame_close(lame);
-        return false;
+private:
+    mp3dec_ex_t decoder_;
+};
+
+// Encodes whatever each write() hands it; memory is bounded by the block size
+class Mp3StreamWriter : public AudioStreamWriter {
+public:
+    Mp3StreamWriter(const std::string& filename, uint32_t sampleRate, uint16_t channels, int bitrate = 128)
+        : lame_(lame_init()), file_(nullptr), channels_(channels) {
+        if (!lame_) {
+            throw std::runtime_error("Cannot initialise MP3 encoder");
+        }
+        
+        lame_set_num_channels(lame_, channels);
+        lame_set_in_samplerate(lame_, sampleRate);
+        lame_set_brate(lame_, bitrate);
+        lame_set_quality(lame_, 2);  // 2 = high quality
+        
+        if (lame_init_params(lame_) < 0) {
+            lame_close(lame_);
+            throw std::runtime_error("Invalid MP3 encoder parameters");
+        }
+        
+        file_ = std::fopen(filename.c_str(), "wb");
+        if (!file_) {
+            lame_close(lame_);
+            throw std::runtime_error("Cannot create file: " + filename);
+        }
     }
     
-    std::vector<uint8_t> mp3Buf(audio.samples.size() * 5 / 4 + 7200);
-    int numFrames = audio.samples.size() / audio.channels;
+    ~Mp3StreamWriter() override { close(); }
     
-    int encoded = 0;
-    if (audio.channels == 2) {
-        // Separate stereo channels
-        std::vector<int16_t> left(numFrames), right(numFrames);
-        for (int i = 0; i < numFrames; i++) {
-            left[i] = audio.samples[i * 2];
-            right[i] = audio.samples[i * 2 + 1];
+    void write(const int16_t* samples, size_t count) override {
+        int frames = static_cast<int>(count / channels_);
+        mp3Buf_.resize(frames * 5 / 4 + 7200);   // LAME's worst case
+        
+        int encoded = 0;
+        if (channels_ == 2) {
+            encoded = lame_encode_buffer_interleaved(lame_, const_cast<int16_t*>(samples), frames,
+                                                     mp3Buf_.data(), static_cast<int>(mp3Buf_.size()));
+        } else {
+            encoded = lame_encode_buffer(lame_, samples, samples, frames,
+                                         mp3Buf_.data(), static_cast<int>(mp3Buf_.size()));
         }
-        encoded = lame_encode_buffer(lame, left.data(), right.data(), 
-                                     numFrames, mp3Buf.data(), mp3Buf.size());
-    } else {
-        encoded = lame_encode_buffer(lame, audio.samples.data(), audio.samples.data(),
-                                     numFrames, mp3Buf.data(), mp3Buf.size());
+        if (encoded > 0) std::fwrite(mp3Buf_.data(), 1, encoded, file_);
     }
     
-    if (encoded > 0) fwrite(mp3Buf.data(), 1, encoded, outfile);
+    void close() override {
+        if (!file_) return;
+        mp3Buf_.resize(7200);
+        int flush = lame_encode_flush(lame_, mp3Buf_.data(), static_cast<int>(mp3Buf_.size()));
+        if (flush > 0) std::fwrite(mp3Buf_.data(), 1, flush, file_);
+        std::fclose(file_);
+        file_ = nullptr;
+        lame_close(lame_);
+        lame_ = nullptr;
+    }
     
-    int flush = lame_encode_flush(lame, mp3Buf.data(), mp3Buf.size());
-    if (flush > 0) fwrite(mp3Buf.data(), 1, flush, outfile);
+private:
+    lame_t lame_;
+    FILE* file_;
+    uint16_t channels_;
+    std::vector<uint8_t> mp3Buf_;
+};
+
+inline bool readMp3(const std::string& filename, AudioFile& audio) {
+    Mp3StreamReader reader(filename);
+    audio.sampleRate = reader.sampleRate();
+    audio.channels = reader.channels();
+    audio.samples.clear();
+    
+    audio.samples.reserve(reader.totalSamples());
+    std::vector<int16_t> block(MINIMP3_MAX_SAMPLES_PER_FRAME * 16);
+    while (size_t count = reader.read(block.data(), block.size())) {
+        audio.samples.insert(audio.samples.end(), block.begin(), block.begin() + count);
+    }
+    return true;
+}
+
+inline bool writeMp3(const std::string& filename, const AudioFile& audio, int bitrate = 128) {
+    Mp3StreamWriter writer(filename, audio.sampleRate, audio.channels, bitrate);
     
-    fclose(outfile);
-    lame_close(lame);
+    // One second per encode call instead of one buffer for the whole file
+    const size_t block = static_cast<size_t>(audio.sampleRate) * audio.channels;
+    for (size_t i = 0; i < audio.samples.size(); i += block) {
+        writer.write(audio.samples.data() + i, std::min(block, audio.samples.size() - i));
+    }
+    writer.close();
     return true;
 }
 #endif
@@ -259,11 +500,94 @@ inline bool save(const std::string& filename, const AudioFile& audio) {
     else if (ext == "mp3") {
         return writeMp3(filename, audio);
     }
+    else if (ext == "flac") {
+        return writeFlac(filename, audio);
+    }
+    else {
+        throw std::runtime_error("Unsupported format: " + ext);
+    }
+}
+
+// Streaming counterparts of load() and save()
+inline std::unique_ptr<AudioStreamReader> openReader(const std::string& filename) {
+    std::string ext = getExtension(filename);
+    
+    if (ext == "wav") {
+        return std::make_unique<WavStreamReader>(filename);
+    }
+    else if (ext == "mp3") {
+        return std::make_unique<Mp3StreamReader>(filename);
+    }
     else {
         throw std::runtime_error("Unsupported format: " + ext);
     }
 }
 
+inline std::unique_ptr<AudioStreamWriter> openWriter(const std::string& filename, uint32_t sampleRate, uint16_t channels) {
+    std::string ext = getExtension(filename);
+    
+    if (ext == "wav") {
+        return std::make_unique<WavStreamWriter>(filename, sampleRate, channels);
+    }
+    else if (ext == "mp3") {
+        return std::make_unique<Mp3StreamWriter>(filename, sampleRate, channels);
+    }
+    else if (ext == "flac") {
+        return std::make_unique<FlacStreamWriter>(filename, sampleRate, channels);
+    }
+    else {
+        throw std::runtime_error("Unsupported format: " + ext);
+    }
+}
+
+// ============================================================================
+// Float buffers straight from and to files, converted a block at a time so
+// the whole signal exists only once, as float
+// ============================================================================
+static const size_t CONVERT_BLOCK = 65536;
+
+// extra_samples: room to reserve past the signal, e.g. for a graph's padding
+inline bool load(const std::string& filename, AudioBuffer<float>& audio, size_t extra_samples = 0) {
+    auto reader = openReader(filename);
+    audio = AudioBuffer<float>(0, reader->channels(), reader->sampleRate());
+    if (reader->totalSamples() > 0) {
+        audio.reserve(reader->totalSamples() + extra_samples);
+    }
+    
+    std::vector<int16_t> block(CONVERT_BLOCK - CONVERT_BLOCK % audio.channels());
+    size_t filled = 0;
+    while (size_t count = reader->read(block.data(), block.size())) {
+        audio.resize((filled + count + audio.channels() - 1) / audio.channels());
+        float* out = audio.data() + filled;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = block[i] / 32768.0f;
+        }
+        filled += count;
+    }
+    audio.reserve(audio.size() + extra_samples);
+    return true;
+}
+
+inline bool save(const std::string& filename, const AudioBuffer<float>& audio) {
+    auto writer = openWriter(filename, audio.sampleRate(), audio.channels());
+    std::vector<int16_t> block(CONVERT_BLOCK - CONVERT_BLOCK % audio.channels());
+    const size_t frames_per_block = block.size() / audio.channels();
+    
+    for (size_t frame = 0; frame < audio.frames(); frame += frames_per_block) {
+        size_t frames = std::min(frames_per_block, audio.frames() - frame);
+        for (uint16_t c = 0; c < audio.channels(); ++c) {
+            auto view = audio.channelView(c);
+            for (size_t f = 0; f < frames; ++f) {
+                float scaled = view[frame + f] * 32767.0f;
+                block[f * audio.channels() + c] = static_cast<int16_t>(std::clamp(scaled, -32768.0f, 32767.0f));
+            }
+        }
+        writer->write(block.data(), frames * audio.channels());
+    }
+    writer->close();
+    return true;
+}
+
 } // namespace AudioIO
 
 // ============================================================================
@@ -289,6 +613,19 @@ inline AudioFile stereoToMono(const AudioFile& stereo) {
     return mono;
 }
 
+// Same, reusing the buffer: a mono file is moved through untouched
+inline AudioFile stereoToMono(AudioFile&& stereo) {
+    if (stereo.channels != 2) return std::move(stereo);
+    
+    size_t numFrames = stereo.getNumFrames();
+    for (size_t i = 0; i < numFrames; i++) {
+        stereo.samples[i] = (stereo.samples[i * 2] + stereo.samples[i * 2 + 1]) / 2;
+    }
+    stereo.samples.resize(numFrames);
+    stereo.channels = 1;
+    return std::move(stereo);
+}
+
 // Convert mono to stereo
 inline AudioFile monoToStereo(const AudioFile& mono) {
     if (mono.channels != 1) return mono;
@@ -307,6 +644,20 @@ inline AudioFile monoToStereo(const AudioFile& mono) {
     return stereo;
 }
 
+// Same, growing the buffer in place from the back
+inline AudioFile monoToStereo(AudioFile&& mono) {
+    if (mono.channels != 1) return std::move(mono);
+    
+    size_t numFrames = mono.samples.size();
+    mono.samples.resize(numFrames * 2);
+    for (size_t i = numFrames; i-- > 0;) {
+        mono.samples[i * 2 + 1] = mono.samples[i];
+        mono.samples[i * 2] = mono.samples[i];
+    }
+    mono.channels = 2;
+    return std::move(mono);
+}
+
 // Apply gain (volume adjustment)
 inline void applyGain(AudioFile& audio, double gain) {
     for (auto& sample : audio.samples) {
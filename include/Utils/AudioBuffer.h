@@ -0,0 +1,201 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// One channel of an AudioBuffer, whatever the layout: contiguous for
+// planar (and mono) buffers, every channels()-th sample for interleaved
+template <typename T>
+struct ChannelView {
+    T* data = nullptr;
+    size_t frames = 0;
+    size_t stride = 1;
+
+    T& operator[](size_t frame) const { return data[frame * stride]; }
+    size_t size() const { return frames; }
+};
+
+// Owning, move-only sample storage on 64-byte (cache line / AVX-512)
+// boundaries, interleaved or planar. Hands out non-owning spans and views
+// so stages work in place; copies only happen through clone(). Capacity
+// can be reserved up front so padding for a graph's delay never
+// reallocates a full-length signal.
+template <typename T>
+class AudioBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "AudioBuffer holds plain samples");
+
+public:
+    enum class Layout { Interleaved, Planar };
+    static constexpr size_t ALIGNMENT = 64;
+
+    AudioBuffer() = default;
+
+    AudioBuffer(size_t frames, uint16_t channels, uint32_t sample_rate, Layout layout = Layout::Interleaved)
+        : channels_(channels ? channels : 1), sample_rate_(sample_rate), layout_(layout) {
+        reserve(frames * channels_);
+        frames_ = frames;
+        std::memset(data_, 0, size() * sizeof(T));
+    }
+
+    ~AudioBuffer() { release(data_); }
+
+    AudioBuffer(const AudioBuffer&) = delete;
+    AudioBuffer& operator=(const AudioBuffer&) = delete;
+
+    AudioBuffer(AudioBuffer&& other) noexcept { swap(other); }
+    AudioBuffer& operator=(AudioBuffer&& other) noexcept {
+        if (this != &other) {
+            AudioBuffer(std::move(other)).swap(*this);
+        }
+        return *this;
+    }
+
+    AudioBuffer clone() const {
+        AudioBuffer copy;
+        copy.channels_ = channels_;
+        copy.sample_rate_ = sample_rate_;
+        copy.layout_ = layout_;
+        copy.reserve(size());
+        copy.frames_ = frames_;
+        std::memcpy(copy.data_, data_, size() * sizeof(T));
+        return copy;
+    }
+
+    size_t frames() const { return frames_; }
+    uint16_t channels() const { return channels_; }
+    uint32_t sampleRate() const { return sample_rate_; }
+    Layout layout() const { return layout_; }
+    size_t size() const { return frames_ * channels_; }       // samples
+    size_t capacity() const { return capacity_; }             // samples
+    bool empty() const { return frames_ == 0; }
+    double duration() const { return sample_rate_ ? static_cast<double>(frames_) / sample_rate_ : 0.0; }
+
+    void setSampleRate(uint32_t sample_rate) { sample_rate_ = sample_rate; }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    // Every sample in storage order
+    std::span<T> samples() { return {data_, size()}; }
+    std::span<const T> samples() const { return {data_, size()}; }
+    // Up to capacity(), for in-place work that runs past the end (padding)
+    std::span<T> storage() { return {data_, capacity_}; }
+
+    // Contiguous channel; planar or mono buffers only
+    std::span<T> channel(size_t c) {
+        if (layout_ == Layout::Interleaved && channels_ > 1) {
+            throw std::logic_error("channel span needs a planar or mono buffer; use channelView()");
+        }
+        return {data_ + c * frames_, frames_};
+    }
+
+    ChannelView<T> channelView(size_t c) {
+        if (layout_ == Layout::Planar) return {data_ + c * frames_, frames_, 1};
+        return {data_ + c, frames_, channels_};
+    }
+    ChannelView<const T> channelView(size_t c) const {
+        if (layout_ == Layout::Planar) return {data_ + c * frames_, frames_, 1};
+        return {data_ + c, frames_, channels_};
+    }
+
+    // Capacity in samples; keeps the contents
+    void reserve(size_t samples) {
+        if (samples <= capacity_) return;
+        T* grown = allocate(samples);
+        if (data_) std::memcpy(grown, data_, size() * sizeof(T));
+        release(data_);
+        data_ = grown;
+        capacity_ = samples;
+    }
+
+    // Keeps the contents; new frames are silent. Grows capacity by half
+    // again when it has to, so appending block by block stays linear.
+    void resize(size_t frames) {
+        size_t needed = frames * channels_;
+        if (needed > capacity_) {
+            reserve(std::max(needed, capacity_ + capacity_ / 2));
+        }
+
+        if (layout_ == Layout::Planar && channels_ > 1 && frames != frames_) {
+            // Channel c starts at c * frames: move them to their new places
+            // from the end that doesn't overwrite unread data
+            size_t keep = std::min(frames, frames_);
+            if (frames > frames_) {
+                for (size_t c = channels_; c-- > 0;) {
+                    std::memmove(data_ + c * frames, data_ + c * frames_, keep * sizeof(T));
+                    std::memset(data_ + c * frames + keep, 0, (frames - keep) * sizeof(T));
+                }
+            } else {
+                for (size_t c = 1; c < channels_; ++c) {
+                    std::memmove(data_ + c * frames, data_ + c * frames_, keep * sizeof(T));
+                }
+            }
+        } else if (needed > size()) {
+            std::memset(data_ + size(), 0, (needed - size()) * sizeof(T));
+        }
+        frames_ = frames;
+    }
+
+    // Re-lays the samples out; needs one scratch buffer of the same size
+    void setLayout(Layout layout) {
+        if (layout == layout_ || channels_ == 1) {
+            layout_ = layout;
+            return;
+        }
+        T* scratch = allocate(capacity_);
+        for (size_t f = 0; f < frames_; ++f) {
+            for (size_t c = 0; c < channels_; ++c) {
+                if (layout == Layout::Planar) scratch[c * frames_ + f] = data_[f * channels_ + c];
+                else scratch[f * channels_ + c] = data_[c * frames_ + f];
+            }
+        }
+        release(data_);
+        data_ = scratch;
+        layout_ = layout;
+    }
+
+    // Averages all channels into the first, in place
+    void downmixToMono() {
+        if (channels_ == 1) return;
+        const bool planar = (layout_ == Layout::Planar);
+        for (size_t f = 0; f < frames_; ++f) {
+            double sum = 0.0;
+            for (size_t c = 0; c < channels_; ++c) {
+                sum += planar ? data_[c * frames_ + f] : data_[f * channels_ + c];
+            }
+            data_[f] = static_cast<T>(sum / channels_);   // never ahead of what is still to be read
+        }
+        channels_ = 1;
+        layout_ = Layout::Interleaved;
+    }
+
+private:
+    static T* allocate(size_t samples) {
+        return static_cast<T*>(::operator new(samples * sizeof(T), std::align_val_t(ALIGNMENT)));
+    }
+    static void release(T* data) {
+        if (data) ::operator delete(data, std::align_val_t(ALIGNMENT));
+    }
+
+    void swap(AudioBuffer& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(frames_, other.frames_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(channels_, other.channels_);
+        std::swap(sample_rate_, other.sample_rate_);
+        std::swap(layout_, other.layout_);
+    }
+
+    T* data_ = nullptr;
+    size_t frames_ = 0;
+    size_t capacity_ = 0;
+    uint16_t channels_ = 1;
+    uint32_t sample_rate_ = 48000;
+    Layout layout_ = Layout::Interleaved;
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+
+// Difference between a processed signal and a reference of the same
+// alignment, for checking that an optimisation left the audio alone
+struct AudioDiff {
+    size_t samples = 0;
+    double max_abs_error = 0.0;
+    double snr_db = 0.0;        // reference energy over error energy
+    double lsd_db = 0.0;        // mean log-spectral distance, 1024-point frames
+};
+
+AudioDiff compareAudio(const float* reference, const float* test, size_t count);
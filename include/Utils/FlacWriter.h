@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+// Lossless 16-bit FLAC encoder with no external library. Each block picks
+// the cheapest of constant, verbatim, fixed (orders 0-4) and quantised LPC
+// prediction per channel, stereo picks the cheapest of L/R, L/S, S/R and
+// M/S, and residuals are Rice coded with a searched partition order.
+// Blocks are independent, so a batch of them is encoded across threads
+// and written in order.
+class FlacWriter {
+public:
+    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t BLOCKS_PER_THREAD = 4;   // per batch
+
+    // threads = 0 uses every core. Throws if the file cannot be created.
+    FlacWriter(const std::string& filename, uint32_t sample_rate, uint16_t channels, int threads = 0);
+    ~FlacWriter();
+
+    FlacWriter(const FlacWriter&) = delete;
+    FlacWriter& operator=(const FlacWriter&) = delete;
+
+    // Interleaved samples; encodes whenever a full batch has built up
+    void write(const int16_t* samples, size_t count);
+    // Encodes what is left and fills in the stream header
+    void close();
+
+    uint64_t bytesWritten() const { return bytes_written_; }
+
+private:
+    size_t batchSamples() const { return BLOCK_SIZE * channels_ * BLOCKS_PER_THREAD * threads_; }
+    void encodeBatch(size_t frames);
+    void writeStreamInfo();
+
+    FILE* file_;
+    uint32_t sample_rate_;
+    uint16_t channels_;
+    int threads_;
+
+    std::vector<int16_t> pending_;   // interleaved, up to one batch
+    uint64_t frame_number_;
+    uint64_t total_samples_;          // per channel
+    uint32_t min_frame_bytes_;
+    uint32_t max_frame_bytes_;
+    uint64_t bytes_written_;
+};
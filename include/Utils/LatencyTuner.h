@@ -0,0 +1,77 @@
+#pragma once
+#include <soundio/soundio.h>
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Mouth-to-ear latency broken down by where the time goes, in milliseconds
+struct LatencyReport {
+    double input_device_ms = 0.0;
+    double framing_ms = 0.0;        // waiting for a full hop
+    double algorithmic_ms = 0.0;    // model look-ahead (STFT overlap)
+    double processing_ms = 0.0;     // mean callback processing time
+    double ring_ms = 0.0;           // jitter cushion in the output ring
+    double output_device_ms = 0.0;
+
+    double total() const {
+        return input_device_ms + framing_ms + algorithmic_ms +
+               processing_ms + ring_ms + output_device_ms;
+    }
+};
+
+// Chooses device buffer sizes and steers the output ring's jitter cushion.
+//
+// Device latencies start at the smallest value the device allows, rounded up
+// to whole hops so periods line up with the 10 ms model frame. The ring
+// target starts at one hop, grows by a hop on every playback underrun and
+// shrinks by a hop after a quiet period, never below what the measured
+// processing jitter needs.
+//
+// Observers are called from the audio threads and touch only atomics.
+class LatencyTuner {
+public:
+    LatencyTuner(unsigned int sample_rate, int hop_size, size_t max_fill);
+
+    double negotiate(const SoundIoDevice* device) const;
+
+    void reset();
+
+    // Input thread
+    void onProcessingTime(double ms);
+    void setInputLatency(double seconds);
+
+    // Output thread
+    void onUnderrun();
+    void onPlayed(size_t samples);
+    size_t targetFill() const { return target_fill_.load(std::memory_order_relaxed); }
+    void setOutputLatency(double seconds);
+
+    // Any thread
+    void setAlgorithmicDelay(size_t samples) { algorithmic_samples_ = samples; }
+    LatencyReport report() const;
+    void printReport(const char* title) const;
+
+private:
+    size_t jitterFill() const;
+
+    static constexpr size_t JITTER_WINDOW = 200;   // frames (2 s)
+
+    unsigned int sample_rate_;
+    size_t hop_size_;
+    size_t max_fill_;
+    size_t algorithmic_samples_;
+
+    // Input thread state
+    std::array<float, JITTER_WINDOW> processing_window_;
+    size_t processing_index_;
+    std::atomic<float> processing_mean_ms_;
+    std::atomic<float> processing_jitter_ms_;
+    std::atomic<float> input_latency_s_;
+
+    // Output thread state
+    std::atomic<size_t> target_fill_;
+    std::atomic<float> output_latency_s_;
+    std::atomic<uint64_t> underruns_;
+    size_t samples_since_change_;
+};
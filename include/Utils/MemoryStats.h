@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Process memory as the kernel sees it (Linux /proc); 0 where unavailable
+size_t residentBytes();
+size_t peakResidentBytes();
+
+// Itemised footprint of one process. Items are either measured (RSS
+// deltas around a known step) or computed from buffer sizes; the total
+// is always the live RSS, so any gap is memory nothing claimed.
+class MemoryReport {
+public:
+    void add(const std::string& item, size_t bytes, bool measured = false);
+    void print(const char* title) const;
+    std::string summary() const;   // single line, for control replies
+
+private:
+    struct Item {
+        std::string name;
+        size_t bytes;
+        bool measured;
+    };
+    std::vector<Item> items_;
+};
@@ -6,8 +6,39 @@
 #include <map>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <array>
+#include <cstdint>
+#include "Utils/LatencyTuner.h"
 
-using AudioCallback = std::function<std::vector<int16_t>(const std::vector<int16_t>&)>;
+class ShmRingWriter;
+
+enum class XrunType : uint8_t {
+    InputOverflow,    // device dropped capture data
+    OutputUnderflow,  // device ran out of playback data
+    RingOverrun,      // processed frame dropped, output ring full
+    RingUnderrun,     // playback starved, gap concealed
+    Realign           // latency trimmed back to target after a burst
+};
+
+struct XrunEvent {
+    uint64_t timestamp_ns;  // steady_clock
+    XrunType type;
+    uint32_t samples;       // samples dropped or concealed, 0 if unknown
+};
+
+struct XrunStats {
+    uint64_t input_overflows = 0;
+    uint64_t output_underflows = 0;
+    uint64_t ring_overruns = 0;
+    uint64_t ring_underruns = 0;
+    uint64_t realigns = 0;
+    uint64_t concealed_samples = 0;
+    uint64_t dropped_samples = 0;
+};
+
+// Processes one hop in place: (samples, count)
+using AudioCallback = std::function<void(int16_t*, size_t)>;
 
 class MicrophoneReader {
 public:
@@ -19,11 +50,24 @@ public:
     bool selectDevice(const std::string& display_name);
     bool selectPlaybackDevice(const std::string& display_name);
     void setMonitorEnabled(bool enabled);
+    bool hasPlayback() const { return outstream_ != nullptr; }
     void setAudioCallback(AudioCallback callback);
+    bool setSharedOutput(const std::string& name, uint32_t slot_count = 512);
     bool initialize();
     void processAudio();
     void cleanup();
 
+    // Look-ahead of the processing callback, for latency reporting
+    void setProcessingDelay(size_t samples) { latency_tuner_.setAlgorithmicDelay(samples); }
+    LatencyReport getLatencyReport() const { return latency_tuner_.report(); }
+
+    // Capture, playback and concealment buffers
+    size_t bufferBytes() const;
+
+    XrunStats getXrunStats() const;
+    std::vector<XrunEvent> getXrunEvents() const;  // most recent last
+    void printXrunReport() const;
+
 private:
     SoundIo* soundio_;
     SoundIoDevice* input_device_;
@@ -39,7 +83,8 @@ private:
     std::map<std::string, int> mic_name_map_;
     std::map<std::string, int> speaker_name_map_;
     
-    bool monitor_enabled_;
+    std::atomic<bool> monitor_enabled_;
+    float monitor_gain_;  // audio thread only
     AudioCallback audio_callback_;
     
     static const unsigned int sample_rate_ = 48000;
@@ -53,8 +98,59 @@ private:
     std::atomic<size_t> samples_available_;
     std::atomic<bool> running_;
     
-    // Processing buffer to accumulate samples for exact 480-sample chunks
+    // One hop, filled by the input callback and processed in place
     std::vector<int16_t> process_buffer_;
+    size_t process_fill_;
+    
+    // Xrun accounting (any audio thread, lock-free)
+    // Each slot is a seqlock: seq is odd while a writer fills it and
+    // 2 * index + 2 once event `index` is complete, so a reader can tell a
+    // whole event from one being overwritten
+    struct XrunSlot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> timestamp_ns{0};
+        std::atomic<uint64_t> info{0};   // type << 32 | samples
+    };
+    static constexpr size_t XRUN_LOG_SIZE = 256;
+    std::array<XrunSlot, XRUN_LOG_SIZE> xrun_log_;
+    std::atomic<uint64_t> xrun_log_count_;
+    std::atomic<uint64_t> input_overflows_;
+    std::atomic<uint64_t> output_underflows_;
+    std::atomic<uint64_t> ring_overruns_;
+    std::atomic<uint64_t> ring_underruns_;
+    std::atomic<uint64_t> realigns_;
+    std::atomic<uint64_t> concealed_samples_;
+    std::atomic<uint64_t> dropped_samples_;
+    
+    // Device buffer sizing and output ring target
+    LatencyTuner latency_tuner_;
+    unsigned int latency_poll_counter_;  // input thread
+    unsigned int output_poll_counter_;   // output thread
+    
+    // Output-side concealment (output thread only)
+    bool playing_;                       // ring primed up to target fill
+    std::vector<float> output_history_;  // last frame played, source for concealment
+    size_t history_pos_;
+    size_t conceal_pos_;
+    float conceal_gain_;
+    bool output_primed_;
+    bool concealing_;
+    uint32_t gap_samples_;
+    int fade_in_remaining_;
+    size_t xfade_from_pos_;
+    int xfade_remaining_;
+    
+    // Input-side gap smoothing (input thread only)
+    int input_fade_remaining_;
+    int16_t last_input_sample_;
+    
+    void recordXrun(XrunType type, uint32_t samples);
+    void resetXrunState();
+    float concealSample();
+    void processFrame();
+    
+    // Optional shared-memory publication of processed frames
+    std::unique_ptr<ShmRingWriter> shared_output_;
     
     static void readCallback(SoundIoInStream* instream, int frame_count_min, int frame_count_max);
     static void writeCallback(SoundIoOutStream* outstream, int frame_count_min, int frame_count_max);
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Time spent in one graph node, or summed over every node of one op type
+struct OpTiming {
+    std::string name;            // node name, or op type for the per-type table
+    std::string op_type;
+    uint64_t calls = 0;
+    double total_us = 0.0;
+    uint64_t output_bytes = 0;   // summed over calls: what the kernel allocated for its outputs
+};
+
+// Kernel times from an ONNX Runtime session profile (the JSON written by
+// SessionOptions::EnableProfiling), both tables sorted slowest first
+struct OrtProfileSummary {
+    int runs = 0;                  // model runs counted
+    double run_us = 0.0;           // wall time of those runs, including framework overhead
+    double kernel_us = 0.0;        // sum over kernels
+    std::vector<OpTiming> nodes;
+    std::vector<OpTiming> op_types;
+
+    // hops: how many hops the counted runs covered, for per-hop figures
+    // and the share of the 10 ms hop budget
+    void print(int hops, size_t max_nodes = 25) const;
+};
+
+// Skips the first skip_runs runs (warm-up). Returns false if the file
+// can't be read or parsed.
+bool loadOrtProfile(const std::string& path, int skip_runs, OrtProfileSummary& summary);
@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+
+struct RecorderTrackStats {
+    uint64_t samples_written = 0;
+    uint64_t dropped = 0;          // samples lost to a full queue
+    size_t high_water = 0;         // most samples ever waiting in the queue
+    size_t capacity = 0;
+};
+
+// Records the raw and denoised streams of a live session to
+// "<prefix>-raw.wav" and "<prefix>-denoised.wav".
+//
+// The audio thread only copies each hop into a single-producer queue per
+// track; it never blocks, allocates or touches a file, and drops samples
+// (counted) if the writer falls that far behind. A background thread drains
+// the queues in large buffered writes and rewrites the WAV sizes about once
+// a second, so a file cut short by a crash still opens with everything up
+// to the last update. WAV sizes are 32-bit, so recording stops on its own
+// once a file reaches 4 GiB (about 12 h of 48 kHz audio).
+class SessionRecorder {
+public:
+    enum Track { Raw = 0, Denoised = 1 };
+
+    SessionRecorder();
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    bool start(const std::string& path_prefix, uint32_t sample_rate, double queue_seconds = 2.0);
+    void stop();
+    bool isRecording() const { return recording_.load(std::memory_order_acquire); }
+
+    // Audio thread
+    void push(Track track, const int16_t* samples, size_t count);
+
+    RecorderTrackStats stats(Track track) const;
+    void printStats() const;
+
+private:
+    struct Queue {
+        std::vector<int16_t> buffer;
+        std::atomic<uint64_t> head{0};   // written by the audio thread
+        std::atomic<uint64_t> tail{0};   // written by the writer thread
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<size_t> high_water{0};
+    };
+
+    struct File {
+        FILE* handle = nullptr;
+        std::vector<char> io_buffer;
+        std::atomic<uint64_t> samples_written{0};   // writer thread, read by stats()
+    };
+
+    void writerLoop();
+    size_t drain(Track track);
+    bool openFile(File& file, const std::string& path);
+    void updateHeader(File& file);
+    void closeFile(File& file);
+
+    Queue queues_[2];
+    File files_[2];
+    std::vector<int16_t> scratch_;   // writer thread
+    uint32_t sample_rate_;
+    std::string prefix_;
+
+    std::atomic<bool> recording_;
+    std::atomic<int> pushes_in_flight_;
+    std::atomic<bool> writer_running_;
+    std::thread writer_;
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+// POSIX shared-memory ring of fixed-size PCM frames.
+//
+// One writer (the realtime capture thread) publishes frames; any number of
+// readers in other processes follow the stream independently. Each slot
+// carries its own sequence number, so readers detect when the writer has
+// lapped them instead of reading torn data.
+
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t frame_size;      // samples per slot
+    uint32_t slot_count;
+    uint32_t slot_stride;     // bytes per slot, 64-byte aligned
+    uint32_t reserved;
+    alignas(64) std::atomic<uint64_t> write_seq;  // frames published so far
+};
+
+struct ShmRingSlot {
+    std::atomic<uint64_t> seq;    // frame sequence + 1, 0 while being written
+    uint64_t timestamp_ns;        // steady_clock (CLOCK_MONOTONIC) at publish
+    // int16_t samples[frame_size] follow
+};
+
+// A frame as seen by a reader, pointing straight into shared memory.
+// Call ShmRingReader::validate() after consuming it to make sure the
+// writer did not overwrite the slot in the meantime.
+struct ShmFrameView {
+    const int16_t* samples = nullptr;
+    size_t frame_size = 0;
+    uint64_t seq = 0;
+    uint64_t timestamp_ns = 0;
+};
+
+class ShmRingWriter {
+public:
+    ShmRingWriter();
+    ~ShmRingWriter();
+
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    bool create(const std::string& name, uint32_t sample_rate,
+                uint32_t frame_size, uint32_t slot_count);
+    void close();
+
+    // Realtime-safe: no locks, no syscalls, no allocation
+    void publish(const int16_t* samples, size_t count);
+
+    bool isOpen() const { return header_ != nullptr; }
+    uint64_t published() const;
+
+private:
+    std::string name_;
+    int fd_;
+    void* mapping_;
+    size_t mapping_size_;
+    ShmRingHeader* header_;
+    uint8_t* slots_;
+};
+
+class ShmRingReader {
+public:
+    ShmRingReader();
+    ~ShmRingReader();
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    // Attaches to an existing ring; starts at the newest published frame
+    bool open(const std::string& name);
+    void close();
+
+    // Returns false when no new frame is available yet
+    bool next(ShmFrameView& view);
+    // True if the frame behind view was not overwritten while in use
+    bool validate(const ShmFrameView& view) const;
+    // Convenience: copy the next frame out, retrying if it was torn
+    bool readCopy(int16_t* dst, ShmFrameView& view);
+
+    uint32_t sampleRate() const { return header_ ? header_->sample_rate : 0; }
+    uint32_t frameSize() const { return header_ ? header_->frame_size : 0; }
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    const ShmRingSlot* slotFor(uint64_t seq) const;
+
+    int fd_;
+    void* mapping_;
+    size_t mapping_size_;
+    const ShmRingHeader* header_;
+    const uint8_t* slots_;
+    uint64_t next_seq_;
+    uint64_t dropped_;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+
+// Timeline tracing for the audio path, exported as Chrome trace JSON
+// (chrome://tracing or ui.perfetto.dev).
+//
+// Every thread that records gets its own fixed ring of events out of a pool
+// reserved when tracing is enabled, so recording is a handful of stores and
+// one atomic increment: no locks and no allocation. Rings keep the last few
+// seconds per thread; dump() snapshots them on demand, and markAnomaly()
+// (safe from the audio threads) has a background thread write the window
+// around a glitch shortly after it happens.
+struct TraceEvent {
+    const char* name;       // must outlive the tracer (literals, stage names)
+    uint64_t start_ns;      // steady_clock
+    uint32_t duration_ns;
+    uint32_t arg;
+    bool instant;
+};
+
+class Tracer {
+public:
+    static Tracer& instance();
+
+    void setEnabled(bool enabled);
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void record(const char* name, uint64_t start_ns, uint64_t end_ns, uint32_t arg = 0);
+    void instant(const char* name, uint32_t arg = 0);
+    void setThreadName(const char* name);
+
+    // Writes the last `window_ms` of every thread (0 = all retained)
+    bool dump(const std::string& path, uint64_t window_ms = 0) const;
+
+    // Anomaly dumps: `before_ms` of history plus `after_ms` once the glitch
+    // has played out, into `directory`, at most one per cooldown
+    void enableAnomalyDumps(const std::string& directory, uint64_t before_ms = 3000, uint64_t after_ms = 1000);
+    void markAnomaly(const char* reason);
+
+    static uint64_t nowNs();
+
+private:
+    Tracer();
+    ~Tracer();
+
+    static constexpr int MAX_THREADS = 16;
+    static const size_t EVENTS_PER_THREAD = 16384;
+
+    struct ThreadBuffer {
+        std::atomic<uint64_t> head{0};
+        std::atomic<const char*> name{nullptr};
+        std::unique_ptr<TraceEvent[]> events;
+    };
+
+    ThreadBuffer* threadBuffer();
+    void push(const TraceEvent& event);
+    void anomalyLoop();
+
+    std::atomic<bool> enabled_;
+    std::unique_ptr<ThreadBuffer[]> buffers_;
+    std::atomic<int> buffers_claimed_;
+
+    std::string anomaly_dir_;
+    uint64_t anomaly_before_ms_;
+    uint64_t anomaly_after_ms_;
+    std::atomic<uint64_t> anomaly_at_ns_;          // 0 = none pending
+    std::atomic<const char*> anomaly_reason_;
+    std::atomic<bool> anomaly_running_;
+    std::thread anomaly_thread_;
+};
+
+// Records the enclosing scope as one complete event
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, uint32_t arg = 0)
+        : name_(name),
+          arg_(arg),
+          start_ns_(Tracer::instance().enabled() ? Tracer::nowNs() : 0) {}
+
+    ~TraceScope() {
+        if (start_ns_) Tracer::instance().record(name_, start_ns_, Tracer::nowNs(), arg_);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    uint32_t arg_;
+    uint64_t start_ns_;
+};
@@ -0,0 +1,93 @@
+#ifndef NEURALMIC_H
+#define NEURALMIC_H
+
+/*
+ * NeuralMic C API: in-process DeepFilterNetV3 noise suppression for hosts
+ * written in C or anything with a C FFI.
+ *
+ * Audio is 48 kHz mono float in [-1, 1], processed in place in multiples
+ * of neuralmic_frame_size() samples. A context holds one model instance
+ * and one stream; use one context per stream, from one thread at a time.
+ * neuralmic_process() does not allocate, print or throw.
+ *
+ * Everything returns a neuralmic_status; neuralmic_last_error() has the
+ * detail. The ABI only grows: new config fields go at the end, and
+ * neuralmic_config_init() records the size the caller was built against.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(NEURALMIC_BUILDING)
+#define NEURALMIC_API __attribute__((visibility("default")))
+#else
+#define NEURALMIC_API
+#endif
+
+#define NEURALMIC_API_VERSION 1
+
+typedef struct neuralmic_context neuralmic_context;
+
+typedef enum neuralmic_status {
+    NEURALMIC_OK = 0,
+    NEURALMIC_ERROR_INVALID_ARGUMENT = -1,   /* null pointer, bad config */
+    NEURALMIC_ERROR_FRAME_SIZE = -2,         /* count not a whole number of frames */
+    NEURALMIC_ERROR_MODEL = -3,              /* model failed to load or run */
+    NEURALMIC_ERROR_STATE = -4               /* warm state unreadable or mismatched */
+} neuralmic_status;
+
+typedef struct neuralmic_config {
+    uint32_t struct_size;          /* set by neuralmic_config_init() */
+    const char* model_path;        /* DeepFilterNetV3 ONNX export, required */
+    int hops_per_run;              /* frames per inference call; 0 = what the export fixes */
+    int low_memory;                /* nonzero: exact-size arena, no memory pattern */
+    float strength_db;             /* 0 (gentle) to -100 (aggressive) */
+    const char* warm_state_path;   /* saved stream state to start from, or NULL */
+    int verbose;                   /* nonzero: model summary on stdout at create (this context only) */
+} neuralmic_config;
+
+typedef struct neuralmic_stats {
+    uint64_t frames;               /* frames processed since create */
+    uint64_t calls;                /* neuralmic_process() calls */
+    uint64_t errors;               /* calls that failed */
+    uint64_t total_ns;             /* time inside the model, all frames */
+    uint64_t max_frame_ns;         /* slowest single frame */
+    uint64_t last_frame_ns;        /* most recent frame */
+} neuralmic_stats;
+
+NEURALMIC_API const char* neuralmic_version(void);
+NEURALMIC_API int neuralmic_sample_rate(void);
+NEURALMIC_API int neuralmic_frame_size(void);
+
+NEURALMIC_API void neuralmic_config_init(neuralmic_config* config);
+
+/* Loads and warms up the model; slow, call off the audio thread. On
+ * failure *context is NULL and neuralmic_last_error(NULL) says why. */
+NEURALMIC_API neuralmic_status neuralmic_create(const neuralmic_config* config, neuralmic_context** context);
+NEURALMIC_API void neuralmic_destroy(neuralmic_context* context);
+
+/* Denoises `count` samples in place; count must be a multiple of
+ * neuralmic_frame_size(). Output lags input by neuralmic_latency(). */
+NEURALMIC_API neuralmic_status neuralmic_process(neuralmic_context* context, float* samples, size_t count);
+
+/* Safe from any thread; takes effect from the next frame */
+NEURALMIC_API neuralmic_status neuralmic_set_strength(neuralmic_context* context, float strength_db);
+/* Starts the stream over, from the warm state if one was given */
+NEURALMIC_API neuralmic_status neuralmic_reset(neuralmic_context* context);
+
+NEURALMIC_API int neuralmic_latency(const neuralmic_context* context);
+NEURALMIC_API neuralmic_status neuralmic_get_stats(const neuralmic_context* context, neuralmic_stats* stats);
+
+/* Last error on this context, or of the last failed create on this thread
+ * when context is NULL. Valid until the next call on the same context. */
+NEURALMIC_API const char* neuralmic_last_error(const neuralmic_context* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NEURALMIC_H */
@@ -0,0 +1,217 @@
+#include "neuralmic.h"
+#include "Core/OnnxInference.h"
+#include "Core/MemoryProfile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <exception>
+
+#ifndef NEURALMIC_VERSION
+#define NEURALMIC_VERSION "unknown"
+#endif
+
+// C wrapper over DeepFilterNet. Nothing may throw across the boundary, so
+// every entry point catches and turns exceptions into a status plus a
+// message copied into a fixed buffer.
+
+struct neuralmic_context {
+    std::unique_ptr<DeepFilterNet> model;
+
+    // Written by the processing thread, readable from any thread
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_frame_ns{0};
+    std::atomic<uint64_t> last_frame_ns{0};
+
+    char error[256] = {};
+};
+
+namespace {
+    thread_local char create_error[256] = {};
+
+    void setError(char (&buffer)[256], const char* message)
+    {
+        std::strncpy(buffer, message, sizeof(buffer) - 1);
+        buffer[sizeof(buffer) - 1] = '\0';
+    }
+}
+
+extern "C" {
+
+const char* neuralmic_version(void)
+{
+    return NEURALMIC_VERSION;
+}
+
+int neuralmic_sample_rate(void)
+{
+    return DeepFilterNet::SAMPLE_RATE;
+}
+
+int neuralmic_frame_size(void)
+{
+    return DeepFilterNet::HOP_SIZE;
+}
+
+void neuralmic_config_init(neuralmic_config* config)
+{
+    if (!config) return;
+    std::memset(config, 0, sizeof(*config));
+    config->struct_size = sizeof(*config);
+}
+
+neuralmic_status neuralmic_create(const neuralmic_config* config, neuralmic_context** context)
+{
+    if (!context)
+    {
+        setError(create_error, "context out-pointer is NULL");
+        return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    }
+    *context = nullptr;
+
+    // Callers built against an older header pass a shorter struct; the
+    // fields they don't know about keep their defaults
+    neuralmic_config cfg;
+    neuralmic_config_init(&cfg);
+    if (!config || config->struct_size < offsetof(neuralmic_config, model_path) + sizeof(config->model_path))
+    {
+        setError(create_error, "config is NULL or was not set up with neuralmic_config_init()");
+        return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    }
+    std::memcpy(&cfg, config, std::min<size_t>(config->struct_size, sizeof(cfg)));
+
+    if (!cfg.model_path || !*cfg.model_path)
+    {
+        setError(create_error, "model_path is required");
+        return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    }
+    if (cfg.hops_per_run < 0)
+    {
+        setError(create_error, "hops_per_run must be 0 or more");
+        return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    }
+
+    auto ctx = std::make_unique<neuralmic_context>();
+    try
+    {
+        MemoryProfile memory = cfg.low_memory ? MemoryProfile::LowMemory() : MemoryProfile();
+        ctx->model = std::make_unique<DeepFilterNet>(cfg.model_path, cfg.hops_per_run, memory,
+                                                     std::string(), cfg.verbose != 0);
+        ctx->model->SetNoiseSuppressionStrength(cfg.strength_db);
+    }
+    catch (const std::exception& e)
+    {
+        setError(create_error, e.what());
+        return NEURALMIC_ERROR_MODEL;
+    }
+
+    if (cfg.warm_state_path && *cfg.warm_state_path)
+    {
+        try
+        {
+            ctx->model->LoadWarmState(cfg.warm_state_path);
+            ctx->model->reset();
+        }
+        catch (const std::exception& e)
+        {
+            setError(create_error, e.what());
+            return NEURALMIC_ERROR_STATE;
+        }
+    }
+
+    *context = ctx.release();
+    return NEURALMIC_OK;
+}
+
+void neuralmic_destroy(neuralmic_context* context)
+{
+    delete context;
+}
+
+neuralmic_status neuralmic_process(neuralmic_context* context, float* samples, size_t count)
+{
+    if (!context) return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    context->calls.fetch_add(1, std::memory_order_relaxed);
+
+    if (!samples && count > 0)
+    {
+        context->errors.fetch_add(1, std::memory_order_relaxed);
+        setError(context->error, "samples is NULL");
+        return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    }
+    if (count % DeepFilterNet::HOP_SIZE != 0)
+    {
+        context->errors.fetch_add(1, std::memory_order_relaxed);
+        setError(context->error, "count must be a multiple of neuralmic_frame_size()");
+        return NEURALMIC_ERROR_FRAME_SIZE;
+    }
+
+    try
+    {
+        for (size_t pos = 0; pos < count; pos += DeepFilterNet::HOP_SIZE)
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            context->model->ProcessRealtimeFrame(samples + pos, samples + pos);
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - t0).count();
+
+            context->frames.fetch_add(1, std::memory_order_relaxed);
+            context->total_ns.fetch_add(ns, std::memory_order_relaxed);
+            context->last_frame_ns.store(ns, std::memory_order_relaxed);
+            if (ns > context->max_frame_ns.load(std::memory_order_relaxed))
+            {
+                context->max_frame_ns.store(ns, std::memory_order_relaxed);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        context->errors.fetch_add(1, std::memory_order_relaxed);
+        setError(context->error, e.what());
+        return NEURALMIC_ERROR_MODEL;
+    }
+    return NEURALMIC_OK;
+}
+
+neuralmic_status neuralmic_set_strength(neuralmic_context* context, float strength_db)
+{
+    if (!context) return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    context->model->SetNoiseSuppressionStrength(strength_db);
+    return NEURALMIC_OK;
+}
+
+neuralmic_status neuralmic_reset(neuralmic_context* context)
+{
+    if (!context) return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    context->model->reset();
+    return NEURALMIC_OK;
+}
+
+int neuralmic_latency(const neuralmic_context* context)
+{
+    return context ? context->model->StreamLatency() : 0;
+}
+
+neuralmic_status neuralmic_get_stats(const neuralmic_context* context, neuralmic_stats* stats)
+{
+    if (!context || !stats) return NEURALMIC_ERROR_INVALID_ARGUMENT;
+    stats->frames = context->frames.load(std::memory_order_relaxed);
+    stats->calls = context->calls.load(std::memory_order_relaxed);
+    stats->errors = context->errors.load(std::memory_order_relaxed);
+    stats->total_ns = context->total_ns.load(std::memory_order_relaxed);
+    stats->max_frame_ns = context->max_frame_ns.load(std::memory_order_relaxed);
+    stats->last_frame_ns = context->last_frame_ns.load(std::memory_order_relaxed);
+    return NEURALMIC_OK;
+}
+
+const char* neuralmic_last_error(const neuralmic_context* context)
+{
+    return context ? context->error : create_error;
+}
+
+}
@@ -0,0 +1,267 @@
+#include "Core/AudioStages.h"
+#include "Core/NoiseSuppressor.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+static float dbToLinear(float db) {
+    return std::pow(10.0f, db / 20.0f);
+}
+
+static float timeCoef(float seconds, unsigned int sample_rate) {
+    return std::exp(-1.0f / (seconds * sample_rate));
+}
+
+// ============================================================================
+// HighPassStage
+// ============================================================================
+
+HighPassStage::HighPassStage(float cutoff_hz)
+    : cutoff_hz_(cutoff_hz),
+      b0_(1.0f), b1_(0.0f), b2_(0.0f), a1_(0.0f), a2_(0.0f),
+      z1_(0.0f), z2_(0.0f) {
+}
+
+void HighPassStage::prepare(unsigned int sample_rate, size_t) {
+    // RBJ cookbook, Q = 1/sqrt(2)
+    float w0 = 2.0f * static_cast<float>(M_PI) * cutoff_hz_ / sample_rate;
+    float alpha = std::sin(w0) / (2.0f * static_cast<float>(M_SQRT1_2));
+    float cosw = std::cos(w0);
+    float a0 = 1.0f + alpha;
+
+    b0_ = (1.0f + cosw) / 2.0f / a0;
+    b1_ = -(1.0f + cosw) / a0;
+    b2_ = b0_;
+    a1_ = -2.0f * cosw / a0;
+    a2_ = (1.0f - alpha) / a0;
+    reset();
+}
+
+void HighPassStage::reset() {
+    z1_ = z2_ = 0.0f;
+}
+
+void HighPassStage::process(float* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float x = samples[i];
+        float y = b0_ * x + z1_;
+        z1_ = b1_ * x - a1_ * y + z2_;
+        z2_ = b2_ * x - a2_ * y;
+        samples[i] = y;
+    }
+}
+
+// ============================================================================
+// AgcStage
+// ============================================================================
+
+static const float AGC_MAX_GAIN = 4.0f;        // +12 dB
+static const float AGC_SILENCE = 0.003f;       // -50 dBFS: hold gain below this
+
+AgcStage::AgcStage(float target_db)
+    : target_rms_(dbToLinear(target_db)),
+      envelope_(0.0f),
+      gain_(1.0f),
+      env_coef_(0.0f),
+      gain_coef_(0.0f) {
+}
+
+void AgcStage::prepare(unsigned int sample_rate, size_t) {
+    env_coef_ = timeCoef(0.3f, sample_rate);
+    gain_coef_ = timeCoef(0.5f, sample_rate);
+    reset();
+}
+
+void AgcStage::reset() {
+    envelope_ = 0.0f;
+    gain_ = 1.0f;
+}
+
+void AgcStage::process(float* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float x = samples[i];
+        envelope_ = env_coef_ * envelope_ + (1.0f - env_coef_) * x * x;
+
+        float rms = std::sqrt(envelope_);
+        if (rms > AGC_SILENCE) {
+            float wanted = std::min(target_rms_ / rms, AGC_MAX_GAIN);
+            gain_ = gain_coef_ * gain_ + (1.0f - gain_coef_) * wanted;
+        }
+        samples[i] = x * gain_;
+    }
+}
+
+// ============================================================================
+// LimiterStage
+// ============================================================================
+
+LimiterStage::LimiterStage(float ceiling_db)
+    : ceiling_(dbToLinear(ceiling_db)),
+      gain_(1.0f),
+      release_coef_(0.0f) {
+}
+
+void LimiterStage::prepare(unsigned int sample_rate, size_t) {
+    release_coef_ = timeCoef(0.05f, sample_rate);
+    reset();
+}
+
+void LimiterStage::reset() {
+    gain_ = 1.0f;
+}
+
+void LimiterStage::process(float* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float peak = std::abs(samples[i]);
+        if (peak * gain_ > ceiling_) {
+            gain_ = ceiling_ / peak;
+        } else {
+            gain_ = release_coef_ * gain_ + (1.0f - release_coef_);
+        }
+        samples[i] *= gain_;
+    }
+}
+
+// ============================================================================
+// DryTapStage / DryWetStage
+// ============================================================================
+
+void DryTapStage::prepare(unsigned int sample_rate, size_t max_block) {
+    // Enough history for a full second of delay plus one block
+    history_.assign(sample_rate + max_block, 0.0f);
+    reset();
+}
+
+void DryTapStage::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    write_pos_ = 0;
+    block_start_ = 0;
+}
+
+void DryTapStage::process(float* samples, size_t count) {
+    block_start_ = write_pos_;
+    for (size_t i = 0; i < count; ++i) {
+        history_[write_pos_] = samples[i];
+        write_pos_ = (write_pos_ + 1) % history_.size();
+    }
+}
+
+float DryTapStage::delayed(size_t i, size_t delay) const {
+    size_t size = history_.size();
+    return history_[(block_start_ + i + size - delay % size) % size];
+}
+
+DryWetStage::DryWetStage(const DryTapStage& tap, float wet, size_t delay)
+    : tap_(tap),
+      wet_(std::clamp(wet, 0.0f, 1.0f)),
+      delay_(delay) {
+}
+
+void DryWetStage::process(float* samples, size_t count) {
+    float dry = 1.0f - wet_;
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = wet_ * samples[i] + dry * tap_.delayed(i, delay_);
+    }
+}
+
+// ============================================================================
+// LoudnessMeterStage
+// ============================================================================
+
+float LoudnessMeterStage::Biquad::run(float x) {
+    float y = b0 * x + z1;
+    z1 = b1 * x - a1 * y + z2;
+    z2 = b2 * x - a2 * y;
+    return y;
+}
+
+void LoudnessMeterStage::prepare(unsigned int sample_rate, size_t) {
+    // ITU-R BS.1770 K-weighting coefficients for 48 kHz
+    shelf_ = Biquad{1.53512485958697f, -2.69169618940638f, 1.19839281085285f,
+                    -1.69065929318241f, 0.73248077421585f};
+    highpass_ = Biquad{1.0f, -2.0f, 1.0f, -1.99004745483398f, 0.99007225036621f};
+    block_samples_ = sample_rate / 10;
+    reset();
+}
+
+void LoudnessMeterStage::reset() {
+    shelf_.z1 = shelf_.z2 = 0.0f;
+    highpass_.z1 = highpass_.z2 = 0.0f;
+    block_fill_ = 0;
+    block_energy_ = 0.0;
+    std::fill(std::begin(recent_), std::end(recent_), 0.0);
+    recent_count_ = 0;
+    gated_sum_ = 0.0;
+    gated_blocks_ = 0;
+    momentary_lufs_ = -70.0f;
+    integrated_lufs_ = -70.0f;
+}
+
+void LoudnessMeterStage::process(float* samples, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float k = highpass_.run(shelf_.run(samples[i]));
+        block_energy_ += static_cast<double>(k) * k;
+
+        if (++block_fill_ < block_samples_) continue;
+
+        recent_[recent_count_++ % 4] = block_energy_ / block_samples_;
+        block_energy_ = 0.0;
+        block_fill_ = 0;
+
+        double mean = (recent_[0] + recent_[1] + recent_[2] + recent_[3]) / 4.0;
+        double lufs = -0.691 + 10.0 * std::log10(mean + 1e-12);
+        momentary_lufs_.store(static_cast<float>(lufs), std::memory_order_relaxed);
+
+        // Absolute gate only; good enough for a running readout
+        if (lufs > -70.0) {
+            gated_sum_ += mean;
+            gated_blocks_++;
+            integrated_lufs_.store(static_cast<float>(-0.691 + 10.0 * std::log10(gated_sum_ / gated_blocks_)),
+                                   std::memory_order_relaxed);
+        }
+    }
+}
+
+// ============================================================================
+// DenoiserStage
+// ============================================================================
+
+DenoiserStage::DenoiserStage(NoiseSuppressor& model)
+    : model_(model) {
+}
+
+void DenoiserStage::reset() {
+    model_.reset();
+}
+
+void DenoiserStage::process(float* samples, size_t count) {
+    for (size_t i = 0; i + NoiseSuppressor::HOP_SIZE <= count; i += NoiseSuppressor::HOP_SIZE) {
+        model_.ProcessRealtimeFrame(samples + i, samples + i);
+    }
+}
+
+size_t DenoiserStage::latency() const {
+    return model_.StreamLatency();
+}
+
+size_t DenoiserStage::blockSize() const {
+    return NoiseSuppressor::HOP_SIZE;
+}
+
+// ============================================================================
+// Built-in stage registrations
+// ============================================================================
+
+static float paramOr(const std::string& param, float fallback) {
+    return param.empty() ? fallback : std::stof(param);
+}
+
+static const bool stages_registered = [] {
+    auto& registry = StageRegistry::instance();
+    registry.add("highpass", [](const std::string& p) { return std::make_unique<HighPassStage>(paramOr(p, 80.0f)); });
+    registry.add("agc", [](const std::string& p) { return std::make_unique<AgcStage>(paramOr(p, -20.0f)); });
+    registry.add("limiter", [](const std::string& p) { return std::make_unique<LimiterStage>(paramOr(p, -1.0f)); });
+    registry.add("loudness", [](const std::string&) { return std::make_unique<LoudnessMeterStage>(); });
+    return true;
+}();
@@ -0,0 +1,138 @@
+#include "Core/ControlServer.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+static const size_t MAX_LINE = 1024;
+
+ControlServer::ControlServer()
+    : listen_fd_(-1),
+      running_(false) {
+
+    addCommand("help", "help", [this](const vector<string>&) {
+        string usage = "ok";
+        for (const auto& [name, command] : commands_) {
+            usage += " | " + command.usage;
+        }
+        return usage;
+    });
+}
+
+ControlServer::~ControlServer() {
+    stop();
+}
+
+void ControlServer::addCommand(const string& name, const string& usage, ControlHandler handler) {
+    commands_[name] = Command{usage, std::move(handler)};
+}
+
+bool ControlServer::start(const string& socket_path) {
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Socket path too long: " << socket_path << "\n";
+        return false;
+    }
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        cerr << "socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(socket_path.c_str());
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 4) != 0) {
+        cerr << "Failed to listen on " << socket_path << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    socket_path_ = socket_path;
+    running_ = true;
+    thread_ = std::thread([this] { serve(); });
+
+    cout << "✓ Control socket: " << socket_path_ << "\n";
+    return true;
+}
+
+void ControlServer::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        ::unlink(socket_path_.c_str());
+    }
+}
+
+void ControlServer::serve() {
+    // Connections are short-lived and rare; handle one at a time
+    while (running_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+
+        string pending;
+        char buf[256];
+        while (running_) {
+            pollfd cfd{fd, POLLIN, 0};
+            int ready = ::poll(&cfd, 1, 200);
+            if (ready == 0) continue;
+            if (ready < 0) break;
+
+            ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            pending.append(buf, static_cast<size_t>(n));
+
+            size_t eol;
+            while ((eol = pending.find('\n')) != string::npos) {
+                string reply = dispatch(pending.substr(0, eol)) + "\n";
+                pending.erase(0, eol + 1);
+                ::send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+            }
+
+            if (pending.size() > MAX_LINE) break;
+        }
+
+        ::close(fd);
+    }
+}
+
+string ControlServer::dispatch(const string& line) {
+    std::istringstream in(line);
+    string name;
+    vector<string> args;
+    in >> name;
+    for (string arg; in >> arg;) {
+        args.push_back(arg);
+    }
+
+    if (name.empty()) return "error empty command";
+
+    auto it = commands_.find(name);
+    if (it == commands_.end()) return "error unknown command '" + name + "' (try help)";
+
+    try {
+        return it->second.handler(args);
+    } catch (const std::exception& e) {
+        return "error " + string(e.what()) + " (usage: " + it->second.usage + ")";
+    }
+}
@@ -0,0 +1,485 @@
+#include "Core/DenoiseServer.h"
+#include "Core/OnnxInference.h"
+#include "Utils/MemoryStats.h"
+#include "Utils/AllocTracker.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <random>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+static const uint32_t DENOISE_MAGIC = 0x4E4D4453;  // "NMDS"
+static const uint32_t DENOISE_VERSION = 1;
+static const double HOP_BUDGET_MS = 1000.0 * DeepFilterNet::HOP_SIZE / DeepFilterNet::SAMPLE_RATE;
+
+static volatile std::sig_atomic_t daemon_running = 1;
+
+static void daemon_signal_handler(int) {
+    daemon_running = 0;
+}
+
+static bool readAll(int fd, void* data, size_t size) {
+    auto* p = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool writeAll(int fd, const void* data, size_t size) {
+    auto* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// ============================================================================
+// Server
+// ============================================================================
+
+DenoiseServer::DenoiseServer()
+    : model_(nullptr),
+      listen_fd_(-1),
+      max_clients_(0),
+      next_client_id_(0),
+      running_(false),
+      frames_served_(0),
+      last_report_frames_(0) {
+}
+
+DenoiseServer::~DenoiseServer() {
+    stop();
+}
+
+bool DenoiseServer::loadModel(const string& model_path, const MemoryProfile& memory) {
+    try {
+        cout << "Loading DeepFilterNet model...\n";
+        // Clients stream single hops against their own state
+        model_ = std::make_unique<DeepFilterNet>(model_path, 1, memory);
+        cout << "Model loaded successfully\n";
+        return true;
+    } catch (const std::exception& e) {
+        cerr << "Failed to load model: " << e.what() << "\n";
+        return false;
+    }
+}
+
+bool DenoiseServer::loadWarmState(const string& path) {
+    if (!model_) {
+        cerr << "Load a model before its warm state\n";
+        return false;
+    }
+    try {
+        model_->LoadWarmState(path);
+    } catch (const std::exception& e) {
+        cerr << "Failed to load warm state: " << e.what() << "\n";
+        return false;
+    }
+    cout << "✓ Clients start from warm state " << path << "\n";
+    return true;
+}
+
+void DenoiseServer::setNoiseSuppressionStrength(float db) {
+    if (model_) {
+        model_->SetNoiseSuppressionStrength(db);
+    }
+}
+
+bool DenoiseServer::start(const string& socket_path, int workers, int max_clients) {
+    if (!model_) {
+        cerr << "✗ Model not loaded\n";
+        return false;
+    }
+
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Socket path too long: " << socket_path << "\n";
+        return false;
+    }
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        cerr << "socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    ::unlink(socket_path.c_str());
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 64) != 0) {
+        cerr << "Failed to listen on " << socket_path << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    socket_path_ = socket_path;
+    max_clients_ = std::max(1, max_clients);
+    inference_slots_ = std::make_unique<std::counting_semaphore<INT_MAX>>(std::max(1, workers));
+    running_ = true;
+
+    cout << "✓ Denoise daemon listening on " << socket_path_ << "\n";
+    cout << "  Inference workers: " << std::max(1, workers) << "\n";
+    cout << "  Max clients: " << max_clients_ << "\n";
+    printMemory();
+    return true;
+}
+
+void DenoiseServer::run() {
+    if (!running_) {
+        cerr << "Not started. Call start() first.\n";
+        return;
+    }
+
+    daemon_running = 1;
+    std::signal(SIGINT, daemon_signal_handler);
+    std::signal(SIGTERM, daemon_signal_handler);
+
+    cout << "Serving clients... Press Ctrl+C to stop\n";
+
+    auto last_report = std::chrono::steady_clock::now();
+    while (running_ && daemon_running) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, 200);
+        if (ready > 0 && (pfd.revents & POLLIN)) {
+            acceptClient();
+        }
+
+        reapClients(false);
+
+        if (elapsedMs(last_report) >= 5000.0) {
+            printStats();
+            last_report = std::chrono::steady_clock::now();
+        }
+    }
+
+    stop();
+}
+
+void DenoiseServer::stop() {
+    running_ = false;
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        ::unlink(socket_path_.c_str());
+        cout << "\nDenoise daemon stopped\n";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        for (auto& client : clients_) {
+            ::shutdown(client->fd, SHUT_RDWR);
+        }
+    }
+    reapClients(true);
+}
+
+void DenoiseServer::acceptClient() {
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) return;
+
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    if (static_cast<int>(clients_.size()) >= max_clients_) {
+        cerr << "Client rejected: at capacity (" << max_clients_ << ")\n";
+        ::close(fd);
+        return;
+    }
+
+    auto client = std::make_unique<Client>();
+    client->fd = fd;
+    client->id = ++next_client_id_;
+    Client* raw = client.get();
+    client->thread = std::thread([this, raw] { serveClient(raw); });
+    clients_.push_back(std::move(client));
+
+    cout << "Client " << raw->id << " connected (" << clients_.size() << " active)\n";
+}
+
+void DenoiseServer::serveClient(Client* client) {
+    const size_t frame_bytes = DeepFilterNet::HOP_SIZE * sizeof(float);
+    vector<float> input(DeepFilterNet::HOP_SIZE);
+    vector<float> output(DeepFilterNet::HOP_SIZE);
+    StreamState state = model_->CreateStreamState();
+
+    DenoiseHello hello{DENOISE_MAGIC, DENOISE_VERSION,
+                       DeepFilterNet::SAMPLE_RATE, DeepFilterNet::HOP_SIZE};
+
+    if (writeAll(client->fd, &hello, sizeof(hello))) {
+        // Blocking I/O is the backpressure: if the client stops reading,
+        // send() blocks, we stop receiving, and its socket buffer fills.
+        while (running_ && readAll(client->fd, input.data(), frame_bytes)) {
+            RealtimeScope realtime("DenoiseServer::serveClient");
+            auto received = std::chrono::steady_clock::now();
+
+            inference_slots_->acquire();
+            double wait_ms = elapsedMs(received);
+            try {
+                model_->ProcessStreamFrame(input.data(), output.data(), state);
+            } catch (const std::exception& e) {
+                inference_slots_->release();
+                cerr << "Client " << client->id << " inference error: " << e.what() << "\n";
+                break;
+            }
+            inference_slots_->release();
+
+            if (!writeAll(client->fd, output.data(), frame_bytes)) break;
+
+            double total_ms = elapsedMs(received);
+            auto& stats = client->stats;
+            stats.frames++;
+            stats.total_ms += total_ms;
+            stats.wait_ms += wait_ms;
+            stats.max_ms = std::max(stats.max_ms, total_ms);
+            if (total_ms > HOP_BUDGET_MS) stats.over_budget++;
+            frames_served_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // The fd is closed by reapClients() after join so stop() can never
+    // shut down a descriptor number that was already reused
+    client->done = true;
+}
+
+void DenoiseServer::reapClients(bool wait_all) {
+    std::unique_lock<std::mutex> lock(clients_mutex_);
+
+    bool reaped = false;
+    auto it = clients_.begin();
+    while (it != clients_.end()) {
+        Client& client = **it;
+        if (!wait_all && !client.done) {
+            ++it;
+            continue;
+        }
+
+        if (client.thread.joinable()) client.thread.join();
+        ::close(client.fd);
+
+        const auto& stats = client.stats;
+        cout << "Client " << client.id << " disconnected: " << stats.frames << " frames";
+        if (stats.frames > 0) {
+            cout << ", avg " << stats.total_ms / stats.frames << " ms"
+                 << " (wait " << stats.wait_ms / stats.frames << " ms)"
+                 << ", max " << stats.max_ms << " ms"
+                 << ", over budget " << stats.over_budget;
+        }
+        cout << "\n";
+
+        it = clients_.erase(it);
+        reaped = true;
+    }
+
+    bool idle = reaped && clients_.empty();
+    lock.unlock();
+
+    if (idle && running_) {
+        // Nobody is streaming; give back what the arena no longer needs
+        model_->ReleaseIdleMemory();
+        if (model_->GetMemoryProfile().shrink_on_idle) {
+            printMemory();
+        }
+    }
+}
+
+void DenoiseServer::printStats() {
+    uint64_t frames = frames_served_.load(std::memory_order_relaxed);
+
+    size_t active = 0;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        active = clients_.size();
+    }
+
+    cout << "[daemon] clients " << active
+         << " | frames/s " << (frames - last_report_frames_) / 5.0
+         << " | realtime streams " << (frames - last_report_frames_) / 5.0 * HOP_BUDGET_MS / 1000.0
+         << " | rss " << residentBytes() / (1024 * 1024) << " MiB\n";
+    last_report_frames_ = frames;
+}
+
+void DenoiseServer::printMemory() {
+    size_t active = 0;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        active = clients_.size();
+    }
+    
+    // Each client owns a double-buffered recurrent state and hop buffers
+    const size_t per_client = 2 * DeepFilterNet::STATE_SIZE * sizeof(float) +
+                              3 * DeepFilterNet::HOP_SIZE * sizeof(float);
+    
+    ModelMemoryUsage usage = model_->GetMemoryUsage();
+    MemoryReport report;
+    report.add("model", usage.model_bytes, true);
+    report.add("arena", usage.arena_bytes, true);
+    report.add("client state (" + std::to_string(active) + " x " +
+               std::to_string(per_client / 1024) + " KiB)", active * per_client);
+    report.print("Daemon memory");
+}
+
+// ============================================================================
+// Client
+// ============================================================================
+
+DenoiseClient::DenoiseClient()
+    : fd_(-1),
+      hop_size_(0) {
+}
+
+DenoiseClient::~DenoiseClient() {
+    close();
+}
+
+bool DenoiseClient::connect(const string& socket_path) {
+    close();
+
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Socket path too long: " << socket_path << "\n";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        cerr << "Failed to connect to " << socket_path << ": " << std::strerror(errno) << "\n";
+        close();
+        return false;
+    }
+
+    DenoiseHello hello{};
+    if (!readAll(fd_, &hello, sizeof(hello)) ||
+        hello.magic != DENOISE_MAGIC || hello.version != DENOISE_VERSION) {
+        cerr << "Daemon refused the connection or speaks another protocol\n";
+        close();
+        return false;
+    }
+
+    hop_size_ = static_cast<int>(hello.hop_size);
+    return true;
+}
+
+bool DenoiseClient::processFrame(const float* in, float* out) {
+    if (fd_ < 0) return false;
+    size_t frame_bytes = hop_size_ * sizeof(float);
+    return writeAll(fd_, in, frame_bytes) && readAll(fd_, out, frame_bytes);
+}
+
+void DenoiseClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+// ============================================================================
+// Load test
+// ============================================================================
+
+int runDenoiseLoadTest(const string& socket_path, int clients, int seconds) {
+    struct Result {
+        bool ok = false;
+        vector<double> rtt_ms;
+        uint64_t late = 0;
+    };
+
+    clients = std::max(1, clients);
+    vector<Result> results(clients);
+    vector<std::thread> threads;
+
+    cout << "Load test: " << clients << " clients x " << seconds << " s against " << socket_path << "\n";
+
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            DenoiseClient client;
+            if (!client.connect(socket_path)) return;
+
+            // Speech-band tone over white noise, paced at one hop per 10 ms
+            std::mt19937 rng(c + 1);
+            std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+            vector<float> in(client.hopSize());
+            vector<float> out(client.hopSize());
+            auto& r = results[c];
+            r.rtt_ms.reserve(static_cast<size_t>(seconds) * 100);
+
+            auto period = std::chrono::microseconds(static_cast<int64_t>(HOP_BUDGET_MS * 1000.0));
+            auto next = std::chrono::steady_clock::now();
+            auto end = next + std::chrono::seconds(seconds);
+            size_t t = 0;
+
+            while (next < end) {
+                for (auto& s : in) {
+                    s = 0.2f * std::sin(2.0f * static_cast<float>(M_PI) * 300.0f * t++ / DeepFilterNet::SAMPLE_RATE) + noise(rng);
+                }
+
+                auto sent = std::chrono::steady_clock::now();
+                if (!client.processFrame(in.data(), out.data())) return;
+                double rtt = elapsedMs(sent);
+                r.rtt_ms.push_back(rtt);
+                if (rtt > HOP_BUDGET_MS) r.late++;
+
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+            r.ok = true;
+        });
+    }
+
+    for (auto& t : threads) t.join();
+
+    int failures = 0;
+    vector<double> all;
+    for (int c = 0; c < clients; ++c) {
+        auto& r = results[c];
+        if (!r.ok || r.rtt_ms.empty()) {
+            cout << "  client " << c << ": FAILED\n";
+            failures++;
+            continue;
+        }
+        all.insert(all.end(), r.rtt_ms.begin(), r.rtt_ms.end());
+        std::sort(r.rtt_ms.begin(), r.rtt_ms.end());
+        cout << "  client " << c << ": " << r.rtt_ms.size() << " frames"
+             << " | p50 " << r.rtt_ms[r.rtt_ms.size() / 2] << " ms"
+             << " | p99 " << r.rtt_ms[r.rtt_ms.size() * 99 / 100] << " ms"
+             << " | max " << r.rtt_ms.back() << " ms"
+             << " | late " << r.late << "\n";
+    }
+
+    if (!all.empty()) {
+        std::sort(all.begin(), all.end());
+        cout << "All clients: p50 " << all[all.size() / 2] << " ms"
+             << " | p99 " << all[all.size() * 99 / 100] << " ms"
+             << " | max " << all.back() << " ms\n";
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,327 @@
+#include "Core/MultiMicEngine.h"
+#include "Core/OnnxInference.h"
+#include "Utils/AllocTracker.h"
+#include "Utils/Tracer.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+static const auto HOP_DURATION = std::chrono::microseconds(
+    1'000'000LL * DeepFilterNet::HOP_SIZE / DeepFilterNet::SAMPLE_RATE);
+static const uint64_t HOP_BUDGET_NS = 1'000'000'000ULL * DeepFilterNet::HOP_SIZE / DeepFilterNet::SAMPLE_RATE;
+
+static uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MultiMicEngine::MultiMicEngine()
+    : model_(nullptr),
+      workers_(0),
+      initialized_(false) {
+}
+
+MultiMicEngine::~MultiMicEngine() {
+    stop();
+}
+
+bool MultiMicEngine::loadModel(const string& model_path, int workers, const MemoryProfile& memory) {
+    try {
+        cout << "Loading DeepFilterNet model...\n";
+        model_ = std::make_unique<DeepFilterNet>(model_path, 1, memory);
+    } catch (const std::exception& e) {
+        cerr << "Failed to load model: " << e.what() << "\n";
+        return false;
+    }
+
+    workers_ = std::max(1, workers);
+    inference_slots_ = std::make_unique<std::counting_semaphore<INT_MAX>>(workers_);
+    cout << "✓ Model loaded, " << workers_ << " inference workers\n";
+    return true;
+}
+
+bool MultiMicEngine::loadWarmState(const string& path) {
+    if (!model_) {
+        cerr << "Load a model before its warm state\n";
+        return false;
+    }
+    try {
+        model_->LoadWarmState(path);
+    } catch (const std::exception& e) {
+        cerr << "Failed to load warm state: " << e.what() << "\n";
+        return false;
+    }
+    cout << "✓ Streams start from warm state " << path << "\n";
+    return true;
+}
+
+void MultiMicEngine::setNoiseSuppressionStrength(float db) {
+    if (model_) model_->SetNoiseSuppressionStrength(db);
+}
+
+vector<string> MultiMicEngine::listMicrophones() {
+    MicrophoneReader probe;
+    available_mics_ = probe.listDevices();
+    return available_mics_;
+}
+
+std::unique_ptr<MultiMicEngine::Stream> MultiMicEngine::createStream(int id, const string& device) {
+    auto stream = std::make_unique<Stream>();
+    stream->id = id;
+    stream->device = device;
+    stream->state = std::make_unique<StreamState>(model_->CreateStreamState());
+    stream->frame.assign(DeepFilterNet::HOP_SIZE, 0.0f);
+    stream->dry_delay.assign(model_->StreamLatency(), 0);
+    return stream;
+}
+
+bool MultiMicEngine::addMicrophone(int index) {
+    if (!model_) {
+        cerr << "Load a model before adding microphones\n";
+        return false;
+    }
+    if (available_mics_.empty()) {
+        listMicrophones();
+    }
+    if (index < 0 || index >= static_cast<int>(available_mics_.size())) {
+        cerr << "Invalid microphone index: " << index << "\n";
+        return false;
+    }
+
+    const string& device = available_mics_[index];
+    for (const auto& stream : streams_) {
+        if (stream->device == device) {
+            cerr << "Microphone already added: " << device << "\n";
+            return false;
+        }
+    }
+
+    auto stream = createStream(static_cast<int>(streams_.size()), device);
+    stream->reader = std::make_unique<MicrophoneReader>();
+    stream->reader->listDevices();
+    if (!stream->reader->selectDevice(device)) {
+        return false;
+    }
+
+    cout << "✓ Stream " << stream->id << ": " << device << "\n";
+    streams_.push_back(std::move(stream));
+    return true;
+}
+
+bool MultiMicEngine::enableSharedOutput(const string& prefix) {
+    shm_prefix_ = prefix;
+    return true;
+}
+
+bool MultiMicEngine::initialize() {
+    if (streams_.empty()) {
+        cerr << "No microphones added\n";
+        return false;
+    }
+
+    for (auto& stream : streams_) {
+        Stream* s = stream.get();
+        s->reader->setAudioCallback([this, s](int16_t* samples, size_t count) {
+            processHop(*s, samples, count);
+        });
+        s->reader->setProcessingDelay(model_->StreamLatency());
+
+        if (!shm_prefix_.empty() &&
+            !s->reader->setSharedOutput(shm_prefix_ + std::to_string(s->id))) {
+            return false;
+        }
+        if (!s->reader->initialize()) {
+            cerr << "Stream " << s->id << " failed to initialize\n";
+            return false;
+        }
+    }
+
+    initialized_ = true;
+    return true;
+}
+
+// Capture thread of one stream; runs the shared session on this stream's state
+void MultiMicEngine::processHop(Stream& stream, int16_t* samples, size_t count) {
+    RealtimeScope realtime("MultiMicEngine::processHop");
+    TraceScope trace("processHop", static_cast<uint32_t>(stream.id));
+    if (count != stream.frame.size()) return;
+
+    uint64_t start = nowNs();
+
+    // Raw input goes into the delay line and `samples` comes back holding
+    // the input from one stream latency ago. That plays if this hop is
+    // bypassed or fails, lined up with the model's output instead of
+    // jumping back in time.
+    const size_t delay = stream.dry_delay.size();
+    for (size_t i = 0; i < count; ++i) {
+        stream.frame[i] = static_cast<float>(samples[i]) / 32768.0f;
+        if (delay > 0) {
+            std::swap(samples[i], stream.dry_delay[stream.dry_pos]);
+            stream.dry_pos = (stream.dry_pos + 1) % delay;
+        }
+    }
+
+    // Waiting longer than half a hop would make this stream late anyway
+    if (!inference_slots_->try_acquire_for(HOP_DURATION / 2)) {
+        stream.bypassed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    try {
+        model_->ProcessStreamFrame(stream.frame.data(), stream.frame.data(), *stream.state);
+    } catch (const std::exception& e) {
+        inference_slots_->release();
+        cerr << "Stream " << stream.id << " inference error: " << e.what() << "\n";
+        return;
+    }
+    inference_slots_->release();
+
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = static_cast<int16_t>(std::clamp(stream.frame[i] * 32767.0f, -32768.0f, 32767.0f));
+    }
+
+    uint64_t ns = nowNs() - start;
+    stream.frames.fetch_add(1, std::memory_order_relaxed);
+    stream.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > HOP_BUDGET_NS) stream.over_budget.fetch_add(1, std::memory_order_relaxed);
+    if (ns > stream.max_ns.load(std::memory_order_relaxed)) {
+        stream.max_ns.store(ns, std::memory_order_relaxed);
+    }
+}
+
+void MultiMicEngine::run() {
+    if (!initialized_) {
+        cerr << "Not initialized. Call initialize() first.\n";
+        return;
+    }
+
+    cout << "\n=== MULTI-MIC NOISE SUPPRESSION ACTIVE (" << streams_.size() << " streams) ===\n";
+    cout << "Press Ctrl+C to stop...\n\n";
+
+    // Each reader pumps its own device until Ctrl+C
+    for (auto& stream : streams_) {
+        MicrophoneReader* reader = stream->reader.get();
+        stream->thread = std::thread([reader] { reader->processAudio(); });
+    }
+    for (auto& stream : streams_) {
+        stream->thread.join();
+    }
+
+    printStats();
+}
+
+void MultiMicEngine::stop() {
+    for (auto& stream : streams_) {
+        if (stream->reader) stream->reader->cleanup();
+        if (stream->thread.joinable()) stream->thread.join();
+    }
+    initialized_ = false;
+}
+
+vector<MicStreamStats> MultiMicEngine::stats() const {
+    vector<MicStreamStats> result;
+    for (const auto& stream : streams_) {
+        MicStreamStats s;
+        s.id = stream->id;
+        s.device = stream->device;
+        s.frames = stream->frames.load(std::memory_order_relaxed);
+        s.bypassed = stream->bypassed.load(std::memory_order_relaxed);
+        s.over_budget = stream->over_budget.load(std::memory_order_relaxed);
+        s.avg_ms = s.frames ? stream->total_ns.load(std::memory_order_relaxed) / 1e6 / s.frames : 0.0;
+        s.max_ms = stream->max_ns.load(std::memory_order_relaxed) / 1e6;
+        if (stream->reader) s.xruns = stream->reader->getXrunStats();
+        result.push_back(s);
+    }
+    return result;
+}
+
+void MultiMicEngine::printStats() const {
+    cout << "\n=== Per-Stream Stats ===\n";
+    for (const auto& s : stats()) {
+        cout << "  [" << s.id << "] " << s.device << "\n"
+             << "      frames " << s.frames
+             << " | avg " << s.avg_ms << " ms | max " << s.max_ms << " ms"
+             << " | over budget " << s.over_budget
+             << " | bypassed " << s.bypassed
+             << " | overflows " << s.xruns.input_overflows << "\n";
+    }
+}
+
+int MultiMicEngine::benchmarkStreams(int seconds, int max_streams) {
+    if (!model_) {
+        cerr << "Load a model first\n";
+        return 1;
+    }
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    // A tone under noise, long enough that every stream loops it
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 1500.0f);
+    vector<int16_t> signal(DeepFilterNet::SAMPLE_RATE);
+    for (size_t i = 0; i < signal.size(); ++i) {
+        float tone = 6000.0f * std::sin(2.0f * static_cast<float>(M_PI) * 300.0f * i / DeepFilterNet::SAMPLE_RATE);
+        signal[i] = static_cast<int16_t>(std::clamp(tone + noise(rng), -32768.0f, 32767.0f));
+    }
+
+    cout << "\n=== Streams per Core (" << workers_ << " workers, " << cores << " cores, "
+         << seconds << " s per step) ===\n";
+
+    int sustained = 0;
+    for (int n = 1; n <= max_streams; ++n) {
+        vector<std::unique_ptr<Stream>> streams;
+        for (int i = 0; i < n; ++i) {
+            streams.push_back(createStream(i, "synthetic " + std::to_string(i)));
+        }
+
+        // Every stream delivers one hop per 10 ms, staggered across the period
+        auto begin = std::chrono::steady_clock::now();
+        vector<std::thread> threads;
+        for (auto& stream : streams) {
+            Stream* s = stream.get();
+            threads.emplace_back([this, s, n, seconds, begin, &signal] {
+                const size_t hop = DeepFilterNet::HOP_SIZE;
+                vector<int16_t> samples(hop);
+                auto next = begin + HOP_DURATION * s->id / n;
+                const size_t hops = static_cast<size_t>(seconds) * DeepFilterNet::SAMPLE_RATE / hop;
+                for (size_t h = 0; h < hops; ++h) {
+                    std::this_thread::sleep_until(next);
+                    size_t offset = (h * hop) % (signal.size() - hop);
+                    std::copy(signal.begin() + offset, signal.begin() + offset + hop, samples.begin());
+                    processHop(*s, samples.data(), hop);
+                    next += HOP_DURATION;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        uint64_t processed = 0, bypassed = 0, missed = 0, total_ns = 0;
+        for (const auto& stream : streams) {
+            processed += stream->frames;
+            bypassed += stream->bypassed;
+            missed += stream->over_budget + stream->bypassed;
+            total_ns += stream->total_ns;
+        }
+        uint64_t frames = processed + bypassed;
+        double miss_rate = frames ? static_cast<double>(missed) / frames : 1.0;
+        double avg_ms = processed ? total_ns / 1e6 / processed : 0.0;
+
+        cout << "  " << n << " streams: avg " << avg_ms << " ms/hop, "
+             << miss_rate * 100.0 << "% missed" << (miss_rate > 0.01 ? "  ✗\n" : "  ✓\n");
+        if (miss_rate > 0.01) break;
+        sustained = n;
+    }
+
+    cout << "\n  Sustained: " << sustained << " streams, "
+         << static_cast<double>(sustained) / cores << " streams per core\n";
+    return sustained > 0 ? 0 : 1;
+}
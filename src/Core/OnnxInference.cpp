@@ -1,10 +1,15 @@
 #include "Core/OnnxInference.h"
+#include "Utils/MemoryStats.h"
+#include "Utils/AllocTracker.h"
+#include "Utils/Tracer.h"
 #include <algorithm>
+#include <cctype>
 #include <cstring>
 #include <stdexcept>
 #include <iostream>
 #include <string>
 #include <filesystem>
+#include <fstream>
 
 using std::vector; 
 using std::string;
@@ -16,36 +21,415 @@ using std::move;
 using std::copy;
 using std::cerr;
 
-DeepFilterNet::DeepFilterNet(const std::string& model_path) 
+MemoryProfile MemoryProfile::LowMemory() 
+{
+    MemoryProfile profile;
+    profile.arena_exact = true;
+    profile.mem_pattern = false;
+    profile.shrink_on_idle = true;
+    return profile;
+}
+
+bool MemoryProfile::Parse(const string& spec, MemoryProfile& profile) 
+{
+    size_t colon = spec.find(':');
+    string name = spec.substr(0, colon);
+    
+    if (name == "default") 
+    {
+        profile = MemoryProfile();
+    } 
+    else if (name == "low") 
+    {
+        profile = LowMemory();
+    } 
+    else 
+    {
+        return false;
+    }
+    
+    if (colon != string::npos) 
+    {
+        string megabytes = spec.substr(colon + 1);
+        if (megabytes.empty() || !std::isdigit(static_cast<unsigned char>(megabytes[0]))) return false;
+        try 
+        {
+            size_t used = 0;
+            profile.arena_limit = std::stoul(megabytes, &used) * 1024 * 1024;
+            if (used != megabytes.size()) return false;
+        } catch (const std::exception&) 
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+DeepFilterNet::DeepFilterNet(const std::string& model_path, int hops_per_run, const MemoryProfile& memory,
+                             const std::string& profile_prefix, bool console_output) 
     : env_(ORT_LOGGING_LEVEL_WARNING, "DenoiserInference"),
       session_options_(),
       session_(nullptr),
       memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
       allocator(),
-      state_(STATE_SIZE, 0.0f),
-      atten_lim_db_(0.0f) {
+      state_(),
+      atten_lim_db_(0.0f),
+      model_frame_hops_(1),
+      model_frame_rank_(1),
+      model_output_rank_(1),
+      hops_per_run_(1),
+      batch_fill_(0),
+      memory_profile_(memory),
+      console_output_(console_output) {
 
     session_options_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
     session_options_.SetIntraOpNumThreads(1);
     session_options_.SetInterOpNumThreads(1);
     session_options_.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+    ApplyMemoryProfile();
+    if (!profile_prefix.empty()) 
+    {
+        session_options_.EnableProfiling(profile_prefix.c_str());
+    }
     
+    size_t rss_before = residentBytes();
     session_ = Ort::Session(env_, model_path.c_str(), session_options_);
-    PrintModelSummary();
+    memory_usage_.model_bytes = std::max(residentBytes(), rss_before) - rss_before;
+    if (console_output_) PrintModelSummary();
+    
+    // input_frame is [K*HOP] or [K, HOP]; a negative dimension means dynamic
+    auto frame_shape = session_.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    int64_t frame_samples = 1;
+    for (int64_t dim : frame_shape) 
+    {
+        frame_samples = (dim < 0 || frame_samples < 0) ? -1 : frame_samples * dim;
+    }
+    model_frame_hops_ = frame_samples < 0 ? 0 : static_cast<int>(frame_samples / HOP_SIZE);
+    model_frame_rank_ = frame_shape.size() == 2 ? 2 : 1;
+    model_output_rank_ = session_.GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape().size() == 2 ? 2 : 1;
+    
+    if (hops_per_run == 0) 
+    {
+        hops_per_run_ = model_frame_hops_ > 0 ? model_frame_hops_ : 1;
+    } 
+    else if (model_frame_hops_ == 0 || hops_per_run == model_frame_hops_) 
+    {
+        hops_per_run_ = hops_per_run;
+    } 
+    else 
+    {
+        throw runtime_error("Model takes " + std::to_string(model_frame_hops_) + 
+                            " hops per run, " + std::to_string(hops_per_run) + " requested");
+    }
+    
+    batch_in_.assign(hops_per_run_ * HOP_SIZE, 0.0f);
+    batch_out_.assign(hops_per_run_ * HOP_SIZE, 0.0f);
+    state_ = CreateStreamState();
+    if (console_output_ && hops_per_run_ > 1) 
+    {
+        cout << "Running " << hops_per_run_ << " hops per inference call\n";
+    }
+    
+    // Warm-up on throwaway state: sizes the arena before any stream starts
+    size_t rss_loaded = residentBytes();
+    StreamState scratch_state = CreateStreamState();
+    vector<float> silence(batch_in_.size(), 0.0f);
+    ProcessStreamFrames(silence.data(), silence.data(), hops_per_run_, scratch_state);
+    memory_usage_.arena_bytes = std::max(residentBytes(), rss_loaded) - rss_loaded;
+}
+
+void DeepFilterNet::ApplyMemoryProfile() 
+{
+    const MemoryProfile& m = memory_profile_;
+    
+    if (!m.use_arena) 
+    {
+        session_options_.DisableCpuMemArena();
+    } 
+    else if (m.arena_exact || m.arena_limit > 0) 
+    {
+        // A session arena can't be tuned directly; register a configured
+        // one on this model's environment and have the session use it
+        Ort::ArenaCfg arena(m.arena_limit, m.arena_exact ? 1 : 0, -1, -1);
+        env_.CreateAndRegisterAllocator(memory_info_, arena);
+        session_options_.AddConfigEntry("session.use_env_allocators", "1");
+    }
+    
+    if (!m.mem_pattern) 
+    {
+        session_options_.DisableMemPattern();
+    }
+}
+
+ModelMemoryUsage DeepFilterNet::GetMemoryUsage() const 
+{
+    ModelMemoryUsage usage = memory_usage_;
+    usage.state_bytes = (state_.current.size() + state_.next.size() + state_.enhanced.size() +
+                         batch_in_.size() + batch_out_.size()) * sizeof(float);
+    return usage;
+}
+
+string DeepFilterNet::EndProfiling() 
+{
+    return session_.EndProfilingAllocated(allocator).get();
+}
+
+void DeepFilterNet::ReleaseIdleMemory() 
+{
+    if (!memory_profile_.shrink_on_idle || !memory_profile_.use_arena) return;
+    
+    Ort::RunOptions shrink;
+    shrink.AddConfigEntry("memory.enable_memory_arena_shrinkage", "cpu:0");
+    
+    StreamState scratch_state = CreateStreamState();
+    vector<float> silence(batch_in_.size(), 0.0f);
+    RunModel(silence.data(), silence.data(), hops_per_run_, scratch_state, shrink);
 }
 
 DeepFilterNet::~DeepFilterNet() {  }
 
+void StreamState::reset() 
+{
+    std::fill(current.begin(), current.end(), 0.0f);
+}
+
+// ============================================================================
+// STATE CHECKPOINTS
+// ============================================================================
+
+namespace {
+    const char STATE_MAGIC[4] = {'N', 'M', 'S', 'T'};
+    const char QUEUE_MAGIC[4] = {'N', 'M', 'S', 'Q'};
+    const uint32_t STATE_VERSION = 1;
+
+    void writeU32(std::ostream& out, uint32_t value) 
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    uint32_t readU32(std::istream& in) 
+    {
+        uint32_t value = 0;
+        in.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+    void writeFloats(std::ostream& out, const vector<float>& values) 
+    {
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+    }
+
+    void readFloats(std::istream& in, vector<float>& values) 
+    {
+        in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float));
+    }
+
+    void expectMagic(std::istream& in, const char (&magic)[4], const char* what) 
+    {
+        char found[4] = {};
+        in.read(found, sizeof(found));
+        if (!in || std::memcmp(found, magic, sizeof(found)) != 0) 
+        {
+            throw runtime_error(string("Not a ") + what);
+        }
+    }
+}
+
+void StreamState::save(std::ostream& out) const 
+{
+    out.write(STATE_MAGIC, sizeof(STATE_MAGIC));
+    writeU32(out, STATE_VERSION);
+    writeU32(out, static_cast<uint32_t>(current.size()));
+    writeFloats(out, current);
+    if (!out) 
+    {
+        throw runtime_error("Failed to write stream state");
+    }
+}
+
+void StreamState::load(std::istream& in) 
+{
+    expectMagic(in, STATE_MAGIC, "stream state");
+    uint32_t version = readU32(in);
+    uint32_t size = readU32(in);
+    if (version != STATE_VERSION) 
+    {
+        throw runtime_error("Unsupported stream state version " + std::to_string(version));
+    }
+    if (size != DeepFilterNet::STATE_SIZE) 
+    {
+        throw runtime_error("Stream state holds " + std::to_string(size) + " values, model needs " +
+                            std::to_string(DeepFilterNet::STATE_SIZE));
+    }
+    
+    vector<float> loaded(size);
+    readFloats(in, loaded);
+    if (!in) 
+    {
+        throw runtime_error("Stream state is truncated");
+    }
+    current.swap(loaded);
+    next.resize(size);
+}
+
+void StreamState::save(const string& path) const 
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out) 
+    {
+        throw runtime_error("Cannot create " + path);
+    }
+    save(out);
+}
+
+void StreamState::load(const string& path) 
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) 
+    {
+        throw runtime_error("Cannot open " + path);
+    }
+    load(in);
+}
+
+void DeepFilterNet::SetWarmState(const StreamState& warm) 
+{
+    if (pipeline_) 
+    {
+        throw runtime_error("Warm states don't apply to pipelined stages, which keep their own state");
+    }
+    if (warm.current.size() != STATE_SIZE) 
+    {
+        throw runtime_error("Warm state must hold " + std::to_string(STATE_SIZE) + " values");
+    }
+    warm_state_.current = warm.current;
+}
+
+void DeepFilterNet::LoadWarmState(const string& path) 
+{
+    StreamState warm;
+    warm.load(path);
+    SetWarmState(warm);
+}
+
+StreamState DeepFilterNet::CaptureState(std::span<const float> audio) 
+{
+    StreamState state;
+    state.current.assign(STATE_SIZE, 0.0f);
+    state.next.assign(STATE_SIZE, 0.0f);
+    state.enhanced.assign(batch_in_.size(), 0.0f);
+    
+    // Whole runs only; a partial tail would be padded with silence
+    vector<float> scratch(batch_in_.size());
+    for (size_t pos = 0; pos + scratch.size() <= audio.size(); pos += scratch.size()) 
+    {
+        ProcessStreamFrames(audio.data() + pos, scratch.data(), hops_per_run_, state);
+    }
+    return state;
+}
+
+void DeepFilterNet::SaveState(std::ostream& out) const 
+{
+    if (pipeline_) 
+    {
+        throw runtime_error("Can't checkpoint pipelined stages, which keep their own state");
+    }
+    state_.save(out);
+    out.write(QUEUE_MAGIC, sizeof(QUEUE_MAGIC));
+    writeU32(out, static_cast<uint32_t>(hops_per_run_));
+    writeU32(out, static_cast<uint32_t>(batch_fill_));
+    writeFloats(out, batch_in_);
+    writeFloats(out, batch_out_);
+    if (!out) 
+    {
+        throw runtime_error("Failed to write stream state");
+    }
+}
+
+void DeepFilterNet::RestoreState(std::istream& in) 
+{
+    if (pipeline_) 
+    {
+        throw runtime_error("Can't checkpoint pipelined stages, which keep their own state");
+    }
+    StreamState restored;
+    restored.load(in);
+    
+    expectMagic(in, QUEUE_MAGIC, "stream checkpoint");
+    uint32_t hops = readU32(in);
+    uint32_t fill = readU32(in);
+    if (!in || hops == 0 || hops > 1024 || fill >= hops) 
+    {
+        throw runtime_error("Stream checkpoint is corrupt");
+    }
+    vector<float> queued_in(static_cast<size_t>(hops) * HOP_SIZE);
+    vector<float> queued_out(queued_in.size());
+    readFloats(in, queued_in);
+    readFloats(in, queued_out);
+    if (!in) 
+    {
+        throw runtime_error("Stream checkpoint is truncated");
+    }
+    
+    // Hops part-way through a K-hop run only fit an instance with the same K
+    if (static_cast<int>(hops) == hops_per_run_) 
+    {
+        batch_in_.swap(queued_in);
+        batch_out_.swap(queued_out);
+        batch_fill_ = static_cast<int>(fill);
+    } 
+    else if (fill == 0) 
+    {
+        std::fill(batch_in_.begin(), batch_in_.end(), 0.0f);
+        std::fill(batch_out_.begin(), batch_out_.end(), 0.0f);
+        batch_fill_ = 0;
+    } 
+    else 
+    {
+        throw runtime_error("Checkpoint has hops queued for K=" + std::to_string(hops) +
+                            ", this model runs K=" + std::to_string(hops_per_run_));
+    }
+    state_.current.swap(restored.current);
+}
+
 void DeepFilterNet::reset() 
 {
-    std::fill(state_.begin(), state_.end(), 0.0f);
+    if (HasWarmState()) 
+    {
+        std::copy(warm_state_.current.begin(), warm_state_.current.end(), state_.current.begin());
+    } 
+    else 
+    {
+        state_.reset();
+    }
+    std::fill(batch_in_.begin(), batch_in_.end(), 0.0f);
+    std::fill(batch_out_.begin(), batch_out_.end(), 0.0f);
+    batch_fill_ = 0;
+    if (pipeline_) pipeline_->reset();
+}
+
+void DeepFilterNet::EnablePipeline(const PipelineConfig& config) 
+{
+    if (!PipelineConfig::Available()) 
+    {
+        throw runtime_error("Pipelined stages not built in (configure with -DNEURALMIC_STAGE_PIPELINE=ON)");
+    }
+    if (hops_per_run_ != 1) 
+    {
+        throw runtime_error("Pipelined stages run one hop at a time, this model runs K=" +
+                            std::to_string(hops_per_run_));
+    }
+    if (HasWarmState()) 
+    {
+        throw runtime_error("Warm states don't apply to pipelined stages, which keep their own state");
+    }
+    pipeline_ = std::make_unique<StagePipeline>(config, memory_profile_, atten_lim_db_);
 }
 
 void DeepFilterNet::SetNoiseSuppressionStrength(float db) 
 {
     // db range: -100.0 (very aggressive) to -50.0 (gentle)
-    atten_lim_db_ = std::clamp(db, -100.0f, 0.0f);
-    cout << "Attenuation set to: " << atten_lim_db_ << " dB\n";
+    atten_lim_db_.store(std::clamp(db, -100.0f, 0.0f), std::memory_order_relaxed);
 }
 
 vector<float> DeepFilterNet::ApplyNoiseSuppression(const vector<float>& audio) 
@@ -55,25 +439,61 @@ vector<float> DeepFilterNet::ApplyNoiseSuppression(const vector<float>& audio)
         throw std::runtime_error("Input audio is empty");
     }
 
-    // Prepare padded audio
-    auto padded = GetPaddedAudio(audio);
-    int orig_len = audio.size() + ((HOP_SIZE - (audio.size() % HOP_SIZE)) % HOP_SIZE);
-    
-    cout << "Processing " << (padded.size() / HOP_SIZE) << " frames...\n";
+    vector<float> enhanced((audio.size() + HOP_SIZE - 1) / HOP_SIZE * HOP_SIZE);
+    ApplyNoiseSuppression(std::span<const float>(audio), std::span<float>(enhanced));
+    return enhanced;
+}
+
+void DeepFilterNet::ApplyNoiseSuppression(std::span<const float> input, std::span<float> output) 
+{
+    size_t written = 0;
+    ApplyNoiseSuppression(input, output.size(), [&](const float* samples, size_t count) {
+        std::copy(samples, samples + count, output.begin() + written);
+        written += count;
+    });
+}
 
-    // Process each frame
-    vector<float> enhanced;
-    enhanced.reserve(padded.size());
+void DeepFilterNet::ApplyNoiseSuppression(std::span<const float> input, size_t output_length,
+                                          const OfflineSink& sink) 
+{
+    // Output is delayed by the look-ahead; run until it has all come out,
+    // in whole runs of K hops
+    const size_t delay = FFT_SIZE - HOP_SIZE;
+    const size_t run_size = static_cast<size_t>(hops_per_run_) * HOP_SIZE;
+    const size_t needed = delay + output_length;
+    const size_t total = (needed + run_size - 1) / run_size * run_size;
     
-    for (size_t i = 0; i + HOP_SIZE <= padded.size(); i += HOP_SIZE) 
+    if (console_output_) 
     {
-        vector<float> frame(padded.begin() + i, padded.begin() + i + HOP_SIZE);
-        auto enhanced_frame = GetEnhancedFrame(frame);
-        enhanced.insert(enhanced.end(), enhanced_frame.begin(), enhanced_frame.end());
+        cout << "Processing " << (total / HOP_SIZE) << " frames...\n";
     }
 
-    // Trim padding and return
-    return GetTrimmedOutput(enhanced, orig_len);
+    vector<float> staged(run_size);   // a run that reaches past the input
+    vector<float> enhanced(run_size);
+    
+    for (size_t pos = 0; pos < total; pos += run_size) 
+    {
+        const float* frames = staged.data();
+        if (pos + run_size <= input.size()) 
+        {
+            frames = input.data() + pos;
+        }
+        else 
+        {
+            size_t available = pos < input.size() ? input.size() - pos : 0;
+            std::copy_n(input.begin() + std::min(pos, input.size()), available, staged.begin());
+            std::fill(staged.begin() + available, staged.end(), 0.0f);
+        }
+        ProcessStreamFrames(frames, enhanced.data(), hops_per_run_, state_);
+        
+        // Keep what falls in [delay, delay + output_length)
+        size_t begin = std::max(pos, delay);
+        size_t end = std::min(pos + run_size, needed);
+        if (begin < end) 
+        {
+            sink(enhanced.data() + (begin - pos), end - begin);
+        }
+    }
 }
 
 vector<float> DeepFilterNet::ProcessRealtimeFrame(const vector<float>& frame) 
@@ -87,75 +507,133 @@ vector<float> DeepFilterNet::ProcessRealtimeFrame(const vector<float>& frame)
     return GetEnhancedFrame(frame);
 }
 
-vector<float> DeepFilterNet::GetPaddedAudio(const vector<float>& audio) 
+void DeepFilterNet::ProcessRealtimeFrame(const float* frame, float* out) 
 {
-    int hop_padding = (HOP_SIZE - (audio.size() % HOP_SIZE)) % HOP_SIZE;
-    int total_padding = FFT_SIZE + hop_padding;
+    TraceScope trace("GetEnhancedFrame");
+    if (pipeline_) 
+    {
+        pipeline_->process(frame, out);
+        return;
+    }
+    if (hops_per_run_ == 1) 
+    {
+        ProcessStreamFrame(frame, out, state_);
+        return;
+    }
     
-    vector<float> padded = audio;
-    padded.resize(audio.size() + total_padding, 0.0f);
-    return padded;
+    // Queue the hop; once K are in, run them and play the batch back one
+    // hop per call. Input is copied first since `out` may alias `frame`.
+    std::copy(frame, frame + HOP_SIZE, batch_in_.begin() + batch_fill_ * HOP_SIZE);
+    if (batch_fill_ == hops_per_run_ - 1) 
+    {
+        ProcessStreamFrames(batch_in_.data(), batch_out_.data(), hops_per_run_, state_);
+    }
+    batch_fill_ = (batch_fill_ + 1) % hops_per_run_;
+    
+    const float* ready = batch_out_.data() + batch_fill_ * HOP_SIZE;
+    std::copy(ready, ready + HOP_SIZE, out);
 }
 
-vector<float> DeepFilterNet::GetEnhancedFrame(const vector<float>& frame) 
+StreamState DeepFilterNet::CreateStreamState() const 
 {
-    // Create input tensors
-    int64_t frame_shape[] = {HOP_SIZE};
-    int64_t state_shape[] = {STATE_SIZE};
-    int64_t atten_shape[] = {1};
-    
-    float atten = atten_lim_db_;
+    StreamState state;
+    state.current = HasWarmState() ? warm_state_.current : vector<float>(STATE_SIZE, 0.0f);
+    state.next.assign(STATE_SIZE, 0.0f);
+    state.enhanced.assign(static_cast<size_t>(hops_per_run_) * HOP_SIZE, 0.0f);
+    return state;
+}
 
-    Ort::Value input_frame = Ort::Value::CreateTensor<float>(
-        memory_info_, const_cast<float*>(frame.data()), frame.size(), frame_shape, 1);
-    
-    Ort::Value input_state = Ort::Value::CreateTensor<float>(
-        memory_info_, state_.data(), state_.size(), state_shape, 1);
-    
-    Ort::Value input_atten = Ort::Value::CreateTensor<float>(
-        memory_info_, &atten, 1, atten_shape, 1);
+void DeepFilterNet::ProcessStreamFrame(const float* frame, float* out, StreamState& state) 
+{
+    ProcessStreamFrames(frame, out, 1, state);
+}
 
-    // Run inference
-    const char* input_names[] = {"input_frame", "states", "atten_lim_db"};
-    const char* output_names[] = {"enhanced_audio_frame", "new_states", "lsnr"};
-    
-    Ort::Value inputs[] = {
-        std::move(input_frame),
-        std::move(input_state),
-        std::move(input_atten)
-    };
+void DeepFilterNet::ProcessStreamFrames(const float* frames, float* out, int hops, StreamState& state) 
+{
+    RunModel(frames, out, hops, state, Ort::RunOptions{nullptr});
+}
 
-    auto outputs = session_.Run(
-        Ort::RunOptions{nullptr},
-        input_names, inputs, 3,
-        output_names, 3
-    );
+void DeepFilterNet::RunModel(const float* frames, float* out, int hops, StreamState& state,
+                             const Ort::RunOptions& run_options) 
+{
+    if (state.current.size() != STATE_SIZE) 
+    {
+        throw std::runtime_error("Stream state must hold " + std::to_string(STATE_SIZE) + " values");
+    }
+    if (hops < 1 || (model_frame_hops_ != 0 && hops != model_frame_hops_)) 
+    {
+        throw std::runtime_error("Model takes " + std::to_string(model_frame_hops_) + " hops per run");
+    }
 
-    // Extract enhanced frame
-    float* enhanced_data = outputs[0].GetTensorMutableData<float>();
-    size_t enhanced_count = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
-    
-    // Update state
-    float* new_state = outputs[1].GetTensorMutableData<float>();
-    size_t state_count = outputs[1].GetTensorTypeAndShapeInfo().GetElementCount();
-    std::copy(new_state, new_state + std::min(state_count, (size_t)STATE_SIZE), state_.begin());
+    const int64_t frame_samples = static_cast<int64_t>(hops) * HOP_SIZE;
+    if (state.next.size() != STATE_SIZE || state.enhanced.size() < static_cast<size_t>(frame_samples)) 
+    {
+        // Only for states created for a smaller K
+        state.next.resize(STATE_SIZE);
+        state.enhanced.resize(frame_samples);
+    }
+
+    {
+        AllocExemptScope ort_scope("onnxruntime");
+        TraceScope trace("inference", static_cast<uint32_t>(hops));
 
-    return vector<float>(enhanced_data, enhanced_data + enhanced_count);
+        // Create input tensors
+        int64_t frame_shape[2] = {frame_samples, 0};
+        int64_t output_shape[2] = {frame_samples, 0};
+        if (model_frame_rank_ == 2) 
+        {
+            frame_shape[0] = hops;
+            frame_shape[1] = HOP_SIZE;
+        }
+        if (model_output_rank_ == 2) 
+        {
+            output_shape[0] = hops;
+            output_shape[1] = HOP_SIZE;
+        }
+        int64_t state_shape[] = {STATE_SIZE};
+        int64_t atten_shape[] = {1};
+        
+        float atten = atten_lim_db_.load(std::memory_order_relaxed);
+
+        Ort::Value inputs[] = {
+            Ort::Value::CreateTensor<float>(
+                memory_info_, const_cast<float*>(frames), frame_samples, frame_shape, model_frame_rank_),
+            Ort::Value::CreateTensor<float>(
+                memory_info_, state.current.data(), STATE_SIZE, state_shape, 1),
+            Ort::Value::CreateTensor<float>(
+                memory_info_, &atten, 1, atten_shape, 1)
+        };
+
+        // Enhanced audio and the next state go straight into our buffers;
+        // lsnr is unused and left to ORT
+        Ort::Value outputs[] = {
+            Ort::Value::CreateTensor<float>(
+                memory_info_, state.enhanced.data(), frame_samples, output_shape, model_output_rank_),
+            Ort::Value::CreateTensor<float>(
+                memory_info_, state.next.data(), STATE_SIZE, state_shape, 1),
+            Ort::Value(nullptr)
+        };
+
+        // Run inference
+        const char* input_names[] = {"input_frame", "states", "atten_lim_db"};
+        const char* output_names[] = {"enhanced_audio_frame", "new_states", "lsnr"};
+
+        session_.Run(
+            run_options,
+            input_names, inputs, 3,
+            output_names, outputs, 3
+        );
+    }
+
+    std::copy(state.enhanced.begin(), state.enhanced.begin() + frame_samples, out);
+    state.current.swap(state.next);
 }
 
-vector<float> DeepFilterNet::GetTrimmedOutput(const vector<float>& enhanced, int orig_len) 
+vector<float> DeepFilterNet::GetEnhancedFrame(const vector<float>& frame) 
 {
-    int d = FFT_SIZE - HOP_SIZE;
-    int start = d;
-    int end = std::min(orig_len + d, (int)enhanced.size());
-    
-    if (start < 0 || start >= end || end > (int)enhanced.size()) 
-    {
-        cerr << "Warning: Invalid trim range\n";
-        return enhanced;
-    }
-    
-    return vector<float>(enhanced.begin() + start, enhanced.begin() + end);
+    vector<float> enhanced(HOP_SIZE);
+    ProcessRealtimeFrame(frame.data(), enhanced.data());
+    return enhanced;
 }
 
 // verify model input and output details
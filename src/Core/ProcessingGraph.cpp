@@ -0,0 +1,249 @@
+#include "Core/ProcessingGraph.h"
+#include "Core/AudioStages.h"
+#include "Utils/Tracer.h"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+
+using std::cout;
+using std::string;
+using std::vector;
+
+// ============================================================================
+// ProcessingGraph
+// ============================================================================
+
+ProcessingGraph::ProcessingGraph()
+    : sample_rate_(48000),
+      max_block_(0) {
+}
+
+ProcessingGraph::~ProcessingGraph() = default;
+
+void ProcessingGraph::addStage(std::unique_ptr<AudioStage> stage) {
+    auto slot = std::make_unique<Slot>();
+    slot->stage = std::move(stage);
+    if (max_block_ > 0) {
+        slot->stage->prepare(sample_rate_, max_block_);
+    }
+    stages_.push_back(std::move(slot));
+}
+
+void ProcessingGraph::clear() {
+    stages_.clear();
+}
+
+void ProcessingGraph::prepare(unsigned int sample_rate, size_t max_block) {
+    size_t block = blockSize();
+    sample_rate_ = sample_rate;
+    max_block_ = std::max(block, max_block - max_block % block);
+    for (auto& slot : stages_) {
+        slot->stage->prepare(sample_rate, max_block_);
+    }
+}
+
+void ProcessingGraph::reset() {
+    for (auto& slot : stages_) {
+        slot->stage->reset();
+        slot->calls = 0;
+        slot->total_ns = 0;
+        slot->max_ns = 0;
+    }
+}
+
+void ProcessingGraph::process(float* samples, size_t count) {
+    for (auto& slot : stages_) {
+        if (!slot->enabled.load(std::memory_order_relaxed)) continue;
+
+        uint64_t t0 = Tracer::nowNs();
+        slot->stage->process(samples, count);
+        uint64_t t1 = Tracer::nowNs();
+        uint64_t ns = t1 - t0;
+        if (Tracer::instance().enabled()) {
+            Tracer::instance().record(slot->stage->name(), t0, t1, static_cast<uint32_t>(count));
+        }
+
+        slot->calls.fetch_add(1, std::memory_order_relaxed);
+        slot->total_ns.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > slot->max_ns.load(std::memory_order_relaxed)) {
+            slot->max_ns.store(ns, std::memory_order_relaxed);
+        }
+    }
+}
+
+void ProcessingGraph::processOffline(vector<float>& audio) {
+    if (audio.empty() || max_block_ == 0) return;
+
+    size_t n = audio.size();
+    audio.resize(offlineSize(n), 0.0f);
+    processOffline(std::span<float>(audio), n);
+    audio.resize(n);
+}
+
+// The signal plus the graph's delay, rounded up to whole blocks
+size_t ProcessingGraph::offlineSize(size_t count) const {
+    if (max_block_ == 0) return count;
+    size_t padded = count + latency();
+    return padded + (max_block_ - padded % max_block_) % max_block_;
+}
+
+void ProcessingGraph::processOffline(std::span<float> storage, size_t count) {
+    if (count == 0 || max_block_ == 0) return;
+
+    size_t delay = latency();
+    size_t padded = offlineSize(count);
+    if (storage.size() < padded) {
+        throw std::invalid_argument("processOffline needs " + std::to_string(padded) + " samples of storage");
+    }
+
+    // Flush the graph's delay with silence
+    std::fill(storage.begin() + count, storage.begin() + padded, 0.0f);
+    for (size_t i = 0; i < padded; i += max_block_) {
+        process(storage.data() + i, max_block_);
+    }
+
+    // Drop the leading delay in place
+    if (delay > 0) {
+        std::move(storage.begin() + delay, storage.begin() + delay + count, storage.begin());
+    }
+}
+
+bool ProcessingGraph::setStageEnabled(const string& name, bool enabled) {
+    bool found = false;
+    for (auto& slot : stages_) {
+        if (name == slot->stage->name()) {
+            slot->enabled.store(enabled, std::memory_order_relaxed);
+            found = true;
+        }
+    }
+    return found;
+}
+
+size_t ProcessingGraph::latency() const {
+    size_t total = 0;
+    for (const auto& slot : stages_) {
+        if (slot->enabled.load(std::memory_order_relaxed)) {
+            total += slot->stage->latency();
+        }
+    }
+    return total;
+}
+
+size_t ProcessingGraph::blockSize() const {
+    size_t block = 1;
+    for (const auto& slot : stages_) {
+        block = std::lcm(block, slot->stage->blockSize());
+    }
+    return block;
+}
+
+vector<StageTiming> ProcessingGraph::timings() const {
+    vector<StageTiming> result;
+    for (const auto& slot : stages_) {
+        StageTiming t;
+        t.name = slot->stage->name();
+        t.calls = slot->calls.load(std::memory_order_relaxed);
+        t.mean_us = t.calls ? slot->total_ns.load(std::memory_order_relaxed) / 1000.0 / t.calls : 0.0;
+        t.max_us = slot->max_ns.load(std::memory_order_relaxed) / 1000.0;
+        result.push_back(t);
+    }
+    return result;
+}
+
+void ProcessingGraph::printTimings() const {
+    cout << "\nStage timings:\n";
+    for (const auto& t : timings()) {
+        cout << "  " << t.name << ": " << t.calls << " calls, mean "
+             << t.mean_us << " us, max " << t.max_us << " us\n";
+    }
+    for (const auto& slot : stages_) {
+        if (auto* meter = dynamic_cast<const LoudnessMeterStage*>(slot->stage.get())) {
+            cout << "  Loudness: " << meter->integratedLufs() << " LUFS integrated\n";
+        }
+    }
+}
+
+// ============================================================================
+// StageRegistry
+// ============================================================================
+
+StageRegistry& StageRegistry::instance() {
+    static StageRegistry registry;
+    return registry;
+}
+
+void StageRegistry::add(const string& name, StageFactory factory) {
+    factories_[name] = std::move(factory);
+}
+
+std::unique_ptr<AudioStage> StageRegistry::create(const string& name, const string& param) const {
+    auto it = factories_.find(name);
+    if (it == factories_.end()) return nullptr;
+    return it->second(param);
+}
+
+vector<string> StageRegistry::names() const {
+    vector<string> result;
+    for (const auto& [name, factory] : factories_) {
+        result.push_back(name);
+    }
+    return result;
+}
+
+void buildGraph(const string& spec, ProcessingGraph& graph, std::unique_ptr<AudioStage> denoise_stage) {
+    graph.clear();
+
+    // First pass: split the spec
+    vector<std::pair<string, string>> items;
+    std::stringstream in(spec);
+    for (string item; std::getline(in, item, ',');) {
+        if (item.empty()) continue;
+        size_t colon = item.find(':');
+        items.emplace_back(item.substr(0, colon), colon == string::npos ? "" : item.substr(colon + 1));
+    }
+
+    // A dry/wet mix needs the dry signal from before the model
+    auto mix = std::find_if(items.begin(), items.end(), [](const auto& i) { return i.first == "mix"; });
+    bool has_mix = mix != items.end();
+    float wet = 1.0f;
+    if (has_mix) {
+        wet = mix->second.empty() ? 0.8f : std::stof(mix->second);
+        items.erase(mix);
+    }
+
+    DryTapStage* tap = nullptr;
+    size_t tap_latency = 0;
+    size_t latency = 0;
+
+    for (const auto& [name, param] : items) {
+        std::unique_ptr<AudioStage> stage;
+
+        if (name == "denoise") {
+            if (!denoise_stage) throw std::invalid_argument("denoise listed twice or unavailable");
+            if (has_mix) {
+                auto dry = std::make_unique<DryTapStage>();
+                tap = dry.get();
+                tap_latency = latency;
+                graph.addStage(std::move(dry));
+            }
+            stage = std::move(denoise_stage);
+        } else {
+            stage = StageRegistry::instance().create(name, param);
+            if (!stage) throw std::invalid_argument("unknown stage '" + name + "'");
+        }
+
+        latency += stage->latency();
+        graph.addStage(std::move(stage));
+
+        if (tap && name == "denoise") {
+            graph.addStage(std::make_unique<DryWetStage>(*tap, wet, latency - tap_latency));
+        }
+    }
+
+    if (denoise_stage) {
+        // The model must run even if the spec forgot it
+        throw std::invalid_argument("graph spec must contain 'denoise'");
+    }
+}
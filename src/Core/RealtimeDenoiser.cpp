@@ -1,19 +1,82 @@
 #include "Core/RealtimeDenoiser.h"
 #include "Core/OnnxInference.h"
+#include "Core/ControlServer.h"
+#include "Core/AudioStages.h"
 #include "Utils/MicReader.h"
+#include "Utils/AllocTracker.h"
+#include "Utils/Tracer.h"
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
 #include <cmath>
+#include <chrono>
 
 using std::cout;
 using std::cerr;
 using std::string;
 using std::vector;
 
+static const int SWAP_WARMUP_FRAMES = 50;     // 500 ms of silence through the new model
+static const int SWAP_CROSSFADE_FRAMES = 4;   // 40 ms equal-gain crossfade
+
+// Auto engine selection
+static const float HOP_BUDGET_NS = 1e9f * DeepFilterNet::HOP_SIZE / DeepFilterNet::SAMPLE_RATE;
+static const float AUTO_LOAD_SMOOTHING = 0.02f;  // ~0.5 s time constant
+static const float AUTO_FALLBACK_LOAD = 0.8f;    // model time over the hop budget
+static const int AUTO_RETRY_HOPS = 3000;         // 30 s on the gate before retrying the model
+
+// The graph's "denoise" stage in realtime mode: whichever model is live,
+// including a hot swap in progress
+class LiveModelStage : public AudioStage {
+public:
+    using Process = std::function<void(float*, size_t)>;
+
+    LiveModelStage(const std::unique_ptr<DeepFilterNet>& model, Process process)
+        : model_(model), process_(std::move(process)) {}
+    const char* name() const override { return "denoise"; }
+    void process(float* samples, size_t count) override { process_(samples, count); }
+    size_t blockSize() const override { return DeepFilterNet::HOP_SIZE; }
+
+    size_t latency() const override {
+        return model_ ? model_->StreamLatency() : DeepFilterNet::FFT_SIZE - DeepFilterNet::HOP_SIZE;
+    }
+
+private:
+    const std::unique_ptr<DeepFilterNet>& model_;
+    Process process_;
+};
+
 RealtimeDenoiser::RealtimeDenoiser()
     : denoiser_(nullptr),
+      live_hops_per_run_(0),
+      live_model_bytes_(0),
+      live_arena_bytes_(0),
+      live_state_bytes_(0),
       mic_reader_(nullptr),
+      control_server_(nullptr),
+      swap_in_progress_(false),
+      swap_abort_(false),
+      pending_model_(nullptr),
+      retired_model_(nullptr),
+      incoming_model_(nullptr),
+      crossfade_frame_(0),
+      swap_frame_(DeepFilterNet::HOP_SIZE, 0.0f),
+      bypass_delay_(DeepFilterNet::FFT_SIZE - DeepFilterNet::HOP_SIZE, 0.0f),
+      bypass_pos_(0),
+      gate_frame_(DeepFilterNet::HOP_SIZE, 0.0f),
+      engine_mode_(static_cast<int>(EngineMode::Model)),
+      fallback_active_(false),
+      auto_fallbacks_(0),
+      gate_mix_(0.0f),
+      model_load_(0.0f),
+      on_fallback_(false),
+      model_skipped_(false),
+      fallback_hops_(0),
+      created_at_(std::chrono::steady_clock::now()),
+      first_audio_ns_(0),
+      model_live_ns_(0),
+      graph_spec_("denoise"),
+      float_frame_(DeepFilterNet::HOP_SIZE, 0.0f),
       initialized_(false),
       running_(false),
       monitoring_enabled_(false) {
@@ -23,10 +86,20 @@ RealtimeDenoiser::~RealtimeDenoiser() {
     stop();
 }
 
-bool RealtimeDenoiser::loadModel(const string& model_path) {
+bool RealtimeDenoiser::loadModel(const string& model_path, int hops_per_run) {
     try {
         cout << "Loading DeepFilterNet model...\n";
-        denoiser_ = std::make_unique<DeepFilterNet>(model_path);
+        auto t0 = std::chrono::steady_clock::now();
+        denoiser_ = std::make_unique<DeepFilterNet>(model_path, hops_per_run, memory_profile_);
+        if (pipeline_config_.enabled()) {
+            denoiser_->EnablePipeline(pipeline_config_);
+        }
+        if (!warm_state_path_.empty()) {
+            denoiser_->LoadWarmState(warm_state_path_);
+            denoiser_->reset();
+        }
+        publishLiveModel();
+        recordStartupPhase("model load", t0);
         cout << "Model loaded successfully\n";
         return true;
     } catch (const std::exception& e) {
@@ -35,31 +108,162 @@ bool RealtimeDenoiser::loadModel(const string& model_path) {
     }
 }
 
+bool RealtimeDenoiser::loadModelAsync(const string& model_path, int hops_per_run) {
+    if (modelLoaded()) {
+        return swapModel(model_path);
+    }
+    
+    bool expected = false;
+    if (!swap_in_progress_.compare_exchange_strong(expected, true)) {
+        cerr << "Model load already in progress\n";
+        return false;
+    }
+    
+    if (swap_thread_.joinable()) {
+        swap_thread_.join();
+    }
+    swap_abort_ = false;
+    swap_thread_ = std::thread(&RealtimeDenoiser::runModelSwap, this, model_path, hops_per_run);
+    return true;
+}
+
+bool RealtimeDenoiser::swapModel(const string& model_path) {
+    if (!running_ && !swap_in_progress_) {
+        // Nothing is streaming, so there is no gap to avoid
+        return loadModel(model_path, live_hops_per_run_.load(std::memory_order_acquire));
+    }
+    
+    bool expected = false;
+    if (!swap_in_progress_.compare_exchange_strong(expected, true)) {
+        cerr << "Model swap already in progress\n";
+        return false;
+    }
+    
+    if (swap_thread_.joinable()) {
+        swap_thread_.join();
+    }
+    swap_abort_ = false;
+    // Same K as the live model, so both stay aligned during the crossfade
+    swap_thread_ = std::thread(&RealtimeDenoiser::runModelSwap, this, model_path,
+                               live_hops_per_run_.load(std::memory_order_acquire));
+    return true;
+}
+
+void RealtimeDenoiser::runModelSwap(string model_path, int hops_per_run) {
+    auto t0 = std::chrono::steady_clock::now();
+    // Only the audio thread replaces denoiser_, and only once this hands over
+    const bool replacing = modelLoaded();
+    
+    std::unique_ptr<DeepFilterNet> next;
+    try {
+        cout << (replacing ? "Loading replacement model: " : "Loading model in the background: ") << model_path << "\n";
+        next = std::make_unique<DeepFilterNet>(model_path, hops_per_run, memory_profile_);
+        if (pipeline_config_.enabled()) {
+            next->EnablePipeline(pipeline_config_);
+        }
+        if (!replacing) recordStartupPhase("model load", t0);
+        
+        // First runs allocate and fault in the arena; keep that off the audio thread
+        auto warmup_t0 = std::chrono::steady_clock::now();
+        vector<float> silence(DeepFilterNet::HOP_SIZE, 0.0f);
+        for (int i = 0; i < SWAP_WARMUP_FRAMES; ++i) {
+            next->ProcessRealtimeFrame(silence);
+        }
+        if (!warm_state_path_.empty()) {
+            next->LoadWarmState(warm_state_path_);
+            next->reset();
+        }
+        if (!replacing) recordStartupPhase("model warm-up", warmup_t0);
+    } catch (const std::exception& e) {
+        cerr << (replacing ? "Model swap failed: " : "Model load failed, audio stays in bypass: ") << e.what() << "\n";
+        swap_in_progress_ = false;
+        return;
+    }
+    
+    auto load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    
+    // Hand over; the audio thread picks it up at the next frame boundary
+    pending_model_.store(next.release(), std::memory_order_release);
+    
+    if (!replacing) {
+        // Nothing to retire; wait for the crossfade out of bypass to finish
+        while (!swap_abort_ && model_live_ns_.load(std::memory_order_acquire) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (!swap_abort_) {
+            cout << "✓ Model live after bypass (load+warmup " << load_ms << " ms)\n";
+            printStartupReport();
+        }
+        swap_in_progress_ = false;
+        return;
+    }
+    
+    // Wait for the old model to come back, then destroy it here
+    DeepFilterNet* retired = nullptr;
+    while (!swap_abort_ && !(retired = retired_model_.exchange(nullptr, std::memory_order_acquire))) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    delete retired;
+    
+    if (retired) {
+        auto total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        cout << "✓ Model swapped (load+warmup " << load_ms << " ms, total " << total_ms << " ms)\n";
+    }
+    swap_in_progress_ = false;
+}
+
+void RealtimeDenoiser::finishModelSwap() {
+    // Called from stop(), after the audio thread is gone
+    swap_abort_ = true;
+    if (swap_thread_.joinable()) {
+        swap_thread_.join();
+    }
+    
+    delete pending_model_.exchange(nullptr);
+    delete retired_model_.exchange(nullptr);
+    if (incoming_model_) {
+        // Stopped mid-crossfade: the new model wins
+        denoiser_.reset(incoming_model_);
+        incoming_model_ = nullptr;
+        publishLiveModel();
+    }
+    crossfade_frame_ = 0;
+}
+
 void RealtimeDenoiser::setNoiseSuppressionStrength(float strength) {
-    if (!denoiser_) {
+    if (!modelLoaded() && !swap_in_progress_) {
         cerr << "Model not loaded\n";
         return;
     }
     
    // Try much gentler suppression first
     float clamped = std::clamp(strength, -30.0f, 0.0f);  // Changed from -100
-    denoiser_->SetNoiseSuppressionStrength(clamped);
+    control_.setAttenuation(clamped);
     cout << "Noise suppression strength: " << clamped << " dB\n";
 }
 
-vector<string> RealtimeDenoiser::listMicrophones() {
+// Creating the reader connects to the sound backend
+void RealtimeDenoiser::ensureMicReader() {
     if (!mic_reader_) {
+        auto t0 = std::chrono::steady_clock::now();
         mic_reader_ = std::make_unique<MicrophoneReader>();
+        recordStartupPhase("backend connect", t0);
     }
+}
+
+vector<string> RealtimeDenoiser::listMicrophones() {
+    ensureMicReader();
+    auto t0 = std::chrono::steady_clock::now();
     available_mics_ = mic_reader_->listDevices();
+    recordStartupPhase("input enumeration", t0);
     return available_mics_;
 }
 
 vector<string> RealtimeDenoiser::listSpeakers() {
-    if (!mic_reader_) {
-        mic_reader_ = std::make_unique<MicrophoneReader>();
-    }
+    ensureMicReader();
+    auto t0 = std::chrono::steady_clock::now();
     available_speakers_ = mic_reader_->listPlaybackDevices();
+    recordStartupPhase("output enumeration", t0);
     return available_speakers_;
 }
 
@@ -69,11 +273,7 @@ bool RealtimeDenoiser::selectMicrophone(int index) {
         return false;
     }
     
-    if (!mic_reader_) {
-        mic_reader_ = std::make_unique<MicrophoneReader>();
-    }
-
-    
+    ensureMicReader();
     return mic_reader_->selectDevice(available_mics_[index]);
 }
 
@@ -83,32 +283,231 @@ bool RealtimeDenoiser::selectSpeaker(int index) {
         return false;
     }
     
-    if (!mic_reader_) {
-        mic_reader_ = std::make_unique<MicrophoneReader>();
-    }
-    
+    ensureMicReader();
     return mic_reader_->selectPlaybackDevice(available_speakers_[index]);
 }
 
 void RealtimeDenoiser::enableMonitoring(bool enable) {
     monitoring_enabled_ = enable;
+    control_.setMonitorEnabled(enable);
     if (mic_reader_) {
         mic_reader_->setMonitorEnabled(enable);
     }
     cout << "Monitoring: " << (enable ? "ENABLED" : "DISABLED") << "\n";
 }
 
-vector<float> RealtimeDenoiser::convertToFloat(const vector<int16_t>& samples) {
-    vector<float> result(samples.size());
-    for (size_t i = 0; i < samples.size(); ++i) {
-        result[i] = static_cast<float>(samples[i]) / 32768.0f;
+bool RealtimeDenoiser::enableSharedOutput(const string& shm_name) {
+    if (!mic_reader_) {
+        mic_reader_ = std::make_unique<MicrophoneReader>();
+    }
+    return mic_reader_->setSharedOutput(shm_name);
+}
+
+bool RealtimeDenoiser::setGraph(const string& spec) {
+    try {
+        buildGraph(spec, graph_, std::make_unique<LiveModelStage>(denoiser_, [this](float* samples, size_t count) {
+            denoiseFrames(samples, count);
+        }));
+    } catch (const std::exception& e) {
+        cerr << "Invalid graph '" << spec << "': " << e.what() << "\n";
+        graph_.clear();
+        return false;
+    }
+    graph_spec_ = spec;
+    cout << "Processing graph: " << spec << "\n";
+    return true;
+}
+
+bool RealtimeDenoiser::enableControlSocket(const string& socket_path) {
+    auto server = std::make_unique<ControlServer>();
+    
+    server->addCommand("set", "set atten|gate|gain <dB> | set monitor on|off",
+        [this](const vector<string>& args) -> string {
+            if (args.size() != 2) throw std::invalid_argument("expected 2 arguments");
+            const string& name = args[0];
+            const string& value = args[1];
+            
+            if (name == "monitor") {
+                bool on = (value == "on" || value == "1");
+                control_.setMonitorEnabled(on);
+                if (on && !(mic_reader_ && mic_reader_->hasPlayback())) {
+                    return "ok monitor on (no playback stream open; select a speaker at startup)";
+                }
+                return string("ok monitor ") + (on ? "on" : "off");
+            }
+            
+            float db = std::stof(value);
+            if (name == "atten") control_.setAttenuation(db);
+            else if (name == "gate") control_.setGateThreshold(db);
+            else if (name == "gain") control_.setOutputGain(db);
+            else throw std::invalid_argument("unknown parameter '" + name + "'");
+            return "ok " + name + " " + value;
+        });
+    
+    server->addCommand("swap", "swap <model.onnx>",
+        [this](const vector<string>& args) -> string {
+            if (args.size() != 1) throw std::invalid_argument("expected a model path");
+            if (!swapModel(args[0])) return "error swap already in progress";
+            return "ok swapping to " + args[0];
+        });
+    
+    server->addCommand("xruns", "xruns",
+        [this](const vector<string>&) -> string {
+            if (!mic_reader_) return "error audio not initialized";
+            XrunStats x = mic_reader_->getXrunStats();
+            return "ok overflows " + std::to_string(x.input_overflows) +
+                   " underflows " + std::to_string(x.output_underflows) +
+                   " ring_overruns " + std::to_string(x.ring_overruns) +
+                   " ring_underruns " + std::to_string(x.ring_underruns) +
+                   " realigns " + std::to_string(x.realigns) +
+                   " concealed " + std::to_string(x.concealed_samples) +
+                   " dropped " + std::to_string(x.dropped_samples);
+        });
+    
+    server->addCommand("latency", "latency",
+        [this](const vector<string>&) -> string {
+            if (!mic_reader_) return "error audio not initialized";
+            LatencyReport r = mic_reader_->getLatencyReport();
+            return "ok total_ms " + std::to_string(r.total()) +
+                   " input " + std::to_string(r.input_device_ms) +
+                   " framing " + std::to_string(r.framing_ms) +
+                   " model " + std::to_string(r.algorithmic_ms) +
+                   " processing " + std::to_string(r.processing_ms) +
+                   " ring " + std::to_string(r.ring_ms) +
+                   " output " + std::to_string(r.output_device_ms);
+        });
+    
+    server->addCommand("stage", "stage <name> on|off",
+        [this](const vector<string>& args) -> string {
+            if (args.size() != 2) throw std::invalid_argument("expected 2 arguments");
+            if (args[0] == "denoise") throw std::invalid_argument("the model stage cannot be bypassed");
+            bool on = (args[1] == "on" || args[1] == "1");
+            if (!graph_.setStageEnabled(args[0], on)) return "error no stage '" + args[0] + "'";
+            return "ok " + args[0] + (on ? " on" : " off");
+        });
+    
+    server->addCommand("memory", "memory",
+        [this](const vector<string>&) -> string {
+            return "ok " + memoryReport().summary();
+        });
+    
+    server->addCommand("trace", "trace on|off | trace dump <path> [seconds]",
+        [](const vector<string>& args) -> string {
+            if (args.empty()) throw std::invalid_argument("expected arguments");
+            if (args[0] == "on" || args[0] == "off") {
+                Tracer::instance().setEnabled(args[0] == "on");
+                return "ok trace " + args[0];
+            }
+            if (args[0] != "dump" || args.size() < 2) throw std::invalid_argument("expected: trace dump <path> [seconds]");
+            uint64_t window_ms = args.size() > 2 ? static_cast<uint64_t>(std::stod(args[2]) * 1000.0) : 0;
+            if (!Tracer::instance().dump(args[1], window_ms)) return "error trace not written";
+            return "ok " + args[1];
+        });
+    
+    server->addCommand("record", "record start <prefix> | record stop | record",
+        [this](const vector<string>& args) -> string {
+            if (args.empty()) {
+                if (!recorder_.isRecording()) return "ok not recording";
+                RecorderTrackStats raw = recorder_.stats(SessionRecorder::Raw);
+                RecorderTrackStats out = recorder_.stats(SessionRecorder::Denoised);
+                return "ok raw_samples " + std::to_string(raw.samples_written) +
+                       " raw_high_water " + std::to_string(raw.high_water) +
+                       " raw_dropped " + std::to_string(raw.dropped) +
+                       " denoised_samples " + std::to_string(out.samples_written) +
+                       " denoised_high_water " + std::to_string(out.high_water) +
+                       " denoised_dropped " + std::to_string(out.dropped) +
+                       " capacity " + std::to_string(raw.capacity);
+            }
+            if (args[0] == "stop") {
+                stopRecording();
+                return "ok record stopped";
+            }
+            if (args[0] != "start" || args.size() != 2) throw std::invalid_argument("expected: record start <prefix>");
+            if (!startRecording(args[1])) return "error recording not started";
+            return "ok recording " + args[1];
+        });
+    
+    server->addCommand("engine", "engine [dfn|gate|auto]",
+        [this](const vector<string>& args) -> string {
+            if (!args.empty() && !setEngineMode(args[0])) throw std::invalid_argument("expected dfn, gate or auto");
+            return "ok " + engineStatus();
+        });
+    
+    server->addCommand("get", "get",
+        [this](const vector<string>&) {
+            RuntimeParams p = control_.snapshot();
+            return "ok atten " + std::to_string(p.atten_lim_db) +
+                   " monitor " + (p.monitor_enabled ? "on" : "off") +
+                   " gate " + std::to_string(p.gate_threshold_db) +
+                   " gain " + std::to_string(p.output_gain_db);
+        });
+    
+    if (!server->start(socket_path)) {
+        return false;
+    }
+    control_server_ = std::move(server);
+    return true;
+}
+
+bool RealtimeDenoiser::setEngineMode(const string& mode) {
+    EngineMode value;
+    if (mode == "dfn") value = EngineMode::Model;
+    else if (mode == "gate") value = EngineMode::Gate;
+    else if (mode == "auto") value = EngineMode::Auto;
+    else {
+        cerr << "Unknown engine: " << mode << " (dfn, gate or auto)\n";
+        return false;
+    }
+    engine_mode_.store(static_cast<int>(value), std::memory_order_relaxed);
+    return true;
+}
+
+string RealtimeDenoiser::engineStatus() const {
+    static const char* names[] = {"dfn", "gate", "auto"};
+    EngineMode mode = static_cast<EngineMode>(engine_mode_.load(std::memory_order_relaxed));
+    bool gate = mode == EngineMode::Gate || (mode == EngineMode::Auto && fallback_active_.load(std::memory_order_relaxed));
+    return string(names[static_cast<int>(mode)]) + " active " + (gate ? "gate" : "dfn") +
+           " fallbacks " + std::to_string(auto_fallbacks_.load(std::memory_order_relaxed));
+}
+
+bool RealtimeDenoiser::startRecording(const string& path_prefix) {
+    return recorder_.start(path_prefix, DeepFilterNet::SAMPLE_RATE);
+}
+
+void RealtimeDenoiser::stopRecording() {
+    recorder_.stop();
+}
+
+void RealtimeDenoiser::recordStartupPhase(const char* name, std::chrono::steady_clock::time_point start) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(startup_mutex_);
+    startup_phases_.push_back({name,
+                               std::chrono::duration<double, std::milli>(start - created_at_).count(),
+                               std::chrono::duration<double, std::milli>(now - start).count()});
+}
+
+// Offsets are from construction and include time spent at prompts
+void RealtimeDenoiser::printStartupReport() {
+    int64_t created_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(created_at_.time_since_epoch()).count();
+    auto since_created = [created_ns](int64_t ns) { return ns ? (ns - created_ns) / 1e6 : -1.0; };
+    
+    std::lock_guard<std::mutex> lock(startup_mutex_);
+    cout << "\n=== Startup ===\n";
+    for (const StartupPhase& phase : startup_phases_) {
+        cout << "  " << phase.name << ": " << phase.duration_ms << " ms (at +" << phase.start_ms << " ms)\n";
     }
-    return result;
+    cout << "  first audio at +" << since_created(first_audio_ns_.load()) << " ms\n";
+    cout << "  model live at +" << since_created(model_live_ns_.load()) << " ms\n";
 }
 
-vector<int16_t> RealtimeDenoiser::convertToInt16(const vector<float>& samples) {
-    vector<int16_t> result(samples.size());
-    for (size_t i = 0; i < samples.size(); ++i) {
+void RealtimeDenoiser::convertToFloat(const int16_t* samples, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<float>(samples[i]) / 32768.0f;
+    }
+}
+
+void RealtimeDenoiser::convertToInt16(const float* samples, int16_t* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
         float sample = samples[i];
         
         // Handle NaN/inf
@@ -122,61 +521,209 @@ vector<int16_t> RealtimeDenoiser::convertToInt16(const vector<float>& samples) {
             static_cast<int32_t>(-32768),
             static_cast<int32_t>(32767)
         );
-        result[i] = static_cast<int16_t>(clamped);
+        out[i] = static_cast<int16_t>(clamped);
     }
-    return result;
 }
 
-vector<int16_t> RealtimeDenoiser::processAudioFrame(const vector<int16_t>& input) {
-    if (!denoiser_) {
-            return input;
-        }
+void RealtimeDenoiser::processAudioFrame(int16_t* samples, size_t count) {
+    RealtimeScope realtime("RealtimeDenoiser::processAudioFrame");
+    TraceScope trace("processAudioFrame", static_cast<uint32_t>(count));
+    if (first_audio_ns_.load(std::memory_order_relaxed) == 0) {
+        first_audio_ns_.store(Tracer::nowNs(), std::memory_order_relaxed);
+    }
     
     // Ensure we have exactly 480 samples
-    if (input.size() != 480) {
-        std::cerr << "Warning: Expected 480 samples, got " << input.size() << "\n";
-        return input;
+    if (count != float_frame_.size()) {
+        std::cerr << "Warning: Expected 480 samples, got " << count << "\n";
+        return;
     }
     
-    static int frame_count = 0;
-    if (frame_count++ % 100 == 0) {
-        cout << "Processing frame " << frame_count << "\n";
+    // Pick up a hot-swapped model at the frame boundary
+    if (!incoming_model_) {
+        incoming_model_ = pending_model_.exchange(nullptr, std::memory_order_acquire);
+        crossfade_frame_ = 0;
     }
     
-    // Convert to float
-    auto float_samples = convertToFloat(input);
+    // Pick up parameter changes at the frame boundary
+    RuntimeParams params = control_.snapshot();
+    float atten = ramper_.beginFrame(params);
+    if (denoiser_) denoiser_->SetNoiseSuppressionStrength(atten);
+    if (incoming_model_) incoming_model_->SetNoiseSuppressionStrength(atten);
+    fallback_.SetNoiseSuppressionStrength(atten);
+    mic_reader_->setMonitorEnabled(params.monitor_enabled);
+    
+    recorder_.push(SessionRecorder::Raw, samples, count);
+    {
+        TraceScope convert("convert in");
+        convertToFloat(samples, float_frame_.data(), count);
+    }
+    graph_.process(float_frame_.data(), count);
+    {
+        TraceScope convert("convert out");
+        convertToInt16(float_frame_.data(), samples, count);
+    }
+    recorder_.push(SessionRecorder::Denoised, samples, count);
+}
+
+void RealtimeDenoiser::denoiseFrames(float* samples, size_t count) {
+    for (size_t offset = 0; offset < count; offset += DeepFilterNet::HOP_SIZE) {
+        float* frame = samples + offset;
+        
+        EngineMode mode = static_cast<EngineMode>(engine_mode_.load(std::memory_order_relaxed));
+        bool want_gate = (mode == EngineMode::Gate) || (mode == EngineMode::Auto && on_fallback_);
+        float target = want_gate ? 1.0f : 0.0f;
+        
+        // In auto mode the gate always runs, so it takes over with a
+        // settled noise estimate; it costs well under 1% of the hop
+        bool run_gate = mode != EngineMode::Model || gate_mix_ > 0.0f || want_gate;
+        bool run_model = gate_mix_ < 1.0f || !want_gate;
+        if (run_gate) {
+            fallback_.ProcessRealtimeFrame(frame, gate_frame_.data());
+        }
+        
+        if (run_model) {
+            if (model_skipped_ && denoiser_) {
+                // Resuming after the gate had the stream alone; old state is stale
+                denoiser_->reset();
+            }
+            model_skipped_ = false;
+            
+            uint64_t t0 = Tracer::nowNs();
+            runModelHop(frame);
+            float load = static_cast<float>(Tracer::nowNs() - t0) / HOP_BUDGET_NS;
+            model_load_ += AUTO_LOAD_SMOOTHING * (load - model_load_);
+        } else {
+            model_skipped_ = true;
+            // Nothing of the model is audible, so a loaded model waiting to
+            // go live takes over now instead of stalling until the model runs
+            if (incoming_model_) {
+                completeModelHandover();
+            }
+        }
+        
+        if (gate_mix_ != target || target > 0.0f) {
+            float step = 1.0f / (SWAP_CROSSFADE_FRAMES * static_cast<float>(DeepFilterNet::HOP_SIZE));
+            for (int i = 0; i < DeepFilterNet::HOP_SIZE; ++i) {
+                gate_mix_ = target > gate_mix_ ? std::min(gate_mix_ + step, target) : std::max(gate_mix_ - step, target);
+                frame[i] = run_model ? (1.0f - gate_mix_) * frame[i] + gate_mix_ * gate_frame_[i] : gate_frame_[i];
+            }
+        }
+        
+        if (mode == EngineMode::Auto) {
+            updateAutoFallback(run_model);
+        }
+        
+        ramper_.process(frame, DeepFilterNet::HOP_SIZE);
+    }
+}
+
+// Auto mode: hand the stream to the gate while the model's smoothed cost
+// stays over budget, and give the model another try every half minute
+void RealtimeDenoiser::updateAutoFallback(bool model_ran) {
+    if (!on_fallback_) {
+        if (model_ran && denoiser_ && model_load_ > AUTO_FALLBACK_LOAD) {
+            on_fallback_ = true;
+            fallback_hops_ = 0;
+            auto_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+            Tracer::instance().instant("engine fallback");
+        }
+    } else if (++fallback_hops_ >= AUTO_RETRY_HOPS) {
+        on_fallback_ = false;
+        model_load_ = 0.0f;
+    }
+    fallback_active_.store(on_fallback_, std::memory_order_relaxed);
+}
+
+void RealtimeDenoiser::runModelHop(float* frame) {
+    if (incoming_model_) {
+        // Both models see the same input while the output crossfades
+        incoming_model_->ProcessRealtimeFrame(frame, swap_frame_.data());
+    }
     
-    // Use streaming API instead of batch processing
-    auto denoised = denoiser_->ProcessRealtimeFrame(float_samples);
+    if (denoiser_) {
+        denoiser_->ProcessRealtimeFrame(frame, frame);
+    } else {
+        // Still loading: dry signal, delayed as the model would delay it
+        for (int i = 0; i < DeepFilterNet::HOP_SIZE; ++i) {
+            std::swap(frame[i], bypass_delay_[bypass_pos_]);
+            bypass_pos_ = (bypass_pos_ + 1) % bypass_delay_.size();
+        }
+    }
     
-    // Convert back to int16
-    return convertToInt16(denoised);
+    if (incoming_model_) {
+        float w0 = static_cast<float>(crossfade_frame_) / SWAP_CROSSFADE_FRAMES;
+        float step = 1.0f / (SWAP_CROSSFADE_FRAMES * static_cast<float>(DeepFilterNet::HOP_SIZE));
+        for (int i = 0; i < DeepFilterNet::HOP_SIZE; ++i) {
+            float w = w0 + step * static_cast<float>(i + 1);
+            frame[i] = (1.0f - w) * frame[i] + w * swap_frame_[i];
+        }
+        
+        if (++crossfade_frame_ == SWAP_CROSSFADE_FRAMES) {
+            completeModelHandover();
+        }
+    }
+}
+
+// Audio thread: incoming_model_ becomes the live model
+void RealtimeDenoiser::completeModelHandover() {
+    // Old model goes back to the loader thread for destruction
+    if (denoiser_) {
+        retired_model_.store(denoiser_.release(), std::memory_order_release);
+    } else {
+        model_live_ns_.store(Tracer::nowNs(), std::memory_order_release);
+    }
+    denoiser_.reset(incoming_model_);
+    incoming_model_ = nullptr;
+    crossfade_frame_ = 0;
+    publishLiveModel();
+}
+
+// Whichever thread just replaced denoiser_: what other threads may read
+// about it, since they can't safely touch the model itself
+void RealtimeDenoiser::publishLiveModel() {
+    ModelMemoryUsage usage = denoiser_->GetMemoryUsage();
+    live_model_bytes_.store(usage.model_bytes, std::memory_order_relaxed);
+    live_arena_bytes_.store(usage.arena_bytes, std::memory_order_relaxed);
+    live_state_bytes_.store(usage.state_bytes, std::memory_order_relaxed);
+    live_hops_per_run_.store(denoiser_->HopsPerRun(), std::memory_order_release);
 }
 
 bool RealtimeDenoiser::initialize() {
-    if (!denoiser_) {
+    if (!modelLoaded() && !swap_in_progress_) {
         std::cerr << "✗ Model not loaded\n";
         return false;
     }
     
-    if (!mic_reader_) {
-        mic_reader_ = std::make_unique<MicrophoneReader>();
+    ensureMicReader();
+    
+    if (graph_.stageCount() == 0 && !setGraph(graph_spec_)) {
+        return false;
     }
+    graph_.prepare(DeepFilterNet::SAMPLE_RATE, DeepFilterNet::HOP_SIZE);
+    graph_.reset();
     
     // Set callback to actually use the denoiser
-    mic_reader_->setAudioCallback([this](const vector<int16_t>& input) {
-        return this->processAudioFrame(input);
+    mic_reader_->setAudioCallback([this](int16_t* samples, size_t count) {
+        this->processAudioFrame(samples, count);
     });
     
     mic_reader_->setMonitorEnabled(monitoring_enabled_);
+    mic_reader_->setProcessingDelay(graph_.latency());
+    control_.setMonitorEnabled(monitoring_enabled_);
+    ramper_.reset(control_.snapshot());
+    std::fill(bypass_delay_.begin(), bypass_delay_.end(), 0.0f);
+    bypass_pos_ = 0;
     
+    auto open_t0 = std::chrono::steady_clock::now();
     if (!mic_reader_->initialize()) {
         std::cerr << "Failed to initialize microphone reader\n";
         return false;
     }
+    recordStartupPhase("stream open", open_t0);
     
     initialized_ = true;
     cout << "Real-time denoiser initialized\n";
+    memoryReport().print("Memory");
     return true;
 }
 
@@ -206,13 +753,47 @@ void RealtimeDenoiser::stop() {
         cout << "\n=== STOPPING ===\n";
     }
     
+    if (control_server_) {
+        control_server_->stop();
+        control_server_.reset();
+    }
+    
     if (mic_reader_) {
         mic_reader_->cleanup();
     }
     
+    finishModelSwap();
+    recorder_.stop();
+    
+    if (initialized_) {
+        cout << "Engine: " << engineStatus() << "\n";
+        graph_.printTimings();
+        if (denoiser_ && denoiser_->Pipeline()) {
+            denoiser_->Pipeline()->printStats();
+        }
+        if (AllocTracker::enabled()) {
+            AllocTracker::printReport();
+        }
+    }
     initialized_ = false;
 }
 
+MemoryReport RealtimeDenoiser::memoryReport() const {
+    MemoryReport report;
+    if (modelLoaded()) {
+        report.add("model", live_model_bytes_.load(std::memory_order_relaxed), true);
+        report.add("arena", live_arena_bytes_.load(std::memory_order_relaxed), true);
+        report.add("stream state", live_state_bytes_.load(std::memory_order_relaxed));
+    }
+    
+    size_t buffers = (float_frame_.capacity() + swap_frame_.capacity()) * sizeof(float);
+    if (mic_reader_) {
+        buffers += mic_reader_->bufferBytes();
+    }
+    report.add("audio buffers", buffers);
+    return report;
+}
+
 bool RealtimeDenoiser::isRunning() const {
     return running_;
 }
\ No newline at end of file
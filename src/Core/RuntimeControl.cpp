@@ -0,0 +1,104 @@
+#include "Core/RuntimeControl.h"
+#include <algorithm>
+#include <cmath>
+
+static const float ATTEN_STEP_DB = 3.0f;       // per frame, ~300 dB/s
+static const float GATE_CLOSE_STEP = 0.2f;     // per frame, closes in 50 ms
+static const int GATE_HOLD_FRAMES = 10;        // 100 ms hold after speech
+static const float GATE_OFF_DB = -100.0f;
+
+static float dbToLinear(float db) {
+    return std::pow(10.0f, db / 20.0f);
+}
+
+// ============================================================================
+// RuntimeControl
+// ============================================================================
+
+void RuntimeControl::setAttenuation(float db) {
+    atten_lim_db_.store(std::clamp(db, -100.0f, 0.0f), std::memory_order_relaxed);
+}
+
+void RuntimeControl::setMonitorEnabled(bool enabled) {
+    monitor_enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void RuntimeControl::setGateThreshold(float db) {
+    gate_threshold_db_.store(std::clamp(db, GATE_OFF_DB, 0.0f), std::memory_order_relaxed);
+}
+
+void RuntimeControl::setOutputGain(float db) {
+    output_gain_db_.store(std::clamp(db, -60.0f, 24.0f), std::memory_order_relaxed);
+}
+
+RuntimeParams RuntimeControl::snapshot() const {
+    RuntimeParams params;
+    params.atten_lim_db = atten_lim_db_.load(std::memory_order_relaxed);
+    params.monitor_enabled = monitor_enabled_.load(std::memory_order_relaxed);
+    params.gate_threshold_db = gate_threshold_db_.load(std::memory_order_relaxed);
+    params.output_gain_db = output_gain_db_.load(std::memory_order_relaxed);
+    return params;
+}
+
+// ============================================================================
+// ParamRamper
+// ============================================================================
+
+ParamRamper::ParamRamper()
+    : atten_db_(0.0f),
+      gain_(1.0f),
+      gain_target_(1.0f),
+      gate_(1.0f),
+      gate_threshold_db_(GATE_OFF_DB),
+      gate_hold_frames_(0) {
+}
+
+void ParamRamper::reset(const RuntimeParams& params) {
+    atten_db_ = params.atten_lim_db;
+    gain_ = gain_target_ = dbToLinear(params.output_gain_db);
+    gate_ = 1.0f;
+    gate_threshold_db_ = params.gate_threshold_db;
+    gate_hold_frames_ = 0;
+}
+
+float ParamRamper::beginFrame(const RuntimeParams& target) {
+    atten_db_ += std::clamp(target.atten_lim_db - atten_db_, -ATTEN_STEP_DB, ATTEN_STEP_DB);
+    gain_target_ = dbToLinear(target.output_gain_db);
+    gate_threshold_db_ = target.gate_threshold_db;
+    return atten_db_;
+}
+
+void ParamRamper::process(float* samples, size_t count) {
+    if (count == 0) return;
+
+    // Gate decision on the frame level
+    float gate_target = 1.0f;
+    if (gate_threshold_db_ > GATE_OFF_DB) {
+        float energy = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            energy += samples[i] * samples[i];
+        }
+        float rms_db = 10.0f * std::log10(energy / count + 1e-12f);
+
+        if (rms_db >= gate_threshold_db_) {
+            gate_hold_frames_ = GATE_HOLD_FRAMES;
+        } else if (gate_hold_frames_ > 0) {
+            gate_hold_frames_--;
+        } else {
+            gate_target = 0.0f;
+        }
+    }
+
+    // Open immediately, close gradually
+    float gate_end = gate_target >= gate_ ? gate_target : std::max(gate_target, gate_ - GATE_CLOSE_STEP);
+
+    float start = gain_ * gate_;
+    float end = gain_target_ * gate_end;
+    float step = (end - start) / static_cast<float>(count);
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] *= start + step * static_cast<float>(i + 1);
+    }
+
+    gain_ = gain_target_;
+    gate_ = gate_end;
+}
@@ -0,0 +1,222 @@
+#include "Core/SpectralGate.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using std::vector;
+
+static const float POWER_SMOOTHING = 0.7f;      // per hop, for the noise tracker
+static const float NOISE_RISE_DB_PER_S = 5.0f;  // how fast the floor may climb
+static const float NOISE_BIAS = 2.0f;           // minimum of the smoothed power underestimates the mean
+static const float DD_ALPHA = 0.98f;            // decision-directed a-priori SNR smoothing
+static const float POWER_EPSILON = 1e-12f;
+
+SpectralGate::SpectralGate()
+    : strength_db_(0.0f),
+      window_(WINDOW_SIZE),
+      twiddle_re_(FFT_SIZE / 2),
+      twiddle_im_(FFT_SIZE / 2),
+      bit_reverse_(FFT_SIZE),
+      input_(WINDOW_SIZE),
+      overlap_(HOP_SIZE),
+      re_(FFT_SIZE),
+      im_(FFT_SIZE),
+      power_(BINS),
+      smoothed_(BINS),
+      noise_(BINS),
+      prev_clean_(BINS),
+      gain_(BINS),
+      primed_(false) {
+
+    // sqrt of a periodic Hann: analysis and synthesis together sum to one
+    // at 50% overlap
+    for (int n = 0; n < WINDOW_SIZE; ++n) {
+        window_[n] = std::sin(static_cast<float>(M_PI) * n / WINDOW_SIZE);
+    }
+    for (int k = 0; k < FFT_SIZE / 2; ++k) {
+        double angle = -2.0 * M_PI * k / FFT_SIZE;
+        twiddle_re_[k] = static_cast<float>(std::cos(angle));
+        twiddle_im_[k] = static_cast<float>(std::sin(angle));
+    }
+    int bits = 0;
+    while ((1 << bits) < FFT_SIZE) ++bits;
+    for (int i = 0; i < FFT_SIZE; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = r;
+    }
+    reset();
+}
+
+void SpectralGate::reset() {
+    std::fill(input_.begin(), input_.end(), 0.0f);
+    std::fill(overlap_.begin(), overlap_.end(), 0.0f);
+    std::fill(smoothed_.begin(), smoothed_.end(), 0.0f);
+    std::fill(noise_.begin(), noise_.end(), 0.0f);
+    std::fill(prev_clean_.begin(), prev_clean_.end(), 0.0f);
+    std::fill(gain_.begin(), gain_.end(), 1.0f);
+    primed_ = false;
+}
+
+void SpectralGate::SetNoiseSuppressionStrength(float db) {
+    strength_db_.store(std::clamp(db, -100.0f, 0.0f), std::memory_order_relaxed);
+}
+
+// In-place iterative radix-2 on split real/imaginary arrays
+void SpectralGate::fft(float* re, float* im) const {
+    for (int i = 0; i < FFT_SIZE; ++i) {
+        int j = bit_reverse_[i];
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for (int len = 2; len <= FFT_SIZE; len <<= 1) {
+        int half = len / 2;
+        int step = FFT_SIZE / len;
+        for (int start = 0; start < FFT_SIZE; start += len) {
+            float* re_a = re + start;
+            float* im_a = im + start;
+            float* re_b = re + start + half;
+            float* im_b = im + start + half;
+            for (int k = 0; k < half; ++k) {
+                float wr = twiddle_re_[k * step];
+                float wi = twiddle_im_[k * step];
+                float br = re_b[k] * wr - im_b[k] * wi;
+                float bi = re_b[k] * wi + im_b[k] * wr;
+                re_b[k] = re_a[k] - br;
+                im_b[k] = im_a[k] - bi;
+                re_a[k] += br;
+                im_a[k] += bi;
+            }
+        }
+    }
+}
+
+void SpectralGate::updateGains() {
+    const float* re = re_.data();
+    const float* im = im_.data();
+    float* power = power_.data();
+    float* smoothed = smoothed_.data();
+    float* noise = noise_.data();
+    float* prev_clean = prev_clean_.data();
+    float* gain = gain_.data();
+
+    for (int k = 0; k < BINS; ++k) {
+        power[k] = re[k] * re[k] + im[k] * im[k];
+    }
+
+    if (!primed_) {
+        // First frame with signal seeds the tracker; leading silence passes
+        float energy = 0.0f;
+        for (int k = 0; k < BINS; ++k) energy += power[k];
+        if (energy <= 0.0f) return;
+        std::copy(power, power + BINS, smoothed);
+        std::copy(power, power + BINS, noise);
+        primed_ = true;
+    }
+
+    const float rise = std::pow(10.0f, NOISE_RISE_DB_PER_S * HOP_SIZE / SAMPLE_RATE / 10.0f);
+    const float floor_db = std::clamp(DEFAULT_FLOOR_DB + strength_db_.load(std::memory_order_relaxed), -100.0f, 0.0f);
+    const float floor = std::pow(10.0f, floor_db / 20.0f);
+
+    // Branch-free so the compiler can vectorise across bins
+    for (int k = 0; k < BINS; ++k) {
+        smoothed[k] = POWER_SMOOTHING * smoothed[k] + (1.0f - POWER_SMOOTHING) * power[k];
+        noise[k] = std::max(std::min(noise[k] * rise, smoothed[k]), POWER_EPSILON);
+
+        float noise_power = NOISE_BIAS * noise[k];
+        float snr_post = power[k] / noise_power;
+        float snr_prio = DD_ALPHA * prev_clean[k] / noise_power +
+                         (1.0f - DD_ALPHA) * std::max(snr_post - 1.0f, 0.0f);
+        float g = std::max(snr_prio / (1.0f + snr_prio), floor);
+        gain[k] = g;
+        prev_clean[k] = g * g * power[k];
+    }
+}
+
+void SpectralGate::ProcessRealtimeFrame(const float* frame, float* out) {
+    // Slide the analysis window by one hop
+    std::copy(input_.begin() + HOP_SIZE, input_.end(), input_.begin());
+    std::copy(frame, frame + HOP_SIZE, input_.begin() + (WINDOW_SIZE - HOP_SIZE));
+
+    float* re = re_.data();
+    float* im = im_.data();
+    for (int n = 0; n < WINDOW_SIZE; ++n) {
+        re[n] = input_[n] * window_[n];
+    }
+    std::fill(re + WINDOW_SIZE, re + FFT_SIZE, 0.0f);
+    std::fill(im, im + FFT_SIZE, 0.0f);
+
+    fft(re, im);
+    updateGains();
+
+    // Real gains keep the spectrum conjugate-symmetric
+    for (int k = 0; k < BINS; ++k) {
+        re[k] *= gain_[k];
+        im[k] *= gain_[k];
+    }
+    for (int k = BINS; k < FFT_SIZE; ++k) {
+        re[k] *= gain_[FFT_SIZE - k];
+        im[k] *= gain_[FFT_SIZE - k];
+    }
+
+    // Inverse by swapping real and imaginary parts around a forward pass
+    fft(im, re);
+    const float scale = 1.0f / FFT_SIZE;
+
+    for (int n = 0; n < HOP_SIZE; ++n) {
+        out[n] = overlap_[n] + re[n] * scale * window_[n];
+    }
+    for (int n = 0; n < HOP_SIZE; ++n) {
+        overlap_[n] = re[HOP_SIZE + n] * scale * window_[HOP_SIZE + n];
+    }
+}
+
+vector<float> SpectralGate::ApplyNoiseSuppression(const vector<float>& audio) {
+    if (audio.empty()) {
+        throw std::runtime_error("Input audio is empty");
+    }
+
+    vector<float> enhanced(audio.size());
+    ApplyNoiseSuppression(std::span<const float>(audio), std::span<float>(enhanced));
+    return enhanced;
+}
+
+void SpectralGate::ApplyNoiseSuppression(std::span<const float> input, std::span<float> output) {
+    size_t written = 0;
+    ApplyNoiseSuppression(input, output.size(), [&](const float* samples, size_t count) {
+        std::copy(samples, samples + count, output.begin() + written);
+        written += count;
+    });
+}
+
+void SpectralGate::ApplyNoiseSuppression(std::span<const float> input, size_t output_length,
+                                         const OfflineSink& sink) {
+    reset();
+    const size_t latency = StreamLatency();
+    const size_t needed = latency + output_length;
+
+    float staged[HOP_SIZE];
+    float enhanced[HOP_SIZE];
+    for (size_t pos = 0; pos < needed; pos += HOP_SIZE) {
+        const float* frame = staged;
+        if (pos + HOP_SIZE <= input.size()) {
+            frame = input.data() + pos;
+        } else {
+            size_t available = pos < input.size() ? input.size() - pos : 0;
+            std::copy_n(input.begin() + std::min(pos, input.size()), available, staged);
+            std::fill(staged + available, staged + HOP_SIZE, 0.0f);
+        }
+        ProcessRealtimeFrame(frame, enhanced);
+
+        size_t begin = std::max(pos, latency);
+        size_t end = std::min(pos + HOP_SIZE, needed);
+        if (begin < end) {
+            sink(enhanced + (begin - pos), end - begin);
+        }
+    }
+}
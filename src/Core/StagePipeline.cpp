@@ -0,0 +1,417 @@
+#include "Core/StagePipeline.h"
+#include "Core/NoiseSuppressor.h"
+#include "Utils/AllocTracker.h"
+#include "Utils/Tracer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+using std::runtime_error;
+
+static const size_t HOP = NoiseSuppressor::HOP_SIZE;
+
+bool PipelineConfig::Available() {
+#if NEURALMIC_STAGE_PIPELINE
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool PipelineConfig::Parse(const string& spec, PipelineConfig& config) {
+    size_t at = spec.find('@');
+    string paths = spec.substr(0, at);
+    size_t comma = paths.find(',');
+    if (comma == string::npos || comma == 0 || comma + 1 == paths.size()) {
+        return false;
+    }
+    config.stage_paths[0] = paths.substr(0, comma);
+    config.stage_paths[1] = paths.substr(comma + 1);
+
+    if (at != string::npos) {
+        string cpus = spec.substr(at + 1);
+        size_t cpu_comma = cpus.find(',');
+        if (cpu_comma == string::npos) return false;
+        try {
+            config.stage_cpus[0] = std::stoi(cpus.substr(0, cpu_comma));
+            config.stage_cpus[1] = std::stoi(cpus.substr(cpu_comma + 1));
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+StagePipeline::StagePipeline(const PipelineConfig& config, const MemoryProfile& memory,
+                             const std::atomic<float>& atten_lim_db)
+    : env_(ORT_LOGGING_LEVEL_WARNING, "DenoiserPipeline"),
+      memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+      atten_lim_db_(atten_lim_db) {
+
+    for (int i = 0; i < 2; ++i) {
+        loadStage(i, config.stage_paths[i], memory);
+        stages_[i].cpu = config.stage_cpus[i];
+    }
+    bindStages();
+
+    for (int i = 0; i < 2; ++i) {
+        stages_[i].thread = std::thread(&StagePipeline::stageLoop, this, i);
+    }
+
+    // Warm-up: sizes both arenas before the audio thread gets here
+    vector<float> silence(HOP, 0.0f);
+    for (int i = 0; i < 4; ++i) {
+        process(silence.data(), silence.data());
+    }
+    reset();
+
+    cout << "✓ Pipelined model: " << config.stage_paths[0] << " -> " << config.stage_paths[1];
+    if (config.stage_cpus[0] >= 0) {
+        cout << " (CPUs " << config.stage_cpus[0] << ", " << config.stage_cpus[1] << ")";
+    }
+    cout << ", +" << HOP * 1000 / NoiseSuppressor::SAMPLE_RATE << " ms latency\n";
+}
+
+StagePipeline::~StagePipeline() {
+    stop_.store(true, std::memory_order_release);
+    // Waiting threads only wake on a changed value
+    submitted_.fetch_add(1, std::memory_order_release);
+    submitted_.notify_all();
+    completed_[0].fetch_add(1, std::memory_order_release);
+    completed_[0].notify_all();
+
+    for (Stage& stage : stages_) {
+        if (stage.thread.joinable()) {
+            stage.thread.join();
+        }
+    }
+}
+
+void StagePipeline::loadStage(int index, const string& path, const MemoryProfile& memory) {
+    Stage& stage = stages_[index];
+
+    Ort::SessionOptions options;
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    options.SetIntraOpNumThreads(1);
+    options.SetInterOpNumThreads(1);
+    options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+    if (!memory.use_arena) options.DisableCpuMemArena();
+    if (!memory.mem_pattern) options.DisableMemPattern();
+
+    stage.session = Ort::Session(env_, path.c_str(), options);
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    auto describe = [&](bool output, size_t i) {
+        Tensor tensor;
+        auto name = output ? stage.session.GetOutputNameAllocated(i, allocator)
+                           : stage.session.GetInputNameAllocated(i, allocator);
+        auto info = output ? stage.session.GetOutputTypeInfo(i) : stage.session.GetInputTypeInfo(i);
+        tensor.name = name.get();
+        tensor.shape = info.GetTensorTypeAndShapeInfo().GetShape();
+        tensor.size = 1;
+        for (int64_t dim : tensor.shape) {
+            if (dim < 0) {
+                throw runtime_error("Stage " + std::to_string(index + 1) + " tensor " + tensor.name +
+                                    " has a dynamic shape; pipelined stages need fixed shapes");
+            }
+            tensor.size *= static_cast<size_t>(dim);
+        }
+        return tensor;
+    };
+
+    for (size_t i = 0; i < stage.session.GetInputCount(); ++i) {
+        stage.inputs.push_back(describe(false, i));
+    }
+    for (size_t i = 0; i < stage.session.GetOutputCount(); ++i) {
+        stage.outputs.push_back(describe(true, i));
+    }
+}
+
+// Works out where every tensor lives and allocates it, once
+void StagePipeline::bindStages() {
+    auto fail = [](int index, const string& what) {
+        throw runtime_error("Stage " + std::to_string(index + 1) + ": " + what);
+    };
+    auto expectSize = [&](int index, const Tensor& tensor, size_t size) {
+        if (tensor.size != size) {
+            fail(index, tensor.name + " holds " + std::to_string(tensor.size) + " values, expected " +
+                        std::to_string(size));
+        }
+    };
+
+    Stage& first = stages_[0];
+    Stage& second = stages_[1];
+
+    for (int index = 0; index < 2; ++index) {
+        Stage& stage = stages_[index];
+        size_t state_size = 0;
+        bool has_frame = false;
+
+        for (Tensor& tensor : stage.inputs) {
+            if (tensor.name == "input_frame") {
+                tensor.role = Role::Frame;
+                expectSize(index, tensor, HOP);
+                has_frame = true;
+            } else if (tensor.name == "states") {
+                tensor.role = Role::State;
+                state_size = tensor.size;
+            } else if (tensor.name == "atten_lim_db") {
+                tensor.role = Role::Atten;
+                expectSize(index, tensor, 1);
+            } else if (index == 1) {
+                // Has to be something stage 1 produces
+                auto source = std::find_if(first.outputs.begin(), first.outputs.end(),
+                                           [&](const Tensor& out) { return out.name == tensor.name; });
+                if (source == first.outputs.end() || source->name == "new_states") {
+                    fail(index, "input " + tensor.name + " is not produced by stage 1");
+                }
+                expectSize(index, tensor, source->size);
+                tensor.role = Role::Intermediate;
+                tensor.source = static_cast<int>(source - first.outputs.begin());
+            } else {
+                fail(index, "input " + tensor.name + " is not input_frame, states or atten_lim_db");
+            }
+        }
+        if (index == 0 && !has_frame) {
+            fail(index, "has no input_frame input");
+        }
+
+        bool has_next_state = false;
+        bool has_enhanced = false;
+        for (Tensor& tensor : stage.outputs) {
+            if (tensor.name == "new_states") {
+                tensor.role = Role::NextState;
+                expectSize(index, tensor, state_size);
+                has_next_state = true;
+            } else if (index == 0) {
+                tensor.role = Role::Intermediate;
+            } else if (tensor.name == "enhanced_audio_frame") {
+                tensor.role = Role::Enhanced;
+                expectSize(index, tensor, HOP);
+                has_enhanced = true;
+            } else {
+                tensor.role = Role::Scratch;
+            }
+        }
+        if ((state_size > 0) != has_next_state) {
+            fail(index, "states and new_states must come as a pair");
+        }
+        if (index == 1 && !has_enhanced) {
+            fail(index, "has no enhanced_audio_frame output");
+        }
+
+        stage.state.assign(state_size, 0.0f);
+        stage.next_state.assign(state_size, 0.0f);
+        stage.scratch.resize(stage.outputs.size());
+        for (size_t i = 0; i < stage.outputs.size(); ++i) {
+            if (stage.outputs[i].role == Role::Scratch) {
+                stage.scratch[i].assign(stage.outputs[i].size, 0.0f);
+            }
+        }
+
+        for (const Tensor& tensor : stage.inputs) {
+            stage.input_names.push_back(tensor.name.c_str());
+            stage.input_values.emplace_back(nullptr);
+        }
+        for (const Tensor& tensor : stage.outputs) {
+            stage.output_names.push_back(tensor.name.c_str());
+            stage.output_values.emplace_back(nullptr);
+        }
+    }
+
+    for (Slot& slot : slots_) {
+        slot.frame.assign(HOP, 0.0f);
+        slot.enhanced.assign(HOP, 0.0f);
+        slot.intermediates.resize(first.outputs.size());
+        for (size_t i = 0; i < first.outputs.size(); ++i) {
+            if (first.outputs[i].role == Role::Intermediate) {
+                slot.intermediates[i].assign(first.outputs[i].size, 0.0f);
+            }
+        }
+    }
+
+    size_t intermediate_bytes = 0;
+    for (const Tensor& tensor : second.inputs) {
+        if (tensor.role == Role::Intermediate) intermediate_bytes += tensor.size * sizeof(float);
+    }
+    cout << "  stage 1 -> 2: " << intermediate_bytes / 1024.0 << " KiB of intermediates per hop, "
+         << "states " << first.state.size() << " + " << second.state.size() << " values\n";
+}
+
+float* StagePipeline::bufferFor(Stage& stage, const Tensor& tensor, size_t index, Slot& slot, float& atten) {
+    switch (tensor.role) {
+        case Role::Frame:        return slot.frame.data();
+        case Role::State:        return stage.state.data();
+        case Role::Atten:        return &atten;
+        case Role::NextState:    return stage.next_state.data();
+        case Role::Enhanced:     return slot.enhanced.data();
+        case Role::Scratch:      return stage.scratch[index].data();
+        case Role::Intermediate:
+            // Stage 1 writes its own outputs; stage 2 reads the one it names
+            return slot.intermediates[tensor.source >= 0 ? tensor.source : index].data();
+    }
+    return nullptr;
+}
+
+void StagePipeline::runStage(Stage& stage, Slot& slot) {
+    AllocExemptScope ort_scope("onnxruntime");
+    float atten = atten_lim_db_.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < stage.inputs.size(); ++i) {
+        const Tensor& tensor = stage.inputs[i];
+        stage.input_values[i] = Ort::Value::CreateTensor<float>(
+            memory_info_, bufferFor(stage, tensor, i, slot, atten), tensor.size,
+            tensor.shape.data(), tensor.shape.size());
+    }
+    for (size_t i = 0; i < stage.outputs.size(); ++i) {
+        const Tensor& tensor = stage.outputs[i];
+        stage.output_values[i] = Ort::Value::CreateTensor<float>(
+            memory_info_, bufferFor(stage, tensor, i, slot, atten), tensor.size,
+            tensor.shape.data(), tensor.shape.size());
+    }
+
+    stage.session.Run(Ort::RunOptions{nullptr},
+                      stage.input_names.data(), stage.input_values.data(), stage.input_values.size(),
+                      stage.output_names.data(), stage.output_values.data(), stage.output_values.size());
+    stage.state.swap(stage.next_state);
+}
+
+bool StagePipeline::waitBeyond(const std::atomic<uint64_t>& counter, uint64_t value) const {
+    while (!stop_.load(std::memory_order_acquire)) {
+        uint64_t seen = counter.load(std::memory_order_acquire);
+        if (seen > value) return true;
+        counter.wait(seen, std::memory_order_acquire);
+    }
+    return false;
+}
+
+void StagePipeline::stageLoop(int index) {
+    Stage& stage = stages_[index];
+
+    if (stage.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(stage.cpu, &set);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            cerr << "Could not pin stage " << index + 1 << " to CPU " << stage.cpu << ": " << std::strerror(rc) << "\n";
+        }
+    }
+
+    // Stage 1 follows the caller, stage 2 follows stage 1
+    const std::atomic<uint64_t>& upstream = index == 0 ? submitted_ : completed_[0];
+    const char* trace_name = index == 0 ? "pipeline stage 1" : "pipeline stage 2";
+    uint64_t done = 0;
+
+    while (waitBeyond(upstream, done)) {
+        Slot& slot = slots_[done % SLOTS];
+
+        // A reset queued before this hop was submitted; only this thread
+        // touches the stage's state, so zero it here
+        uint64_t reset_hop = reset_hop_.load(std::memory_order_acquire);
+        if (reset_hop > stage.reset_hop && done >= reset_hop) {
+            std::fill(stage.state.begin(), stage.state.end(), 0.0f);
+            std::fill(stage.next_state.begin(), stage.next_state.end(), 0.0f);
+            stage.reset_hop = reset_hop;
+        }
+
+        uint64_t t0 = Tracer::nowNs();
+        try {
+            TraceScope trace(trace_name);
+            runStage(stage, slot);
+        } catch (const std::exception& e) {
+            // Pass the hop through silent rather than stall the caller
+            if (stage.errors.fetch_add(1, std::memory_order_relaxed) == 0) {
+                cerr << "Pipeline stage " << index + 1 << " failed: " << e.what() << "\n";
+            }
+            if (index == 1) std::fill(slot.enhanced.begin(), slot.enhanced.end(), 0.0f);
+        }
+        uint64_t ns = Tracer::nowNs() - t0;
+
+        stage.hops.fetch_add(1, std::memory_order_relaxed);
+        stage.total_ns.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > stage.max_ns.load(std::memory_order_relaxed)) {
+            stage.max_ns.store(ns, std::memory_order_relaxed);
+        }
+
+        completed_[index].store(++done, std::memory_order_release);
+        completed_[index].notify_all();
+    }
+}
+
+void StagePipeline::process(const float* frame, float* out) {
+    const uint64_t hop = next_hop_++;
+    Slot& slot = slots_[hop % SLOTS];
+
+    // The slot's last user was hop-2, collected on the previous call
+    std::copy(frame, frame + HOP, slot.frame.begin());
+    submitted_.store(hop + 1, std::memory_order_release);
+    submitted_.notify_all();
+
+    if (hop == 0) {
+        std::fill(out, out + HOP, 0.0f);
+        return;
+    }
+
+    // Previous hop, normally long finished while this one was on its way
+    uint64_t t0 = Tracer::nowNs();
+    if (completed_[1].load(std::memory_order_acquire) < hop) {
+        TraceScope trace("pipeline wait");
+        waitBeyond(completed_[1], hop - 1);
+    }
+    uint64_t ns = Tracer::nowNs() - t0;
+    waits_.fetch_add(1, std::memory_order_relaxed);
+    wait_total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > wait_max_ns_.load(std::memory_order_relaxed)) {
+        wait_max_ns_.store(ns, std::memory_order_relaxed);
+    }
+
+    // Still waited for above: the next call reuses that hop's slot
+    if (hop == reset_hop_.load(std::memory_order_relaxed)) {
+        std::fill(out, out + HOP, 0.0f);
+        return;
+    }
+    const Slot& previous = slots_[(hop - 1) % SLOTS];
+    std::copy(previous.enhanced.begin(), previous.enhanced.end(), out);
+}
+
+void StagePipeline::reset() {
+    // Ordered before the next hop's submit, which the stages acquire
+    reset_hop_.store(next_hop_, std::memory_order_release);
+}
+
+PipelineTiming StagePipeline::stageTiming(int index) const {
+    const Stage& stage = stages_[index];
+    return {stage.hops.load(std::memory_order_relaxed),
+            stage.total_ns.load(std::memory_order_relaxed),
+            stage.max_ns.load(std::memory_order_relaxed)};
+}
+
+PipelineTiming StagePipeline::waitTiming() const {
+    return {waits_.load(std::memory_order_relaxed),
+            wait_total_ns_.load(std::memory_order_relaxed),
+            wait_max_ns_.load(std::memory_order_relaxed)};
+}
+
+void StagePipeline::printStats() const {
+    auto line = [](const char* name, const PipelineTiming& t) {
+        double avg_us = t.hops ? t.total_ns / 1000.0 / t.hops : 0.0;
+        cout << "  " << name << ": " << avg_us << " us avg, " << t.max_ns / 1000.0 << " us max ("
+             << t.hops << " hops)\n";
+    };
+    cout << "\n=== Model Pipeline ===\n";
+    line("stage 1", stageTiming(0));
+    line("stage 2", stageTiming(1));
+    line("caller wait", waitTiming());
+    uint64_t errors = stages_[0].errors.load(std::memory_order_relaxed) + stages_[1].errors.load(std::memory_order_relaxed);
+    if (errors > 0) {
+        cout << "  ✗ " << errors << " failed stage runs\n";
+    }
+}
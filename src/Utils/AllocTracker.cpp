@@ -0,0 +1,242 @@
+#include "Utils/AllocTracker.h"
+#include <iostream>
+
+#if NEURALMIC_ALLOC_TRACKING
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <execinfo.h>
+#include <unistd.h>
+
+// glibc's own entry points, so the hooks below can forward without recursing
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+// initial-exec: touching these must never allocate, even from a shared library
+#define TRACKER_TLS static thread_local __attribute__((tls_model("initial-exec")))
+
+TRACKER_TLS const char* realtime_scope = nullptr;
+TRACKER_TLS int realtime_depth = 0;
+TRACKER_TLS const char* exempt_label = nullptr;
+TRACKER_TLS bool reporting = false;
+
+static const int MAX_REPORTED = 16;      // full backtraces; later ones are only counted
+static const int MAX_LABELS = 8;
+
+static std::atomic<AllocPolicy> policy{AllocPolicy::Report};
+static std::atomic<uint64_t> violation_count{0};
+static std::atomic<uint64_t> section_count{0};
+
+static const char* exempt_labels[MAX_LABELS];
+static std::atomic<uint64_t> exempt_counts[MAX_LABELS];
+static std::atomic<int> exempt_label_count{0};
+
+static void writeStderr(const char* text) {
+    ssize_t ignored = ::write(STDERR_FILENO, text, std::strlen(text));
+    (void)ignored;
+}
+
+static void countExempt(const char* label) {
+    int count = exempt_label_count.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        if (exempt_labels[i] == label) {
+            exempt_counts[i].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Labels are string literals, registered once; racing registrations
+    // of the same label at worst produce two rows
+    int slot = exempt_label_count.fetch_add(1, std::memory_order_acq_rel);
+    if (slot < MAX_LABELS) {
+        exempt_labels[slot] = label;
+        exempt_counts[slot].store(1, std::memory_order_relaxed);
+    }
+}
+
+static void noteAllocation(size_t size, const char* kind) {
+    if (realtime_depth == 0 || reporting) return;
+
+    if (exempt_label) {
+        countExempt(exempt_label);
+        return;
+    }
+
+    uint64_t n = violation_count.fetch_add(1, std::memory_order_relaxed) + 1;
+    bool abort_now = policy.load(std::memory_order_relaxed) == AllocPolicy::Abort;
+    if (n > MAX_REPORTED && !abort_now) return;
+
+    // backtrace() may allocate on first use; let that through
+    reporting = true;
+    char line[256];
+    std::snprintf(line, sizeof(line), "\n✗ Allocation in realtime section '%s': %s(%zu)\n",
+                  realtime_scope, kind, size);
+    writeStderr(line);
+
+    void* frames[32];
+    int depth = ::backtrace(frames, 32);
+    ::backtrace_symbols_fd(frames + 2, depth - 2, STDERR_FILENO);
+    reporting = false;
+
+    if (abort_now) {
+        std::fflush(stdout);
+        std::abort();
+    }
+}
+
+// ============================================================================
+// Hooks
+// ============================================================================
+
+extern "C" {
+
+void* malloc(size_t size) {
+    noteAllocation(size, "malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    noteAllocation(count * size, "calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (size > 0) noteAllocation(size, "realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    noteAllocation(size, "memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    noteAllocation(size, "aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    noteAllocation(size, "posix_memalign");
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+}
+
+static void* newImpl(size_t size, const char* kind) {
+    noteAllocation(size, kind);
+    void* ptr = __libc_malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+static void* alignedNewImpl(size_t size, std::align_val_t alignment, const char* kind) {
+    noteAllocation(size, kind);
+    void* ptr = __libc_memalign(static_cast<size_t>(alignment), size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size) { return newImpl(size, "operator new"); }
+void* operator new[](size_t size) { return newImpl(size, "operator new[]"); }
+void* operator new(size_t size, std::align_val_t a) { return alignedNewImpl(size, a, "operator new"); }
+void* operator new[](size_t size, std::align_val_t a) { return alignedNewImpl(size, a, "operator new[]"); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    noteAllocation(size, "operator new");
+    return __libc_malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    noteAllocation(size, "operator new[]");
+    return __libc_malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { __libc_free(ptr); }
+
+// Load the unwinder now rather than inside the first report
+static const bool backtrace_ready = [] {
+    void* frame;
+    ::backtrace(&frame, 1);
+    return true;
+}();
+
+// ============================================================================
+// Scopes
+// ============================================================================
+
+RealtimeScope::RealtimeScope(const char* name)
+    : previous_(realtime_scope) {
+    if (realtime_depth++ == 0) {
+        section_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    realtime_scope = name;
+}
+
+RealtimeScope::~RealtimeScope() {
+    realtime_scope = previous_;
+    realtime_depth--;
+}
+
+AllocExemptScope::AllocExemptScope(const char* label)
+    : previous_(exempt_label) {
+    exempt_label = label;
+}
+
+AllocExemptScope::~AllocExemptScope() {
+    exempt_label = previous_;
+}
+
+bool AllocTracker::enabled() { return true; }
+void AllocTracker::setPolicy(AllocPolicy p) { policy = p; }
+uint64_t AllocTracker::violations() { return violation_count.load(); }
+uint64_t AllocTracker::realtimeSections() { return section_count.load(); }
+
+void AllocTracker::printReport() {
+    uint64_t sections = section_count.load();
+    std::cout << "\n=== Realtime Allocations ===\n";
+    std::cout << "  Realtime sections: " << sections << "\n";
+    std::cout << "  Violations: " << violation_count.load() << "\n";
+
+    int labels = std::min(exempt_label_count.load(), MAX_LABELS);
+    for (int i = 0; i < labels; ++i) {
+        uint64_t count = exempt_counts[i].load();
+        std::cout << "  Exempt (" << exempt_labels[i] << "): " << count << " allocations, "
+                  << (sections ? static_cast<double>(count) / sections : 0.0) << " per section\n";
+    }
+    std::cout << "============================\n";
+}
+
+#else
+
+bool AllocTracker::enabled() { return false; }
+void AllocTracker::setPolicy(AllocPolicy) {}
+uint64_t AllocTracker::violations() { return 0; }
+uint64_t AllocTracker::realtimeSections() { return 0; }
+
+void AllocTracker::printReport() {
+    std::cout << "Allocation tracking not built in (configure with -DNEURALMIC_ALLOC_TRACKING=ON)\n";
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include "Utils/AudioMetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using std::vector;
+using Complex = std::complex<double>;
+
+static const size_t LSD_FRAME = 1024;
+static const size_t LSD_HOP = 512;
+
+// Iterative radix-2; size must be a power of two
+static void fft(vector<Complex>& data) {
+    size_t n = data.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        Complex step = std::polar(1.0, -2.0 * M_PI / static_cast<double>(len));
+        for (size_t start = 0; start < n; start += len) {
+            Complex w = 1.0;
+            for (size_t k = 0; k < len / 2; ++k) {
+                Complex even = data[start + k];
+                Complex odd = data[start + k + len / 2] * w;
+                data[start + k] = even + odd;
+                data[start + k + len / 2] = even - odd;
+                w *= step;
+            }
+        }
+    }
+}
+
+static void powerSpectrum(const float* samples, const vector<double>& window,
+                          vector<Complex>& scratch, vector<double>& power) {
+    for (size_t i = 0; i < LSD_FRAME; ++i) {
+        scratch[i] = samples[i] * window[i];
+    }
+    fft(scratch);
+    for (size_t k = 0; k < power.size(); ++k) {
+        power[k] = std::norm(scratch[k]);
+    }
+}
+
+AudioDiff compareAudio(const float* reference, const float* test, size_t count) {
+    AudioDiff diff;
+    diff.samples = count;
+
+    double signal = 0.0;
+    double error = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double e = static_cast<double>(test[i]) - reference[i];
+        diff.max_abs_error = std::max(diff.max_abs_error, std::abs(e));
+        signal += static_cast<double>(reference[i]) * reference[i];
+        error += e * e;
+    }
+    diff.snr_db = error > 0.0 ? 10.0 * std::log10((signal + 1e-20) / error) : INFINITY;
+
+    vector<double> window(LSD_FRAME);
+    for (size_t i = 0; i < LSD_FRAME; ++i) {
+        window[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / LSD_FRAME);
+    }
+
+    vector<Complex> scratch(LSD_FRAME);
+    vector<double> ref_power(LSD_FRAME / 2 + 1);
+    vector<double> test_power(LSD_FRAME / 2 + 1);
+    double lsd_sum = 0.0;
+    size_t frames = 0;
+
+    for (size_t start = 0; start + LSD_FRAME <= count; start += LSD_HOP) {
+        powerSpectrum(reference + start, window, scratch, ref_power);
+        powerSpectrum(test + start, window, scratch, test_power);
+
+        // Bins more than 80 dB under the frame's peak are noise floor either way
+        double floor = std::max(*std::max_element(ref_power.begin(), ref_power.end()) * 1e-8, 1e-10);
+        double sum = 0.0;
+        for (size_t k = 0; k < ref_power.size(); ++k) {
+            double d = 10.0 * std::log10(std::max(ref_power[k], floor)) - 10.0 * std::log10(std::max(test_power[k], floor));
+            sum += d * d;
+        }
+        lsd_sum += std::sqrt(sum / ref_power.size());
+        frames++;
+    }
+    diff.lsd_db = frames ? lsd_sum / frames : 0.0;
+    return diff;
+}
@@ -0,0 +1,619 @@
+#include "Utils/FlacWriter.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+using std::vector;
+
+static const int BITS_PER_SAMPLE = 16;
+static const int MAX_LPC_ORDER = 12;
+static const int LPC_PRECISION = 12;       // bits per quantised coefficient, sign included
+static const int MAX_PARTITION_ORDER = 8;
+static const int MAX_RICE_PARAM = 14;      // 15 is the escape code
+
+// ============================================================================
+// Bit packing and checksums
+// ============================================================================
+
+namespace {
+
+class BitWriter {
+public:
+    void write(uint32_t value, int bits) {
+        if (bits == 0) return;
+        acc_ = (acc_ << bits) | (bits == 32 ? value : value & ((1u << bits) - 1));
+        acc_bits_ += bits;
+        while (acc_bits_ >= 8) {
+            acc_bits_ -= 8;
+            bytes_.push_back(static_cast<uint8_t>(acc_ >> acc_bits_));
+        }
+    }
+
+    void writeSigned(int32_t value, int bits) { write(static_cast<uint32_t>(value), bits); }
+
+    void writeRice(int32_t value, int k) {
+        uint32_t folded = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+        uint32_t quotient = folded >> k;
+        while (quotient >= 32) {
+            write(0, 32);
+            quotient -= 32;
+        }
+        write(1, quotient + 1);
+        write(folded, k);
+    }
+
+    void alignToByte() {
+        if (acc_bits_ > 0) write(0, 8 - acc_bits_);
+    }
+
+    vector<uint8_t>& bytes() { return bytes_; }
+
+private:
+    vector<uint8_t> bytes_;
+    uint64_t acc_ = 0;
+    int acc_bits_ = 0;
+};
+
+struct CrcTables {
+    std::array<uint8_t, 256> crc8;
+    std::array<uint16_t, 256> crc16;
+
+    CrcTables() {
+        for (int i = 0; i < 256; ++i) {
+            uint8_t c8 = static_cast<uint8_t>(i);
+            uint16_t c16 = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                c8 = static_cast<uint8_t>((c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1);
+                c16 = static_cast<uint16_t>((c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1);
+            }
+            crc8[i] = c8;
+            crc16[i] = c16;
+        }
+    }
+};
+
+const CrcTables& crcTables() {
+    static const CrcTables tables;
+    return tables;
+}
+
+uint8_t crc8(const uint8_t* data, size_t size) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size; ++i) crc = crcTables().crc8[crc ^ data[i]];
+    return crc;
+}
+
+uint16_t crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < size; ++i) {
+        crc = static_cast<uint16_t>((crc << 8) ^ crcTables().crc16[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+// ============================================================================
+// Residual coding
+// ============================================================================
+
+struct RiceCoding {
+    int partition_order = 0;
+    vector<int> params;
+    uint64_t bits = std::numeric_limits<uint64_t>::max();
+};
+
+uint32_t fold(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+// Bits for one partition at its best parameter
+uint64_t partitionBits(const int32_t* residual, size_t count, int& param) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i) sum += fold(residual[i]);
+
+    int estimate = 0;
+    if (count > 0 && sum > count) {
+        estimate = std::min(MAX_RICE_PARAM, static_cast<int>(std::floor(std::log2(static_cast<double>(sum) / count))));
+    }
+
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (int k = std::max(0, estimate - 1); k <= std::min(MAX_RICE_PARAM, estimate + 1); ++k) {
+        uint64_t bits = count * static_cast<uint64_t>(k + 1);
+        for (size_t i = 0; i < count; ++i) bits += fold(residual[i]) >> k;
+        if (bits < best) {
+            best = bits;
+            param = k;
+        }
+    }
+    return best;
+}
+
+// `residual` holds block_size - order values (the warm-up has none)
+RiceCoding chooseRiceCoding(const vector<int32_t>& residual, size_t block_size, int order) {
+    RiceCoding best;
+    for (int po = 0; po <= MAX_PARTITION_ORDER; ++po) {
+        size_t partitions = size_t{1} << po;
+        if (block_size % partitions != 0) break;
+        size_t partition_size = block_size >> po;
+        if (partition_size <= static_cast<size_t>(order)) break;
+
+        RiceCoding coding;
+        coding.partition_order = po;
+        coding.bits = 6;   // method + partition order
+        size_t offset = 0;
+        for (size_t p = 0; p < partitions; ++p) {
+            size_t count = p == 0 ? partition_size - order : partition_size;
+            int param = 0;
+            coding.bits += 4 + partitionBits(residual.data() + offset, count, param);
+            coding.params.push_back(param);
+            offset += count;
+        }
+        if (coding.bits < best.bits) best = std::move(coding);
+    }
+    return best;
+}
+
+void writeResidual(BitWriter& out, const vector<int32_t>& residual, size_t block_size,
+                   int order, const RiceCoding& coding) {
+    out.write(0, 2);   // 4-bit Rice parameters
+    out.write(coding.partition_order, 4);
+    size_t partition_size = block_size >> coding.partition_order;
+    size_t offset = 0;
+    for (size_t p = 0; p < coding.params.size(); ++p) {
+        size_t count = p == 0 ? partition_size - order : partition_size;
+        out.write(coding.params[p], 4);
+        for (size_t i = 0; i < count; ++i) out.writeRice(residual[offset + i], coding.params[p]);
+        offset += count;
+    }
+}
+
+// ============================================================================
+// Subframes
+// ============================================================================
+
+enum class SubframeType { Constant, Verbatim, Fixed, Lpc };
+
+struct Subframe {
+    SubframeType type = SubframeType::Verbatim;
+    int order = 0;
+    int shift = 0;
+    vector<int32_t> coefs;
+    vector<int32_t> residual;
+    RiceCoding coding;
+    uint64_t bits = std::numeric_limits<uint64_t>::max();
+};
+
+void fixedResidual(const int32_t* x, size_t n, int order, vector<int32_t>& residual) {
+    residual.resize(n - order);
+    for (size_t i = order; i < n; ++i) {
+        int64_t r = 0;
+        switch (order) {
+            case 0: r = x[i]; break;
+            case 1: r = int64_t{x[i]} - x[i - 1]; break;
+            case 2: r = int64_t{x[i]} - 2 * int64_t{x[i - 1]} + x[i - 2]; break;
+            case 3: r = int64_t{x[i]} - 3 * int64_t{x[i - 1]} + 3 * int64_t{x[i - 2]} - x[i - 3]; break;
+            case 4: r = int64_t{x[i]} - 4 * int64_t{x[i - 1]} + 6 * int64_t{x[i - 2]} - 4 * int64_t{x[i - 3]} + x[i - 4]; break;
+        }
+        residual[i - order] = static_cast<int32_t>(r);
+    }
+}
+
+// Levinson-Durbin over a Tukey-windowed autocorrelation; lpc[o - 1] holds
+// the order-o predictor x[i] ~ sum(a[j] * x[i - 1 - j]) and err[o - 1] its error
+void computeLpc(const int32_t* x, size_t n, int max_order,
+                vector<vector<double>>& lpc, vector<double>& err) {
+    vector<double> windowed(n);
+    size_t taper = n / 4;
+    for (size_t i = 0; i < n; ++i) {
+        double w = 1.0;
+        if (i < taper) w = 0.5 - 0.5 * std::cos(M_PI * i / taper);
+        else if (i >= n - taper) w = 0.5 - 0.5 * std::cos(M_PI * (n - 1 - i) / taper);
+        windowed[i] = x[i] * w;
+    }
+
+    vector<double> r(max_order + 1, 0.0);
+    for (int lag = 0; lag <= max_order; ++lag) {
+        for (size_t i = lag; i < n; ++i) r[lag] += windowed[i] * windowed[i - lag];
+    }
+
+    lpc.clear();
+    err.clear();
+    if (r[0] <= 0.0) return;
+
+    vector<double> a;
+    double error = r[0];
+    for (int i = 0; i < max_order; ++i) {
+        double acc = r[i + 1];
+        for (int j = 0; j < i; ++j) acc -= a[j] * r[i - j];
+        double k = acc / error;
+
+        vector<double> next(i + 1);
+        for (int j = 0; j < i; ++j) next[j] = a[j] - k * a[i - 1 - j];
+        next[i] = k;
+        a = std::move(next);
+        error *= (1.0 - k * k);
+        if (error <= 0.0) error = 1e-12;
+
+        lpc.push_back(a);
+        err.push_back(error);
+    }
+}
+
+// Quantises with error feedback; false if the coefficients cannot be represented
+bool quantizeLpc(const vector<double>& lpc, vector<int32_t>& coefs, int& shift) {
+    double cmax = 0.0;
+    for (double c : lpc) cmax = std::max(cmax, std::abs(c));
+    if (cmax <= 0.0) return false;
+
+    int log2cmax = 0;
+    std::frexp(cmax, &log2cmax);
+    int precision = LPC_PRECISION - 1;
+    shift = std::min(precision - log2cmax, 15);
+    if (shift < 0) return false;
+
+    const int32_t qmax = (1 << precision) - 1;
+    const int32_t qmin = -(1 << precision);
+    coefs.resize(lpc.size());
+    double error = 0.0;
+    for (size_t i = 0; i < lpc.size(); ++i) {
+        error += lpc[i] * (1 << shift);
+        int32_t q = static_cast<int32_t>(std::lround(error));
+        q = std::clamp(q, qmin, qmax);
+        coefs[i] = q;
+        error -= q;
+    }
+    return true;
+}
+
+void lpcResidual(const int32_t* x, size_t n, const vector<int32_t>& coefs, int shift,
+                 vector<int32_t>& residual) {
+    int order = static_cast<int>(coefs.size());
+    residual.resize(n - order);
+    for (size_t i = order; i < n; ++i) {
+        int64_t prediction = 0;
+        for (int j = 0; j < order; ++j) prediction += int64_t{coefs[j]} * x[i - 1 - j];
+        residual[i - order] = static_cast<int32_t>(x[i] - (prediction >> shift));
+    }
+}
+
+Subframe chooseSubframe(const int32_t* x, size_t n, int bps) {
+    Subframe best;
+    best.bits = 8 + static_cast<uint64_t>(n) * bps;   // verbatim
+
+    if (std::all_of(x, x + n, [&](int32_t s) { return s == x[0]; })) {
+        best.type = SubframeType::Constant;
+        best.bits = 8 + bps;
+        return best;
+    }
+
+    // Fixed: pick the order by residual magnitude, then cost it exactly
+    int fixed_order = 0;
+    uint64_t fixed_sum = std::numeric_limits<uint64_t>::max();
+    vector<int32_t> residual;
+    for (int order = 0; order <= 4 && static_cast<size_t>(order) < n; ++order) {
+        fixedResidual(x, n, order, residual);
+        uint64_t sum = 0;
+        for (int32_t r : residual) sum += static_cast<uint64_t>(std::abs(int64_t{r}));
+        if (sum < fixed_sum) {
+            fixed_sum = sum;
+            fixed_order = order;
+        }
+    }
+
+    Subframe fixed;
+    fixed.type = SubframeType::Fixed;
+    fixed.order = fixed_order;
+    fixedResidual(x, n, fixed_order, fixed.residual);
+    fixed.coding = chooseRiceCoding(fixed.residual, n, fixed_order);
+    fixed.bits = 8 + static_cast<uint64_t>(fixed_order) * bps + fixed.coding.bits;
+    if (fixed.bits < best.bits) best = std::move(fixed);
+
+    // LPC: pick the order from the Levinson error estimate, then cost it exactly
+    int max_order = static_cast<int>(std::min<size_t>(MAX_LPC_ORDER, n / 2));
+    vector<vector<double>> lpc;
+    vector<double> err;
+    computeLpc(x, n, max_order, lpc, err);
+
+    int lpc_order = 0;
+    double lpc_estimate = std::numeric_limits<double>::max();
+    for (size_t o = 0; o < lpc.size(); ++o) {
+        int order = static_cast<int>(o) + 1;
+        double bits_per_sample = std::max(0.0, 0.5 * std::log2(err[o] / n));
+        double estimate = bits_per_sample * (n - order) + order * (LPC_PRECISION + bps);
+        if (estimate < lpc_estimate) {
+            lpc_estimate = estimate;
+            lpc_order = order;
+        }
+    }
+
+    Subframe predicted;
+    if (lpc_order > 0 && quantizeLpc(lpc[lpc_order - 1], predicted.coefs, predicted.shift)) {
+        predicted.type = SubframeType::Lpc;
+        predicted.order = lpc_order;
+        lpcResidual(x, n, predicted.coefs, predicted.shift, predicted.residual);
+        predicted.coding = chooseRiceCoding(predicted.residual, n, lpc_order);
+        predicted.bits = 8 + static_cast<uint64_t>(lpc_order) * bps + 4 + 5 +
+                         static_cast<uint64_t>(lpc_order) * LPC_PRECISION + predicted.coding.bits;
+        if (predicted.bits < best.bits) best = std::move(predicted);
+    }
+
+    return best;
+}
+
+void writeSubframe(BitWriter& out, const Subframe& sub, const int32_t* x, size_t n, int bps) {
+    out.write(0, 1);
+    switch (sub.type) {
+        case SubframeType::Constant:
+            out.write(0x00, 6);
+            out.write(0, 1);
+            out.writeSigned(x[0], bps);
+            break;
+
+        case SubframeType::Verbatim:
+            out.write(0x01, 6);
+            out.write(0, 1);
+            for (size_t i = 0; i < n; ++i) out.writeSigned(x[i], bps);
+            break;
+
+        case SubframeType::Fixed:
+            out.write(0x08 | sub.order, 6);
+            out.write(0, 1);
+            for (int i = 0; i < sub.order; ++i) out.writeSigned(x[i], bps);
+            writeResidual(out, sub.residual, n, sub.order, sub.coding);
+            break;
+
+        case SubframeType::Lpc:
+            out.write(0x20 | (sub.order - 1), 6);
+            out.write(0, 1);
+            for (int i = 0; i < sub.order; ++i) out.writeSigned(x[i], bps);
+            out.write(LPC_PRECISION - 1, 4);
+            out.writeSigned(sub.shift, 5);
+            for (int32_t c : sub.coefs) out.writeSigned(c, LPC_PRECISION);
+            writeResidual(out, sub.residual, n, sub.order, sub.coding);
+            break;
+    }
+}
+
+// ============================================================================
+// Frames
+// ============================================================================
+
+int blockSizeCode(size_t block_size) {
+    switch (block_size) {
+        case 192: return 0x1;
+        case 576: return 0x2;
+        case 1152: return 0x3;
+        case 2304: return 0x4;
+        case 4608: return 0x5;
+        case 256: return 0x8;
+        case 512: return 0x9;
+        case 1024: return 0xA;
+        case 2048: return 0xB;
+        case 4096: return 0xC;
+        case 8192: return 0xD;
+        case 16384: return 0xE;
+        case 32768: return 0xF;
+    }
+    return block_size <= 256 ? 0x6 : 0x7;   // size follows the header
+}
+
+int sampleRateCode(uint32_t sample_rate) {
+    switch (sample_rate) {
+        case 88200: return 0x1;
+        case 176400: return 0x2;
+        case 192000: return 0x3;
+        case 8000: return 0x4;
+        case 16000: return 0x5;
+        case 22050: return 0x6;
+        case 24000: return 0x7;
+        case 32000: return 0x8;
+        case 44100: return 0x9;
+        case 48000: return 0xA;
+        case 96000: return 0xB;
+    }
+    return 0x0;   // from STREAMINFO
+}
+
+void writeUtf8(BitWriter& out, uint64_t value) {
+    if (value < 0x80) {
+        out.write(static_cast<uint32_t>(value), 8);
+        return;
+    }
+    int extra = value < 0x800 ? 1 : value < 0x10000 ? 2 : value < 0x200000 ? 3 :
+                value < 0x4000000 ? 4 : value < 0x80000000 ? 5 : 6;
+    uint32_t lead_mask = (0xFF00u >> (extra + 1)) & 0xFF;
+    out.write(lead_mask | static_cast<uint32_t>(value >> (6 * extra)), 8);
+    for (int i = extra - 1; i >= 0; --i) {
+        out.write(0x80 | static_cast<uint32_t>((value >> (6 * i)) & 0x3F), 8);
+    }
+}
+
+vector<uint8_t> encodeFrame(const int16_t* interleaved, size_t block_size, uint16_t channels,
+                            uint32_t sample_rate, uint64_t frame_number) {
+    vector<vector<int32_t>> data(channels, vector<int32_t>(block_size));
+    for (size_t i = 0; i < block_size; ++i) {
+        for (uint16_t c = 0; c < channels; ++c) data[c][i] = interleaved[i * channels + c];
+    }
+
+    // Channel assignment and the subframes that go with it
+    int assignment = channels - 1;
+    vector<const int32_t*> sources;
+    vector<int> depths;
+    vector<Subframe> subframes;
+
+    if (channels == 2) {
+        vector<int32_t> mid(block_size), side(block_size);
+        for (size_t i = 0; i < block_size; ++i) {
+            side[i] = data[0][i] - data[1][i];
+            mid[i] = (data[0][i] + data[1][i]) >> 1;
+        }
+        Subframe left = chooseSubframe(data[0].data(), block_size, BITS_PER_SAMPLE);
+        Subframe right = chooseSubframe(data[1].data(), block_size, BITS_PER_SAMPLE);
+        Subframe m = chooseSubframe(mid.data(), block_size, BITS_PER_SAMPLE);
+        Subframe s = chooseSubframe(side.data(), block_size, BITS_PER_SAMPLE + 1);
+
+        uint64_t costs[4] = {left.bits + right.bits, left.bits + s.bits, s.bits + right.bits, m.bits + s.bits};
+        int choice = static_cast<int>(std::min_element(costs, costs + 4) - costs);
+
+        data.push_back(std::move(mid));
+        data.push_back(std::move(side));
+        const int32_t* L = data[0].data();
+        const int32_t* R = data[1].data();
+        const int32_t* M = data[2].data();
+        const int32_t* S = data[3].data();
+        const int B = BITS_PER_SAMPLE;
+
+        switch (choice) {
+            case 0: assignment = 0x1; sources = {L, R}; depths = {B, B};     subframes = {std::move(left), std::move(right)}; break;
+            case 1: assignment = 0x8; sources = {L, S}; depths = {B, B + 1}; subframes = {std::move(left), std::move(s)}; break;
+            case 2: assignment = 0x9; sources = {S, R}; depths = {B + 1, B}; subframes = {std::move(s), std::move(right)}; break;
+            default: assignment = 0xA; sources = {M, S}; depths = {B, B + 1}; subframes = {std::move(m), std::move(s)}; break;
+        }
+    } else {
+        for (uint16_t c = 0; c < channels; ++c) {
+            sources.push_back(data[c].data());
+            depths.push_back(BITS_PER_SAMPLE);
+            subframes.push_back(chooseSubframe(data[c].data(), block_size, BITS_PER_SAMPLE));
+        }
+    }
+
+    BitWriter out;
+    out.write(0xFFF8, 16);   // sync, fixed block size
+    int bs_code = blockSizeCode(block_size);
+    out.write(bs_code, 4);
+    out.write(sampleRateCode(sample_rate), 4);
+    out.write(assignment, 4);
+    out.write(0x4, 3);       // 16 bits per sample
+    out.write(0, 1);
+    writeUtf8(out, frame_number);
+    if (bs_code == 0x6) out.write(static_cast<uint32_t>(block_size - 1), 8);
+    if (bs_code == 0x7) out.write(static_cast<uint32_t>(block_size - 1), 16);
+    out.write(crc8(out.bytes().data(), out.bytes().size()), 8);
+
+    for (size_t c = 0; c < subframes.size(); ++c) {
+        writeSubframe(out, subframes[c], sources[c], block_size, depths[c]);
+    }
+
+    out.alignToByte();
+    out.write(crc16(out.bytes().data(), out.bytes().size()), 16);
+    return std::move(out.bytes());
+}
+
+} // namespace
+
+// ============================================================================
+// FlacWriter
+// ============================================================================
+
+FlacWriter::FlacWriter(const std::string& filename, uint32_t sample_rate, uint16_t channels, int threads)
+    : file_(std::fopen(filename.c_str(), "wb")),
+      sample_rate_(sample_rate),
+      channels_(channels),
+      threads_(threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+      frame_number_(0),
+      total_samples_(0),
+      min_frame_bytes_(std::numeric_limits<uint32_t>::max()),
+      max_frame_bytes_(0),
+      bytes_written_(0) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create file: " + filename);
+    }
+    if (channels_ == 0 || channels_ > 8) {
+        std::fclose(file_);
+        throw std::runtime_error("FLAC supports 1 to 8 channels");
+    }
+
+    pending_.reserve(batchSamples());
+    writeStreamInfo();   // placeholder, completed in close()
+}
+
+FlacWriter::~FlacWriter() {
+    close();
+}
+
+void FlacWriter::write(const int16_t* samples, size_t count) {
+    const size_t batch = batchSamples();
+    while (count > 0) {
+        size_t take = std::min(count, batch - pending_.size());
+        pending_.insert(pending_.end(), samples, samples + take);
+        samples += take;
+        count -= take;
+        if (pending_.size() == batch) {
+            encodeBatch(pending_.size() / channels_);
+        }
+    }
+}
+
+void FlacWriter::close() {
+    if (!file_) return;
+
+    if (!pending_.empty()) {
+        encodeBatch(pending_.size() / channels_);
+    }
+    writeStreamInfo();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+// Encodes `frames` samples per channel from the front of pending_
+void FlacWriter::encodeBatch(size_t frames) {
+    size_t blocks = (frames + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    vector<vector<uint8_t>> encoded(blocks);
+
+    auto encodeBlocks = [&](size_t first) {
+        for (size_t b = first; b < blocks; b += threads_) {
+            size_t start = b * BLOCK_SIZE;
+            size_t size = std::min(BLOCK_SIZE, frames - start);
+            encoded[b] = encodeFrame(pending_.data() + start * channels_, size, channels_,
+                                     sample_rate_, frame_number_ + b);
+        }
+    };
+
+    size_t workers = std::min<size_t>(threads_, blocks);
+    vector<std::thread> pool;
+    for (size_t t = 1; t < workers; ++t) pool.emplace_back(encodeBlocks, t);
+    encodeBlocks(0);
+    for (auto& thread : pool) thread.join();
+
+    for (const auto& frame : encoded) {
+        std::fwrite(frame.data(), 1, frame.size(), file_);
+        bytes_written_ += frame.size();
+        min_frame_bytes_ = std::min(min_frame_bytes_, static_cast<uint32_t>(frame.size()));
+        max_frame_bytes_ = std::max(max_frame_bytes_, static_cast<uint32_t>(frame.size()));
+    }
+
+    frame_number_ += blocks;
+    total_samples_ += frames;
+    pending_.erase(pending_.begin(), pending_.begin() + frames * channels_);
+}
+
+void FlacWriter::writeStreamInfo() {
+    BitWriter out;
+    out.write('f', 8);
+    out.write('L', 8);
+    out.write('a', 8);
+    out.write('C', 8);
+    out.write(0x80, 8);    // last metadata block, STREAMINFO
+    out.write(34, 24);
+
+    // A stream shorter than one block is all last block
+    uint32_t block_size = static_cast<uint32_t>(std::min<uint64_t>(BLOCK_SIZE, std::max<uint64_t>(16, total_samples_)));
+    out.write(block_size, 16);
+    out.write(block_size, 16);
+    out.write(max_frame_bytes_ ? min_frame_bytes_ : 0, 24);
+    out.write(max_frame_bytes_, 24);
+    out.write(sample_rate_, 20);
+    out.write(channels_ - 1, 3);
+    out.write(BITS_PER_SAMPLE - 1, 5);
+    out.write(static_cast<uint32_t>(total_samples_ >> 32), 4);
+    out.write(static_cast<uint32_t>(total_samples_), 32);
+    for (int i = 0; i < 4; ++i) out.write(0, 32);   // MD5 not computed
+
+    long position = std::ftell(file_);
+    if (position > 0) std::fseek(file_, 0, SEEK_SET);
+    std::fwrite(out.bytes().data(), 1, out.bytes().size(), file_);
+    if (position > 0) std::fseek(file_, position, SEEK_SET);
+    else bytes_written_ += out.bytes().size();
+}
@@ -0,0 +1,128 @@
+#include "Utils/LatencyTuner.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+static const double STABLE_SECONDS = 10.0;     // quiet period before shrinking
+static const double FALLBACK_LATENCY = 0.01;   // when the backend reports no minimum
+
+LatencyTuner::LatencyTuner(unsigned int sample_rate, int hop_size, size_t max_fill)
+    : sample_rate_(sample_rate),
+      hop_size_(static_cast<size_t>(hop_size)),
+      max_fill_(max_fill),
+      algorithmic_samples_(0),
+      processing_window_{},
+      processing_index_(0),
+      processing_mean_ms_(0.0f),
+      processing_jitter_ms_(0.0f),
+      input_latency_s_(0.0f),
+      target_fill_(static_cast<size_t>(hop_size)),
+      output_latency_s_(0.0f),
+      underruns_(0),
+      samples_since_change_(0) {
+}
+
+double LatencyTuner::negotiate(const SoundIoDevice* device) const {
+    double hop_s = static_cast<double>(hop_size_) / sample_rate_;
+    double wanted = device && device->software_latency_min > 0.0 ? device->software_latency_min : FALLBACK_LATENCY;
+
+    // Whole hops, so device periods and model frames line up
+    double latency = std::ceil(wanted / hop_s - 1e-9) * hop_s;
+
+    if (device && device->software_latency_max > 0.0) {
+        latency = std::min(latency, device->software_latency_max);
+    }
+    return latency;
+}
+
+void LatencyTuner::reset() {
+    processing_window_.fill(0.0f);
+    processing_index_ = 0;
+    processing_mean_ms_ = 0.0f;
+    processing_jitter_ms_ = 0.0f;
+    target_fill_ = hop_size_;
+    underruns_ = 0;
+    samples_since_change_ = 0;
+}
+
+void LatencyTuner::onProcessingTime(double ms) {
+    processing_window_[processing_index_ % JITTER_WINDOW] = static_cast<float>(ms);
+    processing_index_++;
+
+    // Cheap enough at one update per 10 ms frame
+    size_t n = std::min(processing_index_, JITTER_WINDOW);
+    float sum = 0.0f;
+    float lo = processing_window_[0];
+    float hi = processing_window_[0];
+    for (size_t i = 0; i < n; ++i) {
+        sum += processing_window_[i];
+        lo = std::min(lo, processing_window_[i]);
+        hi = std::max(hi, processing_window_[i]);
+    }
+
+    processing_mean_ms_.store(sum / n, std::memory_order_relaxed);
+    processing_jitter_ms_.store(hi - lo, std::memory_order_relaxed);
+}
+
+void LatencyTuner::setInputLatency(double seconds) {
+    input_latency_s_.store(static_cast<float>(seconds), std::memory_order_relaxed);
+}
+
+void LatencyTuner::setOutputLatency(double seconds) {
+    output_latency_s_.store(static_cast<float>(seconds), std::memory_order_relaxed);
+}
+
+size_t LatencyTuner::jitterFill() const {
+    // Cushion must cover the spread of processing times, in whole hops
+    double jitter_samples = processing_jitter_ms_.load(std::memory_order_relaxed) * sample_rate_ / 1000.0;
+    size_t hops = static_cast<size_t>(std::ceil(jitter_samples / hop_size_));
+    return std::max<size_t>(1, hops) * hop_size_;
+}
+
+void LatencyTuner::onUnderrun() {
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+    size_t target = std::min(target_fill_.load(std::memory_order_relaxed) + hop_size_, max_fill_);
+    target_fill_.store(std::max(target, jitterFill()), std::memory_order_relaxed);
+    samples_since_change_ = 0;
+}
+
+void LatencyTuner::onPlayed(size_t samples) {
+    samples_since_change_ += samples;
+
+    size_t floor = std::min(jitterFill(), max_fill_);
+    size_t target = target_fill_.load(std::memory_order_relaxed);
+
+    if (target < floor) {
+        target_fill_.store(floor, std::memory_order_relaxed);
+        samples_since_change_ = 0;
+    } else if (samples_since_change_ >= STABLE_SECONDS * sample_rate_ && target > floor) {
+        target_fill_.store(std::max(floor, target - hop_size_), std::memory_order_relaxed);
+        samples_since_change_ = 0;
+    }
+}
+
+LatencyReport LatencyTuner::report() const {
+    double to_ms = 1000.0 / sample_rate_;
+
+    LatencyReport r;
+    r.input_device_ms = input_latency_s_.load(std::memory_order_relaxed) * 1000.0;
+    r.framing_ms = hop_size_ * to_ms;
+    r.algorithmic_ms = algorithmic_samples_ * to_ms;
+    r.processing_ms = processing_mean_ms_.load(std::memory_order_relaxed);
+    r.ring_ms = targetFill() * to_ms;
+    r.output_device_ms = output_latency_s_.load(std::memory_order_relaxed) * 1000.0;
+    return r;
+}
+
+void LatencyTuner::printReport(const char* title) const {
+    LatencyReport r = report();
+    std::cout << "\n" << title << ":\n";
+    std::cout << "  Input device:  " << r.input_device_ms << " ms\n";
+    std::cout << "  Framing:       " << r.framing_ms << " ms\n";
+    std::cout << "  Model delay:   " << r.algorithmic_ms << " ms\n";
+    std::cout << "  Processing:    " << r.processing_ms << " ms (jitter "
+              << processing_jitter_ms_.load(std::memory_order_relaxed) << " ms)\n";
+    std::cout << "  Output ring:   " << r.ring_ms << " ms (" << underruns_.load() << " underruns)\n";
+    std::cout << "  Output device: " << r.output_device_ms << " ms\n";
+    std::cout << "  Mouth-to-ear:  " << r.total() << " ms\n";
+}
@@ -0,0 +1,70 @@
+#include "Utils/MemoryStats.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+using std::cout;
+using std::string;
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages_total = 0;
+    size_t pages_resident = 0;
+    if (!(statm >> pages_total >> pages_resident)) return 0;
+    return pages_resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+size_t peakResidentBytes() {
+    std::ifstream status("/proc/self/status");
+    for (string line; std::getline(status, line);) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            std::istringstream fields(line.substr(6));
+            size_t kb = 0;
+            fields >> kb;
+            return kb * 1024;
+        }
+    }
+    return 0;
+}
+
+static double toMiB(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void MemoryReport::add(const string& item, size_t bytes, bool measured) {
+    items_.push_back({item, bytes, measured});
+}
+
+void MemoryReport::print(const char* title) const {
+    size_t accounted = 0;
+    cout << "\n=== " << title << " ===\n";
+    cout.precision(2);
+    cout << std::fixed;
+    for (const auto& item : items_) {
+        cout << "  " << item.name << ": " << toMiB(item.bytes) << " MiB"
+             << (item.measured ? " (measured)" : "") << "\n";
+        accounted += item.bytes;
+    }
+
+    size_t rss = residentBytes();
+    cout << "  Unattributed: " << toMiB(rss > accounted ? rss - accounted : 0) << " MiB\n";
+    cout << "  Resident total: " << toMiB(rss) << " MiB (peak " << toMiB(peakResidentBytes()) << " MiB)\n";
+    cout << std::defaultfloat;
+    cout.precision(6);
+}
+
+string MemoryReport::summary() const {
+    std::ostringstream out;
+    out.precision(2);
+    out << std::fixed;
+    for (const auto& item : items_) {
+        string key = item.name;
+        for (char& c : key) {
+            if (c == ' ') c = '_';
+        }
+        out << key << "_mib " << toMiB(item.bytes) << " ";
+    }
+    out << "rss_mib " << toMiB(residentBytes()) << " peak_mib " << toMiB(peakResidentBytes());
+    return out.str();
+}
@@ -1,4 +1,7 @@
 #include "Utils/MicReader.h"
+#include "Utils/ShmRing.h"
+#include "Utils/AllocTracker.h"
+#include "Utils/Tracer.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
@@ -9,6 +12,26 @@
 
 static volatile bool keep_running = true;
 
+static const int FADE_SAMPLES = 48;               // 1 ms crossfade at every discontinuity
+static const size_t REALIGN_SLACK = 3 * 480;      // fill above target that triggers a re-align
+static const float CONCEAL_DECAY = 0.99990f;      // ~-40 dB after 100 ms of concealment
+
+static uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* xrunName(XrunType type) {
+    switch (type) {
+        case XrunType::InputOverflow:   return "input overflow";
+        case XrunType::OutputUnderflow: return "output underflow";
+        case XrunType::RingOverrun:     return "ring overrun";
+        case XrunType::RingUnderrun:    return "ring underrun";
+        case XrunType::Realign:         return "realign";
+    }
+    return "unknown";
+}
+
 void signal_handler(int) {
     keep_running = false;
 }
@@ -22,11 +45,38 @@ MicrophoneReader::MicrophoneReader()
       selected_device_index_(-1),
       selected_playback_index_(-1),
       monitor_enabled_(false),
+      monitor_gain_(0.0f),
       audio_callback_(nullptr),
       write_pos_(0),
       read_pos_(0),
       samples_available_(0),
-      running_(false) {
+      running_(false),
+      process_buffer_(frame_size_, 0),
+      process_fill_(0),
+      xrun_log_count_(0),
+      input_overflows_(0),
+      output_underflows_(0),
+      ring_overruns_(0),
+      ring_underruns_(0),
+      realigns_(0),
+      concealed_samples_(0),
+      dropped_samples_(0),
+      latency_tuner_(sample_rate_, frame_size_, 4800),
+      latency_poll_counter_(0),
+      output_poll_counter_(0),
+      playing_(false),
+      output_history_(frame_size_, 0.0f),
+      history_pos_(0),
+      conceal_pos_(0),
+      conceal_gain_(0.0f),
+      output_primed_(false),
+      concealing_(false),
+      gap_samples_(0),
+      fade_in_remaining_(0),
+      xfade_from_pos_(0),
+      xfade_remaining_(0),
+      input_fade_remaining_(0),
+      last_input_sample_(0) {
     
     std::signal(SIGINT, signal_handler);
     keep_running = true;
@@ -163,18 +213,29 @@ bool MicrophoneReader::selectPlaybackDevice(const std::string& display_name) {
 }
 
 void MicrophoneReader::setMonitorEnabled(bool enabled) {
-    monitor_enabled_ = enabled;
+    monitor_enabled_.store(enabled, std::memory_order_relaxed);
 }
 
 void MicrophoneReader::setAudioCallback(AudioCallback callback) {
     audio_callback_ = callback;
 }
 
+bool MicrophoneReader::setSharedOutput(const std::string& name, uint32_t slot_count) {
+    auto writer = std::make_unique<ShmRingWriter>();
+    if (!writer->create(name, sample_rate_, frame_size_, slot_count)) {
+        return false;
+    }
+    shared_output_ = std::move(writer);
+    return true;
+}
+
 void MicrophoneReader::readCallback(SoundIoInStream* instream, int frame_count_min, int frame_count_max) {
+    RealtimeScope realtime("MicrophoneReader::readCallback");
+    Tracer::instance().setThreadName("capture");
+    TraceScope trace("readCallback", static_cast<uint32_t>(frame_count_max));
     MicrophoneReader* self = static_cast<MicrophoneReader*>(instream->userdata);
     if (!self || !self->running_) return;
     
-    const int FRAME_SIZE = 480;
     int frames_left = frame_count_max;
     
     while (frames_left > 0) {
@@ -194,7 +255,20 @@ void MicrophoneReader::readCallback(SoundIoInStream* instream, int frame_count_m
             for (int frame = 0; frame < frame_count; frame++) {
                 float sample = *reinterpret_cast<float*>(areas[0].ptr + frame * areas[0].step);
                 int16_t int_sample = static_cast<int16_t>(std::clamp(sample * 32767.0f, -32768.0f, 32767.0f));
-                self->process_buffer_.push_back(int_sample);
+                
+                // Bridge the jump after captured data was lost
+                if (self->input_fade_remaining_ > 0) {
+                    float w = 1.0f - static_cast<float>(self->input_fade_remaining_) / FADE_SAMPLES;
+                    int_sample = static_cast<int16_t>(self->last_input_sample_ * (1.0f - w) + int_sample * w);
+                    self->input_fade_remaining_--;
+                }
+                self->last_input_sample_ = int_sample;
+                self->process_buffer_[self->process_fill_++] = int_sample;
+                
+                if (self->process_fill_ == self->process_buffer_.size()) {
+                    self->processFrame();
+                    self->process_fill_ = 0;
+                }
             }
         }
         
@@ -202,56 +276,109 @@ void MicrophoneReader::readCallback(SoundIoInStream* instream, int frame_count_m
         frames_left -= frame_count;
     }
     
-    // Process complete 480-sample frames
-    while (self->process_buffer_.size() >= FRAME_SIZE) {
-        // Extract exactly FRAME_SIZE samples
-        std::vector<int16_t> chunk(self->process_buffer_.begin(), 
-                                    self->process_buffer_.begin() + FRAME_SIZE);
-        self->process_buffer_.erase(self->process_buffer_.begin(), 
-                                     self->process_buffer_.begin() + FRAME_SIZE);
+    // Device latency changes rarely; sample it about once a second
+    if (self->latency_poll_counter_++ % 100 == 0) {
+        double latency = 0.0;
+        if (soundio_instream_get_latency(instream, &latency) == 0) {
+            self->latency_tuner_.setInputLatency(latency);
+        }
+    }
+}
+
+// Runs the callback over one full hop in place and hands the result to
+// playback and shared-memory consumers. Input thread only; no allocations.
+void MicrophoneReader::processFrame() {
+    int16_t* frame = process_buffer_.data();
+    size_t count = process_buffer_.size();
+    
+    auto processing_start = std::chrono::steady_clock::now();
+    if (audio_callback_) {
+        try {
+            audio_callback_(frame, count);
+        } catch (const std::exception& e) {
+            std::cerr << "Callback error: " << e.what() << "\n";
+        }
+    }
+    double processing_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - processing_start).count();
+    latency_tuner_.onProcessingTime(processing_ms);
+    if (processing_ms > count * 1000.0 / sample_rate_) {
+        Tracer::instance().instant("hop over budget", static_cast<uint32_t>(processing_ms * 1000.0));
+        Tracer::instance().markAnomaly("hop over budget");
+    }
+    
+    // Publish to local consumers
+    if (shared_output_) {
+        shared_output_->publish(frame, count);
+    }
+    
+    // Write to ring buffer
+    if (monitor_enabled_ || outstream_) {
+        TraceScope trace("ring handoff", static_cast<uint32_t>(count));
+        size_t buffer_size = ring_buffer_.size();
         
-        // Apply denoiser callback
-        std::vector<int16_t> processed;
-        if (self->audio_callback_) {
-            try {
-                processed = self->audio_callback_(chunk);
-            } catch (const std::exception& e) {
-                std::cerr << "Callback error: " << e.what() << "\n";
-                processed = chunk;
-            }
-        } else {
-            processed = chunk;
+        // The playback side owns read_pos_; when the ring is full drop
+        // this frame instead of moving the reader under its feet
+        if (samples_available_.load(std::memory_order_acquire) + count > buffer_size) {
+            dropped_samples_.fetch_add(count, std::memory_order_relaxed);
+            recordXrun(XrunType::RingOverrun, static_cast<uint32_t>(count));
+            return;
         }
         
-        // Write to ring buffer
-        if (self->monitor_enabled_ || self->outstream_) {
-            size_t buffer_size = self->ring_buffer_.size();
-            size_t write_pos = self->write_pos_.load();
-            
-            for (size_t i = 0; i < processed.size(); i++) {
-                self->ring_buffer_[write_pos] = processed[i];
-                write_pos = (write_pos + 1) % buffer_size;
-            }
-            
-            self->write_pos_.store(write_pos);
-            self->samples_available_.fetch_add(processed.size());
-            
-            // Prevent overflow
-            size_t max_available = buffer_size - FRAME_SIZE;
-            if (self->samples_available_.load() > max_available) {
-                size_t excess = self->samples_available_.load() - max_available;
-                self->read_pos_.store((self->read_pos_.load() + excess) % buffer_size);
-                self->samples_available_.store(max_available);
-            }
+        size_t write_pos = write_pos_.load();
+        
+        // Monitor can be toggled while streaming; fade over one frame
+        float gain = monitor_gain_;
+        float target = monitor_enabled_.load(std::memory_order_relaxed) ? 1.0f : 0.0f;
+        float step = (target - gain) / static_cast<float>(count);
+        
+        for (size_t i = 0; i < count; i++) {
+            gain += step;
+            ring_buffer_[write_pos] = static_cast<int16_t>(frame[i] * gain);
+            write_pos = (write_pos + 1) % buffer_size;
         }
+        monitor_gain_ = target;
+        
+        write_pos_.store(write_pos);
+        samples_available_.fetch_add(count, std::memory_order_release);
     }
 }
 
 void MicrophoneReader::writeCallback(SoundIoOutStream* outstream, int frame_count_min, int frame_count_max) {
+    RealtimeScope realtime("MicrophoneReader::writeCallback");
+    Tracer::instance().setThreadName("playback");
+    TraceScope trace("writeCallback", static_cast<uint32_t>(frame_count_max));
     MicrophoneReader* self = static_cast<MicrophoneReader*>(outstream->userdata);
     if (!self || !self->running_) return;
     
     size_t buffer_size = self->ring_buffer_.size();
+    size_t available = self->samples_available_.load(std::memory_order_acquire);
+    size_t read_pos = self->read_pos_.load();
+    
+    size_t target_fill = self->latency_tuner_.targetFill();
+    
+    // Hold playback until the ring has its jitter cushion
+    if (!self->playing_ && available >= target_fill) {
+        self->playing_ = true;
+    }
+    
+    // After a burst the ring can sit far above target; trim back with a crossfade
+    if (self->playing_ && available > target_fill + REALIGN_SLACK && self->xfade_remaining_ == 0) {
+        size_t skip = available - target_fill;
+        self->xfade_from_pos_ = read_pos;
+        self->xfade_remaining_ = FADE_SAMPLES;
+        read_pos = (read_pos + skip) % buffer_size;
+        self->read_pos_.store(read_pos);
+        self->samples_available_.fetch_sub(skip, std::memory_order_release);
+        available -= skip;
+        self->dropped_samples_.fetch_add(skip, std::memory_order_relaxed);
+        self->recordXrun(XrunType::Realign, static_cast<uint32_t>(skip));
+    }
+    
+    if (!self->playing_) {
+        available = 0;  // still priming: conceal or stay silent
+    }
+    
     int frames_left = frame_count_max;
     
     while (frames_left > 0) {
@@ -266,43 +393,220 @@ void MicrophoneReader::writeCallback(SoundIoOutStream* outstream, int frame_coun
         
         if (frame_count == 0) break;
         
-        size_t available = self->samples_available_.load();
-        size_t read_pos = self->read_pos_.load();
+        size_t consumed = 0;
+        size_t concealed = 0;
         
         for (int frame = 0; frame < frame_count; frame++) {
             float float_sample = 0.0f;
             
-            if (available > 0) {
-                int16_t sample = self->ring_buffer_[read_pos];
+            if (consumed < available) {
+                float_sample = static_cast<float>(self->ring_buffer_[read_pos]) / 32767.0f;
                 read_pos = (read_pos + 1) % buffer_size;
-                float_sample = static_cast<float>(sample) / 32767.0f;
-                available--;
+                consumed++;
+                
+                if (self->xfade_remaining_ > 0) {
+                    float w = 1.0f - static_cast<float>(self->xfade_remaining_) / FADE_SAMPLES;
+                    float skipped = static_cast<float>(self->ring_buffer_[self->xfade_from_pos_]) / 32767.0f;
+                    self->xfade_from_pos_ = (self->xfade_from_pos_ + 1) % buffer_size;
+                    float_sample = skipped * (1.0f - w) + float_sample * w;
+                    self->xfade_remaining_--;
+                }
+                
+                if (self->concealing_) {
+                    // Data is back: log the gap and fade out of the concealment
+                    self->concealing_ = false;
+                    self->fade_in_remaining_ = FADE_SAMPLES;
+                    self->recordXrun(XrunType::RingUnderrun, self->gap_samples_);
+                    self->gap_samples_ = 0;
+                }
+                
+                if (self->fade_in_remaining_ > 0) {
+                    float w = 1.0f - static_cast<float>(self->fade_in_remaining_) / FADE_SAMPLES;
+                    float_sample = self->concealSample() * (1.0f - w) + float_sample * w;
+                    self->fade_in_remaining_--;
+                }
+                
+                self->output_history_[self->history_pos_] = float_sample;
+                self->history_pos_ = (self->history_pos_ + 1) % self->output_history_.size();
+                self->output_primed_ = true;
+            } 
+            else if (self->output_primed_) {
+                // Starved: replay the last frame with a decaying envelope
+                if (!self->concealing_) {
+                    self->concealing_ = true;
+                    self->conceal_pos_ = self->history_pos_;
+                    self->conceal_gain_ = 1.0f;
+                    
+                    // Grow the cushion and re-prime before resuming
+                    self->latency_tuner_.onUnderrun();
+                    self->playing_ = false;
+                }
+                float_sample = self->concealSample();
+                self->gap_samples_++;
+                concealed++;
             }
             
             *reinterpret_cast<float*>(areas[0].ptr + frame * areas[0].step) = float_sample;
         }
         
         self->read_pos_.store(read_pos);
-        
-        size_t old_available = self->samples_available_.load();
-        size_t consumed = old_available - available;
-        if (consumed > 0 && old_available >= consumed) {
-            self->samples_available_.fetch_sub(consumed);
+        if (concealed > 0) {
+            self->concealed_samples_.fetch_add(concealed, std::memory_order_relaxed);
+        }
+        if (consumed > 0) {
+            self->samples_available_.fetch_sub(consumed, std::memory_order_release);
+            available -= consumed;
         }
         
         soundio_outstream_end_write(outstream);
         frames_left -= frame_count;
     }
+    
+    self->latency_tuner_.onPlayed(static_cast<size_t>(frame_count_max - frames_left));
+    
+    if (self->output_poll_counter_++ % 100 == 0) {
+        double latency = 0.0;
+        if (soundio_outstream_get_latency(outstream, &latency) == 0) {
+            self->latency_tuner_.setOutputLatency(latency);
+        }
+    }
+}
+
+float MicrophoneReader::concealSample() {
+    float sample = output_history_[conceal_pos_] * conceal_gain_;
+    conceal_pos_ = (conceal_pos_ + 1) % output_history_.size();
+    conceal_gain_ *= CONCEAL_DECAY;
+    return sample;
 }
 
 void MicrophoneReader::underflowCallback(SoundIoOutStream* outstream) {
-    // Silent - underflows expected during startup
+    MicrophoneReader* self = static_cast<MicrophoneReader*>(outstream->userdata);
+    // Underflows before the first real frame are expected during startup
+    if (self && self->output_primed_) {
+        self->recordXrun(XrunType::OutputUnderflow, 0);
+    }
 }
 
 void MicrophoneReader::overflowCallback(SoundIoInStream* instream) {
     MicrophoneReader* self = static_cast<MicrophoneReader*>(instream->userdata);
     if (self) {
-        self->process_buffer_.clear();  // Clear on overflow to prevent buildup
+        // Keep the partial frame; crossfade over the discontinuity instead
+        self->input_fade_remaining_ = FADE_SAMPLES;
+        self->recordXrun(XrunType::InputOverflow, 0);
+    }
+}
+
+void MicrophoneReader::recordXrun(XrunType type, uint32_t samples) {
+    switch (type) {
+        case XrunType::InputOverflow:   input_overflows_.fetch_add(1, std::memory_order_relaxed); break;
+        case XrunType::OutputUnderflow: output_underflows_.fetch_add(1, std::memory_order_relaxed); break;
+        case XrunType::RingOverrun:     ring_overruns_.fetch_add(1, std::memory_order_relaxed); break;
+        case XrunType::RingUnderrun:    ring_underruns_.fetch_add(1, std::memory_order_relaxed); break;
+        case XrunType::Realign:         realigns_.fetch_add(1, std::memory_order_relaxed); break;
+    }
+    
+    uint64_t index = xrun_log_count_.fetch_add(1, std::memory_order_relaxed);
+    XrunSlot& slot = xrun_log_[index % XRUN_LOG_SIZE];
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestamp_ns.store(nowNs(), std::memory_order_relaxed);
+    slot.info.store(static_cast<uint64_t>(type) << 32 | samples, std::memory_order_relaxed);
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+    Tracer::instance().instant(xrunName(type), samples);
+    Tracer::instance().markAnomaly(xrunName(type));
+}
+
+void MicrophoneReader::resetXrunState() {
+    xrun_log_count_ = 0;
+    for (XrunSlot& slot : xrun_log_) {
+        slot.seq.store(0, std::memory_order_relaxed);
+    }
+    input_overflows_ = 0;
+    output_underflows_ = 0;
+    ring_overruns_ = 0;
+    ring_underruns_ = 0;
+    realigns_ = 0;
+    concealed_samples_ = 0;
+    dropped_samples_ = 0;
+    
+    std::fill(output_history_.begin(), output_history_.end(), 0.0f);
+    history_pos_ = 0;
+    conceal_pos_ = 0;
+    conceal_gain_ = 0.0f;
+    output_primed_ = false;
+    concealing_ = false;
+    gap_samples_ = 0;
+    fade_in_remaining_ = 0;
+    xfade_remaining_ = 0;
+    playing_ = false;
+    input_fade_remaining_ = 0;
+    last_input_sample_ = 0;
+}
+
+size_t MicrophoneReader::bufferBytes() const {
+    return ring_buffer_.capacity() * sizeof(int16_t) +
+           process_buffer_.capacity() * sizeof(int16_t) +
+           output_history_.capacity() * sizeof(float);
+}
+
+XrunStats MicrophoneReader::getXrunStats() const {
+    XrunStats stats;
+    stats.input_overflows = input_overflows_.load(std::memory_order_relaxed);
+    stats.output_underflows = output_underflows_.load(std::memory_order_relaxed);
+    stats.ring_overruns = ring_overruns_.load(std::memory_order_relaxed);
+    stats.ring_underruns = ring_underruns_.load(std::memory_order_relaxed);
+    stats.realigns = realigns_.load(std::memory_order_relaxed);
+    stats.concealed_samples = concealed_samples_.load(std::memory_order_relaxed);
+    stats.dropped_samples = dropped_samples_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::vector<XrunEvent> MicrophoneReader::getXrunEvents() const {
+    uint64_t count = xrun_log_count_.load(std::memory_order_acquire);
+    uint64_t first = count > XRUN_LOG_SIZE ? count - XRUN_LOG_SIZE : 0;
+    
+    std::vector<XrunEvent> events;
+    events.reserve(count - first);
+    for (uint64_t i = first; i < count; ++i) {
+        const XrunSlot& slot = xrun_log_[i % XRUN_LOG_SIZE];
+        if (slot.seq.load(std::memory_order_acquire) != 2 * i + 2) {
+            continue;   // still being written, or already overwritten
+        }
+        uint64_t timestamp = slot.timestamp_ns.load(std::memory_order_relaxed);
+        uint64_t info = slot.info.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != 2 * i + 2) {
+            continue;
+        }
+        events.push_back(XrunEvent{timestamp, static_cast<XrunType>(info >> 32),
+                                   static_cast<uint32_t>(info)});
+    }
+    return events;
+}
+
+void MicrophoneReader::printXrunReport() const {
+    XrunStats stats = getXrunStats();
+    std::cout << "\nXrun report:\n";
+    std::cout << "  Input overflows:   " << stats.input_overflows << "\n";
+    std::cout << "  Output underflows: " << stats.output_underflows << "\n";
+    std::cout << "  Ring overruns:     " << stats.ring_overruns << "\n";
+    std::cout << "  Ring underruns:    " << stats.ring_underruns
+              << " (" << stats.concealed_samples * 1000.0 / sample_rate_ << " ms concealed)\n";
+    std::cout << "  Re-alignments:     " << stats.realigns
+              << " (" << stats.dropped_samples * 1000.0 / sample_rate_ << " ms dropped)\n";
+    
+    auto events = getXrunEvents();
+    if (events.empty()) return;
+    
+    // Show the tail of the log relative to the first event kept
+    size_t shown = std::min<size_t>(events.size(), 10);
+    uint64_t origin = events.front().timestamp_ns;
+    std::cout << "  Last " << shown << " events:\n";
+    for (size_t i = events.size() - shown; i < events.size(); ++i) {
+        std::cout << "    +" << (events[i].timestamp_ns - origin) / 1000000 << " ms  "
+                  << xrunName(events[i].type);
+        if (events[i].samples) std::cout << " (" << events[i].samples << " samples)";
+        std::cout << "\n";
     }
 }
 
@@ -343,7 +647,7 @@ bool MicrophoneReader::initialize() {
     instream_->format = SoundIoFormatFloat32LE;
     instream_->sample_rate = sample_rate_;
     instream_->layout = *soundio_channel_layout_get_builtin(SoundIoChannelLayoutIdMono);
-    instream_->software_latency = 0.02;  // 20ms
+    instream_->software_latency = latency_tuner_.negotiate(input_device_);
     instream_->read_callback = readCallback;
     instream_->overflow_callback = overflowCallback;
     instream_->userdata = this;
@@ -379,7 +683,7 @@ bool MicrophoneReader::initialize() {
         outstream_->format = SoundIoFormatFloat32LE;
         outstream_->sample_rate = sample_rate_;
         outstream_->layout = *soundio_channel_layout_get_builtin(SoundIoChannelLayoutIdMono);
-        outstream_->software_latency = 0.02;  // 20ms
+        outstream_->software_latency = latency_tuner_.negotiate(output_device_);
         outstream_->write_callback = writeCallback;
         outstream_->underflow_callback = underflowCallback;
         outstream_->userdata = this;
@@ -414,8 +718,11 @@ void MicrophoneReader::processAudio() {
     samples_available_ = 0;
     write_pos_ = 0;
     read_pos_ = 0;
-    process_buffer_.clear();
+    process_fill_ = 0;
     std::fill(ring_buffer_.begin(), ring_buffer_.end(), 0);
+    monitor_gain_ = monitor_enabled_ ? 1.0f : 0.0f;
+    resetXrunState();
+    latency_tuner_.reset();
     
     int err = soundio_instream_start(instream_);
     if (err) {
@@ -437,13 +744,24 @@ void MicrophoneReader::processAudio() {
     
     std::cout << "Processing audio... Press Ctrl+C to stop\n";
     
+    auto started = std::chrono::steady_clock::now();
+    bool latency_reported = false;
+    
     while (keep_running && running_) {
         soundio_flush_events(soundio_);
         std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        
+        // Device latencies are only known once callbacks have run
+        if (!latency_reported && std::chrono::steady_clock::now() - started > std::chrono::seconds(3)) {
+            latency_tuner_.printReport("Measured latency");
+            latency_reported = true;
+        }
     }
     
     running_ = false;
     std::cout << "\nAudio processing stopped\n";
+    latency_tuner_.printReport("Final latency");
+    printXrunReport();
 }
 
 void MicrophoneReader::cleanup() {
@@ -474,5 +792,6 @@ void MicrophoneReader::cleanup() {
         soundio_ = nullptr;
     }
     
-    process_buffer_.clear();
+    process_fill_ = 0;
+    shared_output_.reset();
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "Utils/OrtProfile.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <cstdlib>
+#include <cctype>
+
+using std::string;
+using std::vector;
+using std::cout;
+using std::cerr;
+
+// Just enough JSON for the profile: an array of flat event objects whose
+// "args" member is one more object. Numbers are kept as text.
+struct JsonValue {
+    enum Type { Null, Scalar, Object, Array } type = Null;
+    string text;
+    vector<std::pair<string, JsonValue>> members;
+    vector<JsonValue> items;
+
+    const JsonValue* get(const string& key) const {
+        for (const auto& m : members) {
+            if (m.first == key) return &m.second;
+        }
+        return nullptr;
+    }
+    string str(const string& key) const {
+        const JsonValue* v = get(key);
+        return v && v->type == Scalar ? v->text : string();
+    }
+    double num(const string& key) const {
+        string s = str(key);
+        return s.empty() ? 0.0 : std::strtod(s.c_str(), nullptr);
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const string& text) : text_(text), pos_(0) {}
+
+    bool parse(JsonValue& value) {
+        skipSpace();
+        if (pos_ >= text_.size()) return false;
+        char c = text_[pos_];
+
+        if (c == '{') {
+            value.type = JsonValue::Object;
+            ++pos_;
+            skipSpace();
+            if (peek('}')) return true;
+            do {
+                skipSpace();
+                string key;
+                if (!parseString(key)) return false;
+                skipSpace();
+                if (!peek(':')) return false;
+                value.members.emplace_back(std::move(key), JsonValue());
+                if (!parse(value.members.back().second)) return false;
+                skipSpace();
+            } while (peek(','));
+            return peek('}');
+        }
+        if (c == '[') {
+            value.type = JsonValue::Array;
+            ++pos_;
+            skipSpace();
+            if (peek(']')) return true;
+            do {
+                value.items.emplace_back();
+                if (!parse(value.items.back())) return false;
+                skipSpace();
+            } while (peek(','));
+            return peek(']');
+        }
+
+        value.type = JsonValue::Scalar;
+        if (c == '"') return parseString(value.text);
+        size_t start = pos_;
+        while (pos_ < text_.size() && string(",}] \t\r\n").find(text_[pos_]) == string::npos) ++pos_;
+        value.text = text_.substr(start, pos_ - start);
+        if (value.text == "null") value.type = JsonValue::Null;
+        return !value.text.empty();
+    }
+
+private:
+    void skipSpace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    }
+    bool peek(char c) {
+        skipSpace();
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+    // Escapes are kept as their second character; node names don't use \u
+    bool parseString(string& out) {
+        if (!peek('"')) return false;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) ++pos_;
+            out += text_[pos_++];
+        }
+        return peek('"');
+    }
+
+    const string& text_;
+    size_t pos_;
+};
+
+static void sortSlowestFirst(vector<OpTiming>& timings) {
+    std::sort(timings.begin(), timings.end(),
+              [](const OpTiming& a, const OpTiming& b) { return a.total_us > b.total_us; });
+}
+
+bool loadOrtProfile(const string& path, int skip_runs, OrtProfileSummary& summary) {
+    std::ifstream file(path);
+    if (!file) {
+        cerr << "Cannot open profile: " << path << "\n";
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    string text = buffer.str();
+
+    JsonValue root;
+    if (!JsonParser(text).parse(root) || root.type != JsonValue::Array) {
+        cerr << "Not an ONNX Runtime profile: " << path << "\n";
+        return false;
+    }
+
+    // Runs in time order; kernels are attributed to the run they fall in
+    vector<std::pair<double, double>> runs;
+    for (const JsonValue& event : root.items) {
+        if (event.str("cat") == "Session" && event.str("name") == "model_run") {
+            double ts = event.num("ts");
+            runs.emplace_back(ts, ts + event.num("dur"));
+        }
+    }
+    std::sort(runs.begin(), runs.end());
+    if (static_cast<int>(runs.size()) <= skip_runs) {
+        cerr << "Profile has " << runs.size() << " runs, nothing left after skipping " << skip_runs << "\n";
+        return false;
+    }
+    double counted_from = runs[skip_runs].first;
+
+    summary = OrtProfileSummary();
+    for (size_t r = skip_runs; r < runs.size(); ++r) {
+        summary.run_us += runs[r].second - runs[r].first;
+    }
+    summary.runs = static_cast<int>(runs.size()) - skip_runs;
+
+    const string suffix = "_kernel_time";
+    std::map<string, OpTiming> nodes;
+    std::map<string, OpTiming> op_types;
+    for (const JsonValue& event : root.items) {
+        string name = event.str("name");
+        if (event.str("cat") != "Node" || event.num("ts") < counted_from) continue;
+        if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
+        name.resize(name.size() - suffix.size());
+
+        const JsonValue* args = event.get("args");
+        string op_type = args ? args->str("op_name") : string();
+        double dur = event.num("dur");
+        uint64_t out_bytes = args ? static_cast<uint64_t>(args->num("output_size")) : 0;
+
+        for (auto* table : {&nodes, &op_types}) {
+            const string& key = (table == &nodes) ? name : op_type;
+            OpTiming& t = (*table)[key];
+            t.name = key;
+            t.op_type = op_type;
+            t.calls++;
+            t.total_us += dur;
+            t.output_bytes += out_bytes;
+        }
+        summary.kernel_us += dur;
+    }
+
+    for (auto& [name, t] : nodes) summary.nodes.push_back(t);
+    for (auto& [name, t] : op_types) summary.op_types.push_back(t);
+    sortSlowestFirst(summary.nodes);
+    sortSlowestFirst(summary.op_types);
+    return true;
+}
+
+static void printTable(const vector<OpTiming>& rows, size_t max_rows, int hops, double kernel_us, bool by_node) {
+    const double hop_budget_us = 10000.0;
+    cout << std::left << std::setw(by_node ? 40 : 24) << (by_node ? "node" : "op type")
+         << (by_node ? "op type             " : "")
+         << std::right << std::setw(8) << "calls" << std::setw(12) << "us/hop"
+         << std::setw(9) << "%kern" << std::setw(10) << "%budget" << std::setw(12) << "out KiB/hop" << "\n";
+
+    cout << std::fixed << std::setprecision(2);
+    for (size_t i = 0; i < rows.size() && i < max_rows; ++i) {
+        const OpTiming& t = rows[i];
+        double per_hop = t.total_us / hops;
+        cout << std::left << std::setw(by_node ? 40 : 24) << t.name.substr(0, by_node ? 39 : 23);
+        if (by_node) cout << std::setw(20) << t.op_type.substr(0, 19);
+        cout << std::right << std::setw(8) << t.calls
+             << std::setw(12) << per_hop
+             << std::setw(8) << (kernel_us > 0.0 ? 100.0 * t.total_us / kernel_us : 0.0) << "%"
+             << std::setw(9) << 100.0 * per_hop / hop_budget_us << "%"
+             << std::setw(12) << t.output_bytes / 1024.0 / hops << "\n";
+    }
+    if (rows.size() > max_rows) {
+        cout << "  ... " << rows.size() - max_rows << " more\n";
+    }
+    cout << std::defaultfloat;
+}
+
+void OrtProfileSummary::print(int hops, size_t max_nodes) const {
+    hops = std::max(hops, 1);
+    cout << "\n=== Operator Profile (" << runs << " runs, " << hops << " hops) ===\n";
+    cout << "  Run():   " << run_us / hops << " us/hop (" << run_us / hops / 100.0 << "% of the 10 ms budget)\n";
+    cout << "  Kernels: " << kernel_us / hops << " us/hop, framework overhead "
+         << (run_us - kernel_us) / hops << " us/hop\n\n";
+
+    printTable(op_types, op_types.size(), hops, kernel_us, false);
+    cout << "\n";
+    printTable(nodes, max_nodes, hops, kernel_us, true);
+}
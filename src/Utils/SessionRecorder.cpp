@@ -0,0 +1,242 @@
+#include "Utils/SessionRecorder.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using std::cout;
+using std::cerr;
+using std::string;
+
+static const size_t IO_BUFFER_BYTES = 1 << 20;          // stdio buffer per file
+static const auto DRAIN_INTERVAL = std::chrono::milliseconds(50);
+static const auto HEADER_INTERVAL = std::chrono::seconds(1);
+static const char* TRACK_NAMES[2] = {"raw", "denoised"};
+// RIFF and data sizes are 32-bit; the RIFF size covers the 36 header bytes too
+static const uint64_t MAX_DATA_SAMPLES = (UINT32_MAX - 36) / sizeof(int16_t);
+
+SessionRecorder::SessionRecorder()
+    : sample_rate_(0),
+      recording_(false),
+      pushes_in_flight_(0),
+      writer_running_(false) {
+}
+
+SessionRecorder::~SessionRecorder() {
+    stop();
+}
+
+bool SessionRecorder::start(const string& path_prefix, uint32_t sample_rate, double queue_seconds) {
+    if (writer_running_) {
+        cerr << "Already recording to " << prefix_ << "\n";
+        return false;
+    }
+
+    sample_rate_ = sample_rate;
+    prefix_ = path_prefix;
+    size_t capacity = static_cast<size_t>(queue_seconds * sample_rate);
+
+    for (int t = 0; t < 2; ++t) {
+        Queue& queue = queues_[t];
+        queue.buffer.assign(capacity, 0);
+        queue.head = 0;
+        queue.tail = 0;
+        queue.dropped = 0;
+        queue.high_water = 0;
+
+        if (!openFile(files_[t], prefix_ + "-" + TRACK_NAMES[t] + ".wav")) {
+            if (t == 1) closeFile(files_[0]);
+            return false;
+        }
+    }
+    scratch_.resize(capacity);
+
+    writer_running_ = true;
+    writer_ = std::thread(&SessionRecorder::writerLoop, this);
+    recording_.store(true, std::memory_order_release);
+
+    cout << "✓ Recording to " << prefix_ << "-{raw,denoised}.wav\n";
+    return true;
+}
+
+void SessionRecorder::stop() {
+    if (!writer_running_) return;
+
+    // No new pushes, and wait out any the audio thread is in the middle of.
+    // Store-then-load on both sides (see push()) needs seq_cst: with
+    // acquire/release this load could miss a push that still saw true.
+    recording_.store(false, std::memory_order_seq_cst);
+    while (pushes_in_flight_.load(std::memory_order_seq_cst) > 0) {
+        std::this_thread::yield();
+    }
+
+    writer_running_ = false;
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    printStats();
+}
+
+void SessionRecorder::push(Track track, const int16_t* samples, size_t count) {
+    pushes_in_flight_.fetch_add(1, std::memory_order_seq_cst);
+    if (!recording_.load(std::memory_order_seq_cst)) {
+        pushes_in_flight_.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    Queue& queue = queues_[track];
+    const size_t capacity = queue.buffer.size();
+    uint64_t head = queue.head.load(std::memory_order_relaxed);
+    uint64_t tail = queue.tail.load(std::memory_order_acquire);
+    size_t used = static_cast<size_t>(head - tail);
+
+    if (used + count > capacity) {
+        queue.dropped.fetch_add(count, std::memory_order_relaxed);
+    } else {
+        size_t pos = static_cast<size_t>(head % capacity);
+        size_t first = std::min(count, capacity - pos);
+        std::memcpy(queue.buffer.data() + pos, samples, first * sizeof(int16_t));
+        std::memcpy(queue.buffer.data(), samples + first, (count - first) * sizeof(int16_t));
+        queue.head.store(head + count, std::memory_order_release);
+
+        if (used + count > queue.high_water.load(std::memory_order_relaxed)) {
+            queue.high_water.store(used + count, std::memory_order_relaxed);
+        }
+    }
+    pushes_in_flight_.fetch_sub(1, std::memory_order_release);
+}
+
+// Moves everything queued for one track into its file; writer thread only
+size_t SessionRecorder::drain(Track track) {
+    Queue& queue = queues_[track];
+    const size_t capacity = queue.buffer.size();
+    uint64_t tail = queue.tail.load(std::memory_order_relaxed);
+    uint64_t head = queue.head.load(std::memory_order_acquire);
+    size_t count = static_cast<size_t>(head - tail);
+    if (count == 0) return 0;
+
+    size_t pos = static_cast<size_t>(tail % capacity);
+    size_t first = std::min(count, capacity - pos);
+    std::memcpy(scratch_.data(), queue.buffer.data() + pos, first * sizeof(int16_t));
+    std::memcpy(scratch_.data() + first, queue.buffer.data(), (count - first) * sizeof(int16_t));
+    queue.tail.store(head, std::memory_order_release);
+
+    File& file = files_[track];
+    uint64_t written = file.samples_written.load(std::memory_order_relaxed);
+    size_t keep = static_cast<size_t>(std::min<uint64_t>(count, MAX_DATA_SAMPLES - written));
+    std::fwrite(scratch_.data(), sizeof(int16_t), keep, file.handle);
+    file.samples_written.store(written + keep, std::memory_order_relaxed);
+
+    if (keep < count) {
+        queue.dropped.fetch_add(count - keep, std::memory_order_relaxed);
+        if (recording_.exchange(false)) {
+            cerr << "Recording reached the WAV size limit after "
+                 << (written + keep) / sample_rate_ << " s; stopped\n";
+        }
+    }
+    return keep;
+}
+
+void SessionRecorder::writerLoop() {
+    auto last_header = std::chrono::steady_clock::now();
+
+    while (writer_running_) {
+        std::this_thread::sleep_for(DRAIN_INTERVAL);
+        drain(Raw);
+        drain(Denoised);
+
+        if (std::chrono::steady_clock::now() - last_header >= HEADER_INTERVAL) {
+            updateHeader(files_[Raw]);
+            updateHeader(files_[Denoised]);
+            last_header = std::chrono::steady_clock::now();
+        }
+    }
+
+    // Whatever arrived before stop() cut off the audio thread
+    drain(Raw);
+    drain(Denoised);
+    closeFile(files_[Raw]);
+    closeFile(files_[Denoised]);
+}
+
+bool SessionRecorder::openFile(File& file, const string& path) {
+    file.handle = std::fopen(path.c_str(), "wb");
+    if (!file.handle) {
+        cerr << "Cannot create recording: " << path << "\n";
+        return false;
+    }
+    file.io_buffer.resize(IO_BUFFER_BYTES);
+    std::setvbuf(file.handle, file.io_buffer.data(), _IOFBF, file.io_buffer.size());
+    file.samples_written.store(0, std::memory_order_relaxed);
+
+    // Mono 16-bit PCM; sizes start at zero and are patched as data lands
+    uint8_t header[44] = {};
+    uint16_t channels = 1;
+    uint16_t bits = 16;
+    uint16_t format = 1;
+    uint16_t block_align = channels * bits / 8;
+    uint32_t fmt_size = 16;
+    uint32_t byte_rate = sample_rate_ * block_align;
+    std::memcpy(header, "RIFF", 4);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    std::memcpy(header + 16, &fmt_size, 4);
+    std::memcpy(header + 20, &format, 2);
+    std::memcpy(header + 22, &channels, 2);
+    std::memcpy(header + 24, &sample_rate_, 4);
+    std::memcpy(header + 28, &byte_rate, 4);
+    std::memcpy(header + 32, &block_align, 2);
+    std::memcpy(header + 34, &bits, 2);
+    std::memcpy(header + 36, "data", 4);
+    std::fwrite(header, 1, sizeof(header), file.handle);
+    updateHeader(file);
+    return true;
+}
+
+// Rewrites the RIFF and data sizes for what has been written so far and
+// pushes it all to the kernel, so the file is valid up to this point
+void SessionRecorder::updateHeader(File& file) {
+    if (!file.handle) return;
+
+    uint32_t data_bytes = static_cast<uint32_t>(file.samples_written.load(std::memory_order_relaxed) *
+                                                sizeof(int16_t));
+    uint32_t riff_bytes = 36 + data_bytes;
+
+    long end = std::ftell(file.handle);
+    std::fseek(file.handle, 4, SEEK_SET);
+    std::fwrite(&riff_bytes, 4, 1, file.handle);
+    std::fseek(file.handle, 40, SEEK_SET);
+    std::fwrite(&data_bytes, 4, 1, file.handle);
+    std::fseek(file.handle, end, SEEK_SET);
+    std::fflush(file.handle);
+}
+
+void SessionRecorder::closeFile(File& file) {
+    if (!file.handle) return;
+    updateHeader(file);
+    std::fclose(file.handle);
+    file.handle = nullptr;
+    file.io_buffer.clear();
+    file.io_buffer.shrink_to_fit();
+}
+
+RecorderTrackStats SessionRecorder::stats(Track track) const {
+    RecorderTrackStats s;
+    const Queue& queue = queues_[track];
+    s.samples_written = files_[track].samples_written.load(std::memory_order_relaxed);
+    s.dropped = queue.dropped.load(std::memory_order_relaxed);
+    s.high_water = queue.high_water.load(std::memory_order_relaxed);
+    s.capacity = queue.buffer.size();
+    return s;
+}
+
+void SessionRecorder::printStats() const {
+    cout << "\n=== Recording (" << prefix_ << ") ===\n";
+    for (int t = 0; t < 2; ++t) {
+        RecorderTrackStats s = stats(static_cast<Track>(t));
+        double seconds = sample_rate_ ? static_cast<double>(s.samples_written) / sample_rate_ : 0.0;
+        cout << "  " << TRACK_NAMES[t] << ": " << seconds << " s written"
+             << " | queue high-water " << s.high_water << "/" << s.capacity
+             << " (" << (s.capacity ? 100.0 * s.high_water / s.capacity : 0.0) << "%)"
+             << " | dropped " << s.dropped << "\n";
+    }
+}
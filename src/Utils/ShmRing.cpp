@@ -0,0 +1,278 @@
+#include "Utils/ShmRing.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const uint32_t SHM_RING_MAGIC = 0x4E4D4952;  // "NMIR"
+static const uint32_t SHM_RING_VERSION = 1;
+
+static std::string normalizeName(const std::string& name) {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+static size_t slotStride(uint32_t frame_size) {
+    size_t bytes = sizeof(ShmRingSlot) + frame_size * sizeof(int16_t);
+    return (bytes + 63) & ~static_cast<size_t>(63);
+}
+
+static size_t headerStride() {
+    return (sizeof(ShmRingHeader) + 63) & ~static_cast<size_t>(63);
+}
+
+// ============================================================================
+// Writer
+// ============================================================================
+
+ShmRingWriter::ShmRingWriter()
+    : fd_(-1),
+      mapping_(nullptr),
+      mapping_size_(0),
+      header_(nullptr),
+      slots_(nullptr) {
+}
+
+ShmRingWriter::~ShmRingWriter() {
+    close();
+}
+
+bool ShmRingWriter::create(const std::string& name, uint32_t sample_rate,
+                           uint32_t frame_size, uint32_t slot_count) {
+    close();
+
+    if (frame_size == 0 || slot_count == 0) {
+        std::cerr << "Invalid shared ring geometry\n";
+        return false;
+    }
+
+    name_ = normalizeName(name);
+    size_t stride = slotStride(frame_size);
+    mapping_size_ = headerStride() + stride * slot_count;
+
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd_ < 0) {
+        std::cerr << "shm_open(" << name_ << ") failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    if (ftruncate(fd_, static_cast<off_t>(mapping_size_)) != 0) {
+        std::cerr << "ftruncate failed: " << std::strerror(errno) << "\n";
+        close();
+        return false;
+    }
+
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "mmap failed: " << std::strerror(errno) << "\n";
+        close();
+        return false;
+    }
+
+    // Touch every page now so the audio thread never takes a page fault
+    std::memset(mapping_, 0, mapping_size_);
+
+    header_ = static_cast<ShmRingHeader*>(mapping_);
+    slots_ = static_cast<uint8_t*>(mapping_) + headerStride();
+
+    header_->version = SHM_RING_VERSION;
+    header_->sample_rate = sample_rate;
+    header_->channels = 1;
+    header_->frame_size = frame_size;
+    header_->slot_count = slot_count;
+    header_->slot_stride = static_cast<uint32_t>(stride);
+    header_->write_seq.store(0, std::memory_order_relaxed);
+
+    // Readers check the magic last, so publish it after the geometry
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = SHM_RING_MAGIC;
+
+    std::cout << "✓ Shared output ring: " << name_ << " (" << slot_count << " x "
+              << frame_size << " samples)\n";
+    return true;
+}
+
+void ShmRingWriter::close() {
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+        shm_unlink(name_.c_str());
+    }
+    header_ = nullptr;
+    slots_ = nullptr;
+    mapping_size_ = 0;
+}
+
+void ShmRingWriter::publish(const int16_t* samples, size_t count) {
+    if (!header_) return;
+
+    const uint32_t frame_size = header_->frame_size;
+    const uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    while (count > 0) {
+        uint64_t seq = header_->write_seq.load(std::memory_order_relaxed);
+        auto* slot = reinterpret_cast<ShmRingSlot*>(
+            slots_ + (seq % header_->slot_count) * header_->slot_stride);
+        auto* dst = reinterpret_cast<int16_t*>(slot + 1);
+
+        slot->seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        size_t n = std::min<size_t>(count, frame_size);
+        std::memcpy(dst, samples, n * sizeof(int16_t));
+        if (n < frame_size) {
+            std::memset(dst + n, 0, (frame_size - n) * sizeof(int16_t));
+        }
+        slot->timestamp_ns = now;
+
+        slot->seq.store(seq + 1, std::memory_order_release);
+        header_->write_seq.store(seq + 1, std::memory_order_release);
+
+        samples += n;
+        count -= n;
+    }
+}
+
+uint64_t ShmRingWriter::published() const {
+    return header_ ? header_->write_seq.load(std::memory_order_relaxed) : 0;
+}
+
+// ============================================================================
+// Reader
+// ============================================================================
+
+ShmRingReader::ShmRingReader()
+    : fd_(-1),
+      mapping_(nullptr),
+      mapping_size_(0),
+      header_(nullptr),
+      slots_(nullptr),
+      next_seq_(0),
+      dropped_(0) {
+}
+
+ShmRingReader::~ShmRingReader() {
+    close();
+}
+
+bool ShmRingReader::open(const std::string& name) {
+    close();
+
+    std::string shm_name = normalizeName(name);
+    fd_ = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd_ < 0) {
+        std::cerr << "shm_open(" << shm_name << ") failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < headerStride()) {
+        std::cerr << "Shared ring " << shm_name << " is not initialized\n";
+        close();
+        return false;
+    }
+
+    mapping_size_ = static_cast<size_t>(st.st_size);
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "mmap failed: " << std::strerror(errno) << "\n";
+        close();
+        return false;
+    }
+
+    header_ = static_cast<const ShmRingHeader*>(mapping_);
+    slots_ = static_cast<const uint8_t*>(mapping_) + headerStride();
+
+    if (header_->magic != SHM_RING_MAGIC || header_->version != SHM_RING_VERSION) {
+        std::cerr << "Shared ring " << shm_name << " has an unknown layout\n";
+        close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (headerStride() + static_cast<size_t>(header_->slot_stride) * header_->slot_count > mapping_size_) {
+        std::cerr << "Shared ring " << shm_name << " is truncated\n";
+        close();
+        return false;
+    }
+
+    next_seq_ = header_->write_seq.load(std::memory_order_acquire);
+    dropped_ = 0;
+    return true;
+}
+
+void ShmRingReader::close() {
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    header_ = nullptr;
+    slots_ = nullptr;
+    mapping_size_ = 0;
+}
+
+const ShmRingSlot* ShmRingReader::slotFor(uint64_t seq) const {
+    return reinterpret_cast<const ShmRingSlot*>(
+        slots_ + (seq % header_->slot_count) * header_->slot_stride);
+}
+
+bool ShmRingReader::next(ShmFrameView& view) {
+    if (!header_) return false;
+
+    for (;;) {
+        uint64_t write_seq = header_->write_seq.load(std::memory_order_acquire);
+        if (next_seq_ >= write_seq) return false;
+
+        // Writer lapped us: jump to the oldest frame still in the ring
+        if (write_seq - next_seq_ > header_->slot_count) {
+            uint64_t oldest = write_seq - header_->slot_count;
+            dropped_ += oldest - next_seq_;
+            next_seq_ = oldest;
+        }
+
+        const ShmRingSlot* slot = slotFor(next_seq_);
+        if (slot->seq.load(std::memory_order_acquire) != next_seq_ + 1) {
+            // Overwritten between the two loads; resync and retry
+            ++dropped_;
+            ++next_seq_;
+            continue;
+        }
+
+        view.samples = reinterpret_cast<const int16_t*>(slot + 1);
+        view.frame_size = header_->frame_size;
+        view.seq = next_seq_;
+        view.timestamp_ns = slot->timestamp_ns;
+        ++next_seq_;
+        return true;
+    }
+}
+
+bool ShmRingReader::validate(const ShmFrameView& view) const {
+    if (!header_) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slotFor(view.seq)->seq.load(std::memory_order_relaxed) == view.seq + 1;
+}
+
+bool ShmRingReader::readCopy(int16_t* dst, ShmFrameView& view) {
+    while (next(view)) {
+        std::memcpy(dst, view.samples, view.frame_size * sizeof(int16_t));
+        if (validate(view)) return true;
+        ++dropped_;
+    }
+    return false;
+}
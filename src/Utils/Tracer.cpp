@@ -0,0 +1,193 @@
+#include "Utils/Tracer.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <ctime>
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+static const uint64_t ANOMALY_COOLDOWN_NS = 10'000'000'000ull;
+
+// initial-exec: looked up on every event, must never allocate
+static thread_local __attribute__((tls_model("initial-exec"))) void* local_buffer = nullptr;
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+    : enabled_(false),
+      buffers_claimed_(0),
+      anomaly_before_ms_(3000),
+      anomaly_after_ms_(1000),
+      anomaly_at_ns_(0),
+      anomaly_reason_(nullptr),
+      anomaly_running_(false) {
+}
+
+Tracer::~Tracer() {
+    anomaly_running_ = false;
+    if (anomaly_thread_.joinable()) {
+        anomaly_thread_.join();
+    }
+}
+
+uint64_t Tracer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::setEnabled(bool enabled) {
+    if (enabled && !buffers_) {
+        // Reserved once and kept; audio threads claim rings without allocating
+        buffers_ = std::make_unique<ThreadBuffer[]>(MAX_THREADS);
+        for (int i = 0; i < MAX_THREADS; ++i) {
+            buffers_[i].events = std::make_unique<TraceEvent[]>(EVENTS_PER_THREAD);
+        }
+        cout << "✓ Tracing enabled (" << MAX_THREADS << " threads x "
+             << EVENTS_PER_THREAD << " events)\n";
+    }
+    enabled_.store(enabled, std::memory_order_release);
+}
+
+Tracer::ThreadBuffer* Tracer::threadBuffer() {
+    if (local_buffer) return static_cast<ThreadBuffer*>(local_buffer);
+
+    int index = buffers_claimed_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= MAX_THREADS) {
+        buffers_claimed_.store(MAX_THREADS, std::memory_order_relaxed);
+        return nullptr;   // pool exhausted; this thread goes untraced
+    }
+    local_buffer = &buffers_[index];
+    return &buffers_[index];
+}
+
+void Tracer::push(const TraceEvent& event) {
+    if (!enabled_.load(std::memory_order_acquire)) return;
+    ThreadBuffer* buffer = threadBuffer();
+    if (!buffer) return;
+
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % EVENTS_PER_THREAD] = event;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::record(const char* name, uint64_t start_ns, uint64_t end_ns, uint32_t arg) {
+    push({name, start_ns, static_cast<uint32_t>(std::min<uint64_t>(end_ns - start_ns, UINT32_MAX)), arg, false});
+}
+
+void Tracer::instant(const char* name, uint32_t arg) {
+    push({name, nowNs(), 0, arg, true});
+}
+
+void Tracer::setThreadName(const char* name) {
+    if (!enabled_.load(std::memory_order_acquire)) return;
+    if (ThreadBuffer* buffer = threadBuffer()) {
+        buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+bool Tracer::dump(const string& path, uint64_t window_ms) const {
+    if (!buffers_) {
+        cerr << "Tracing was never enabled\n";
+        return false;
+    }
+
+    std::ofstream out(path);
+    if (!out) {
+        cerr << "Cannot write trace to " << path << "\n";
+        return false;
+    }
+
+    uint64_t cutoff = window_ms ? nowNs() - window_ms * 1'000'000ull : 0;
+    int threads = std::min(buffers_claimed_.load(), MAX_THREADS);
+    size_t written = 0;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (int t = 0; t < threads; ++t) {
+        const ThreadBuffer& buffer = buffers_[t];
+
+        // Copy the ring, then drop anything the writer may have lapped meanwhile
+        uint64_t head = buffer.head.load(std::memory_order_acquire);
+        uint64_t first = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+        vector<TraceEvent> events;
+        events.reserve(head - first);
+        for (uint64_t i = first; i < head; ++i) {
+            events.push_back(buffer.events[i % EVENTS_PER_THREAD]);
+        }
+        uint64_t head_after = buffer.head.load(std::memory_order_acquire);
+        size_t lapped = head_after > EVENTS_PER_THREAD + first ? head_after - EVENTS_PER_THREAD - first : 0;
+
+        const char* name = buffer.name.load(std::memory_order_relaxed);
+        out << (written++ ? ",\n" : "")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":\"" << (name ? name : "thread") << "\"}}";
+
+        for (size_t i = std::min(lapped, events.size()); i < events.size(); ++i) {
+            const TraceEvent& e = events[i];
+            if (e.start_ns < cutoff) continue;
+
+            out << ",\n{\"name\":\"" << e.name << "\",\"pid\":1,\"tid\":" << t
+                << ",\"ts\":" << e.start_ns / 1000.0;
+            if (e.instant) {
+                out << ",\"ph\":\"i\",\"s\":\"g\"";
+            } else {
+                out << ",\"ph\":\"X\",\"dur\":" << e.duration_ns / 1000.0;
+            }
+            out << ",\"args\":{\"n\":" << e.arg << "}}";
+            written++;
+        }
+    }
+    out << "\n]}\n";
+
+    cout << "✓ Trace written: " << path << " (" << written << " events)\n";
+    return true;
+}
+
+void Tracer::enableAnomalyDumps(const string& directory, uint64_t before_ms, uint64_t after_ms) {
+    setEnabled(true);
+    anomaly_dir_ = directory;
+    anomaly_before_ms_ = before_ms;
+    anomaly_after_ms_ = after_ms;
+
+    if (!anomaly_running_.exchange(true)) {
+        anomaly_thread_ = std::thread(&Tracer::anomalyLoop, this);
+    }
+}
+
+void Tracer::markAnomaly(const char* reason) {
+    if (!anomaly_running_.load(std::memory_order_relaxed)) return;
+
+    uint64_t expected = 0;
+    if (anomaly_at_ns_.compare_exchange_strong(expected, nowNs(), std::memory_order_acq_rel)) {
+        anomaly_reason_.store(reason, std::memory_order_release);
+    }
+}
+
+void Tracer::anomalyLoop() {
+    uint64_t last_dump_ns = 0;
+
+    while (anomaly_running_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        uint64_t at = anomaly_at_ns_.load(std::memory_order_acquire);
+        if (!at) continue;
+
+        uint64_t now = nowNs();
+        if (now < at + anomaly_after_ms_ * 1'000'000ull) continue;   // let the aftermath land
+
+        if (now - last_dump_ns >= ANOMALY_COOLDOWN_NS || last_dump_ns == 0) {
+            string path = anomaly_dir_ + "/neuralmic-trace-" + std::to_string(std::time(nullptr)) + ".json";
+            cout << "\nAnomaly (" << anomaly_reason_.load() << "), dumping trace\n";
+            dump(path, anomaly_before_ms_ + anomaly_after_ms_);
+            last_dump_ns = now;
+        }
+        anomaly_at_ns_.store(0, std::memory_order_release);
+    }
+}
@@ -1,10 +1,40 @@
 #include "Utils/MicReader.h"
 #include "Utils/AudReader.h"    
 #include "Core/OnnxInference.h"
+#include "Core/SpectralGate.h"
 #include "Core/RealtimeDenoiser.h"
+#include "Core/DenoiseServer.h"
+#include "Core/MultiMicEngine.h"
+#include "Core/ProcessingGraph.h"
+#include "Core/AudioStages.h"
+#include "Utils/ShmRing.h"
+#include "Utils/MemoryStats.h"
+#include "Utils/AllocTracker.h"
+#include "Utils/Tracer.h"
+#include "Utils/AudioMetrics.h"
+#include "Utils/OrtProfile.h"
 #include <iostream>
 #include <string>
 #include <filesystem>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <numeric>
 
 using std::string;
 using std::cout;
@@ -12,85 +42,667 @@ using std::cerr;
 using std::exception;
 using std::vector;
 
-static int run_file_mode(const string& in_path, const string& out_path) {
+// Whole-string integer argument; prints what was wrong instead of throwing
+static bool parse_int(const char* text, int& value) {
+    try 
+    {
+        size_t used = 0;
+        value = std::stoi(text, &used);
+        if (used == std::strlen(text)) return true;
+    } catch (const exception&) 
+    {
+    }
+    cerr << "Not a number: " << text << "\n";
+    return false;
+}
+
+static bool parse_float(const char* text, float& value) {
+    try 
+    {
+        size_t used = 0;
+        value = std::stof(text, &used);
+        if (used == std::strlen(text)) return true;
+    } catch (const exception&) 
+    {
+    }
+    cerr << "Not a number: " << text << "\n";
+    return false;
+}
+
+// --hops K: 0 keeps what the model export fixes
+static bool parse_hops(const char* text, int& hops) {
+    if (!parse_int(text, hops)) return false;
+    if (hops < 0) 
+    {
+        cerr << "--hops must be 0 (model default) or a positive hop count\n";
+        return false;
+    }
+    return true;
+}
+
+// Warm states are saved stream states captured with --capture-state. A
+// bare name refers to the library in ../assets/states, anything else is a path.
+static string warm_state_path(const string& spec) {
+    if (spec.find('/') != string::npos || spec.ends_with(".nmstate")) return spec;
+    return "../assets/states/" + spec + ".nmstate";
+}
+
+struct FileOptions {
+    string graph = "denoise";  // --graph <spec>
+    int hops = 0;              // --hops <K>
+    MemoryProfile memory;      // --memory default|low[:MiB]
+    string engine = "dfn";     // --engine dfn|gate
+    string warm_state;         // --warm-state <name|path>
+};
+
+// The model, or the DSP fallback for hosts that can't afford it
+static std::unique_ptr<NoiseSuppressor> make_engine(const FileOptions& options) {
+    if (options.engine == "gate") 
+    {
+        return std::make_unique<SpectralGate>();
+    }
+    const string model = "../assets/models/DeepFilterNetV3.onnx";
+    auto denoiser = std::make_unique<DeepFilterNet>(model, options.hops, options.memory);
+    if (!options.warm_state.empty()) 
+    {
+        denoiser->LoadWarmState(warm_state_path(options.warm_state));
+        denoiser->reset();
+    }
+    return denoiser;
+}
+
+static bool parse_file_options(int argc, char* argv[], int first, FileOptions& options) {
+    for (int i = first; i < argc; i += 2) 
+    {
+        string flag = argv[i];
+        if (i + 1 >= argc) 
+        {
+            cerr << "Missing value for " << flag << "\n";
+            return false;
+        }
+        
+        if (flag == "--graph") options.graph = argv[i + 1];
+        else if (flag == "--hops") 
+        {
+            if (!parse_hops(argv[i + 1], options.hops)) return false;
+        }
+        else if (flag == "--warm-state") options.warm_state = argv[i + 1];
+        else if (flag == "--engine") 
+        {
+            options.engine = argv[i + 1];
+            if (options.engine != "dfn" && options.engine != "gate") 
+            {
+                cerr << "Unknown engine: " << options.engine << " (dfn or gate)\n";
+                return false;
+            }
+        }
+        else if (flag == "--memory") 
+        {
+            if (!MemoryProfile::Parse(argv[i + 1], options.memory)) 
+            {
+                cerr << "Unknown memory profile: " << argv[i + 1] << "\n";
+                return false;
+            }
+        }
+        else 
+        {
+            cerr << "Unknown option: " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static int run_file_mode(const string& in_path, const string& out_path, const FileOptions& options = {}) {
     try {
-        const string model = "../assets/models/DeepFilterNetV3.onnx";
-        DeepFilterNet denoiser(model);
-        denoiser.SetNoiseSuppressionStrength(0.0f);
+        auto denoiser = make_engine(options);
+        denoiser->SetNoiseSuppressionStrength(0.0f);
         
-        AudioFile audio;
-        AudioIO::load(in_path, audio);
+        // The same graph the realtime path runs, over the whole file at once
+        ProcessingGraph graph;
+        buildGraph(options.graph, graph, std::make_unique<DenoiserStage>(*denoiser));
+        graph.prepare(DeepFilterNet::SAMPLE_RATE, 96 * DeepFilterNet::HOP_SIZE);
+        graph.reset();
+        
+        // Decoded straight to float with room for the graph's padding, so
+        // the signal is held once and processed in place
+        AudioBuffer<float> audio;
+        AudioIO::load(in_path, audio, graph.latency() + 96 * DeepFilterNet::HOP_SIZE);
         
         cout << "Loaded audio:\n";
-        cout << "  Samples: " << audio.samples.size() << "\n";
-        cout << "  Sample rate: " << audio.sampleRate << " Hz\n";
-        cout << "  Channels: " << audio.channels << "\n";
-        cout << "  Duration: " << audio.getDuration() << " seconds\n";
+        cout << "  Samples: " << audio.size() << "\n";
+        cout << "  Sample rate: " << audio.sampleRate() << " Hz\n";
+        cout << "  Channels: " << audio.channels() << "\n";
+        cout << "  Duration: " << audio.duration() << " seconds\n";
+        
+        auto peak = [](std::span<const float> samples) {
+            float p = 0.0f;
+            for (float s : samples) p = std::max(p, std::abs(s));
+            return p;
+        };
+        cout << "Input peak level: " << peak(audio.samples()) << "\n";
+
+        cout << "\nProcessing through " << options.graph << "...\n";
+        graph.processOffline(audio.storage(), audio.size());
+        
+        cout << "Output peak level: " << peak(audio.samples()) << "\n";
+
+        AudioIO::save(out_path, audio);
+        cout << "\n✓ Saved: " << out_path << "\n";
+        cout << "  Output samples: " << audio.size() << "\n";
+        cout << "  Duration: " << audio.duration() << " seconds\n";
+        cout << "  Peak RSS: " << peakResidentBytes() / (1024.0 * 1024.0) << " MiB\n";
+        
+        return 0;
+        
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// Bounded hand-off between the decode, inference and encode stages of
+// stream mode; push blocks when full and returns false once closed, pop
+// returns false once closed and empty
+class BlockQueue {
+public:
+    explicit BlockQueue(size_t capacity) : capacity_(capacity), closed_(false) {}
+    
+    bool push(vector<int16_t> block) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return blocks_.size() < capacity_ || closed_; });
+        if (closed_) return false;
+        blocks_.push_back(std::move(block));
+        not_empty_.notify_one();
+        return true;
+    }
+    
+    bool pop(vector<int16_t>& block) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !blocks_.empty() || closed_; });
+        if (blocks_.empty()) return false;
+        block = std::move(blocks_.front());
+        blocks_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+    
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+    
+private:
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<vector<int16_t>> blocks_;
+    size_t capacity_;
+    bool closed_;
+};
 
-        vector<float> float_samples;
-        float_samples.reserve(audio.samples.size());
+// File mode without loading the file: decode, inference and encode run as a
+// three-stage pipeline over fixed blocks, so memory stays flat whatever the
+// length and output starts as soon as the first block is through
+static int run_stream_mode(const string& in_path, const string& out_path, const FileOptions& options = {}) {
+    try {
+        auto denoiser = make_engine(options);
+        denoiser->SetNoiseSuppressionStrength(0.0f);
+        
+        ProcessingGraph graph;
+        buildGraph(options.graph, graph, std::make_unique<DenoiserStage>(*denoiser));
+        
+        // Ten hops per block, rounded to what every stage accepts
+        size_t stage_block = graph.blockSize();
+        size_t block = (10 * DeepFilterNet::HOP_SIZE + stage_block - 1) / stage_block * stage_block;
+        graph.prepare(DeepFilterNet::SAMPLE_RATE, block);
+        graph.reset();
+        
+        auto reader = AudioIO::openReader(in_path);
+        auto writer = AudioIO::openWriter(out_path, reader->sampleRate(), reader->channels());
+        cout << "Streaming " << in_path << " (" << reader->sampleRate() << " Hz, "
+             << reader->channels() << " ch) through " << options.graph << "...\n";
+        
+        auto t0 = std::chrono::steady_clock::now();
+        double first_output_ms = -1.0;
+        BlockQueue decoded(8);
+        BlockQueue processed(8);
+        // Set by whichever stage fails; the others wind down and the output
+        // is reported as failed rather than saved
+        std::atomic<bool> failed(false);
+        
+        std::thread decoder([&] {
+            try {
+                while (!failed) 
+                {
+                    vector<int16_t> samples(block);
+                    size_t count = reader->read(samples.data(), samples.size());
+                    if (count == 0) break;
+                    samples.resize(count);
+                    if (!decoded.push(std::move(samples))) break;
+                }
+            } catch (const exception& e) 
+            {
+                cerr << "Decode error: " << e.what() << "\n";
+                failed = true;
+            }
+            decoded.close();
+        });
         
-        for (const auto& sample : audio.samples) 
+        std::thread encoder([&] {
+            try {
+                vector<int16_t> samples;
+                while (processed.pop(samples)) 
+                {
+                    writer->write(samples.data(), samples.size());
+                    if (first_output_ms < 0.0) 
+                    {
+                        first_output_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    }
+                }
+                writer->close();
+            } catch (const exception& e) 
+            {
+                cerr << "Encode error: " << e.what() << "\n";
+                failed = true;
+            }
+            processed.close();
+        });
+        
+        // The graph delays its output by latency() samples: drop that much
+        // from the front and push silence through at the end to flush it
+        size_t latency = graph.latency();
+        size_t to_skip = latency;
+        size_t samples_in = 0;
+        size_t samples_out = 0;
+        bool input_done = false;
+        vector<float> frame(block);
+        vector<int16_t> samples;
+        std::exception_ptr process_error;
+        
+        try {
+            while (!failed && (!input_done || samples_out < samples_in)) 
+            {
+                size_t count = block;
+                if (!input_done && decoded.pop(samples)) 
+                {
+                    count = samples.size();
+                    samples_in += count;
+                    for (size_t i = 0; i < count; ++i) frame[i] = samples[i] / 32768.0f;
+                } 
+                else 
+                {
+                    input_done = true;
+                }
+                std::fill(frame.begin() + (input_done ? 0 : count), frame.end(), 0.0f);
+                
+                graph.process(frame.data(), block);
+                
+                size_t skip = std::min(to_skip, block);
+                to_skip -= skip;
+                size_t keep = std::min(block - skip, samples_in - samples_out);
+                vector<int16_t> out(keep);
+                for (size_t i = 0; i < keep; ++i) 
+                {
+                    out[i] = static_cast<int16_t>(std::clamp(frame[skip + i] * 32767.0f, -32768.0f, 32767.0f));
+                }
+                samples_out += keep;
+                if (keep > 0) processed.push(std::move(out));
+            }
+        } catch (...) 
         {
-            float_samples.push_back(static_cast<float>(sample) / 32768.0f);
+            process_error = std::current_exception();
+            failed = true;
         }
         
-        float input_peak = 0.0f;
-
-        for (float s : float_samples) 
+        // Both threads exit once their queue is closed, whichever stage failed
+        decoded.close();
+        processed.close();
+        decoder.join();
+        encoder.join();
+        if (process_error) std::rethrow_exception(process_error);
+        if (failed) 
         {
-            input_peak = std::max(input_peak, std::abs(s));
+            cerr << "✗ Stream failed, " << out_path << " is incomplete\n";
+            return 1;
         }
+        
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double duration = static_cast<double>(samples_in) / (reader->sampleRate() * std::max<uint16_t>(1, reader->channels()));
+        cout << "\n✓ Saved: " << out_path << "\n";
+        cout << "  Duration: " << duration << " seconds in " << elapsed << " s ("
+             << duration / elapsed << "x realtime)\n";
+        cout << "  First output after: " << first_output_ms << " ms\n";
+        cout << "  Peak RSS: " << peakResidentBytes() / (1024.0 * 1024.0) << " MiB\n";
+        return 0;
+        
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
 
-        cout << "Input peak level: " << input_peak << "\n";
+struct PipeOptions {
+    string format = "s16le";   // s16le | f32le
+    float strength = 0.0f;     // --strength <dB>
+    int hops = 0;              // --hops <K>
+    MemoryProfile memory;      // --memory default|low[:MiB]
+    string warm_state;         // --warm-state <name|path>
+};
 
-        cout << "\nProcessing through DeepFilterNet...\n";
-        vector<float> denoised = denoiser.ApplyNoiseSuppression(float_samples);
+static bool parse_pipe_options(int argc, char* argv[], int first, PipeOptions& options) {
+    for (int i = first; i < argc; i += 2) 
+    {
+        string flag = argv[i];
+        if (i + 1 >= argc) 
+        {
+            cerr << "Missing value for " << flag << "\n";
+            return false;
+        }
         
-        float output_peak = 0.0f;
-
-        for (float s : denoised) 
+        if (flag == "--strength") 
+        {
+            if (!parse_float(argv[i + 1], options.strength)) return false;
+        }
+        else if (flag == "--hops") 
+        {
+            if (!parse_hops(argv[i + 1], options.hops)) return false;
+        }
+        else if (flag == "--warm-state") options.warm_state = argv[i + 1];
+        else if (flag == "--memory") 
+        {
+            if (!MemoryProfile::Parse(argv[i + 1], options.memory)) 
+            {
+                cerr << "Unknown memory profile: " << argv[i + 1] << "\n";
+                return false;
+            }
+        }
+        else 
         {
-            output_peak = std::max(output_peak, std::abs(s));
+            cerr << "Unknown option: " << flag << "\n";
+            return false;
         }
+    }
+    return true;
+}
 
-        cout << "Output peak level: " << output_peak << "\n";
+static const size_t PIPE_IO_BYTES = 1 << 20;
 
-        audio.samples.clear();
-        audio.samples.reserve(denoised.size());
-        
-        for (const auto& sample : denoised) 
+// Grows a pipe's kernel buffer so each read()/write() moves more at once.
+// Not a pipe, or above /proc/sys/fs/pipe-max-size: keeps what it has.
+static void grow_pipe(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode)) 
+    {
+        fcntl(fd, F_SETPIPE_SZ, static_cast<int>(PIPE_IO_BYTES));
+    }
+}
+
+static bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) 
+    {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) 
         {
-            float scaled = sample * 32767.0f;
-            int32_t clamped = std::clamp(
-                static_cast<int32_t>(scaled),
-                static_cast<int32_t>(-32768),
-                static_cast<int32_t>(32767)
-            );
-            audio.samples.push_back(static_cast<int16_t>(clamped));
+            if (errno == EINTR) continue;
+            return false;
         }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
 
-        AudioIO::save(out_path, audio);
-        cout << "\n✓ Saved: " << out_path << "\n";
-        cout << "  Output samples: " << audio.samples.size() << "\n";
-        cout << "  Duration: " << audio.getDuration() << " seconds\n";
+// Raw mono 48 kHz PCM from stdin to stdout, hop by hop through the
+// streaming model, for use inside ffmpeg/sox pipelines. The model's delay
+// is removed so output lines up sample for sample with input; everything
+// that is not audio goes to stderr.
+static int run_pipe_mode(const PipeOptions& options) {
+    std::streambuf* cout_buffer = cout.rdbuf(cerr.rdbuf());
+    std::signal(SIGPIPE, SIG_IGN);   // a closed reader shows up as EPIPE
+    
+    try {
+        const string model = "../assets/models/DeepFilterNetV3.onnx";
+        DeepFilterNet denoiser(model, options.hops, options.memory);
+        denoiser.SetNoiseSuppressionStrength(options.strength);
+        if (!options.warm_state.empty()) 
+        {
+            denoiser.LoadWarmState(warm_state_path(options.warm_state));
+            denoiser.reset();
+        }
+        
+        const bool f32 = (options.format == "f32le");
+        const size_t sample_bytes = f32 ? sizeof(float) : sizeof(int16_t);
+        const size_t hop = DeepFilterNet::HOP_SIZE;
+        const size_t hop_bytes = hop * sample_bytes;
+        
+        grow_pipe(STDIN_FILENO);
+        grow_pipe(STDOUT_FILENO);
+        
+        vector<char> in_buffer(PIPE_IO_BYTES);
+        vector<char> out_buffer(PIPE_IO_BYTES);
+        size_t in_fill = 0;
+        size_t out_fill = 0;
+        vector<float> frame(hop);
+        
+        size_t to_skip = denoiser.StreamLatency();
+        uint64_t samples_in = 0;
+        uint64_t samples_out = 0;
+        bool downstream_closed = false;
+        
+        auto flush = [&]() {
+            if (out_fill == 0 || downstream_closed) return;
+            if (!write_all(STDOUT_FILENO, out_buffer.data(), out_fill)) 
+            {
+                if (errno != EPIPE) throw std::runtime_error(string("write: ") + std::strerror(errno));
+                downstream_closed = true;
+            }
+            out_fill = 0;
+        };
+        
+        auto process_hop = [&]() {
+            denoiser.ProcessRealtimeFrame(frame.data(), frame.data());
+            
+            size_t skip = std::min(to_skip, hop);
+            to_skip -= skip;
+            size_t keep = static_cast<size_t>(std::min<uint64_t>(hop - skip, samples_in - samples_out));
+            if (out_fill + keep * sample_bytes > out_buffer.size()) flush();
+            
+            char* out = out_buffer.data() + out_fill;
+            for (size_t i = 0; i < keep; ++i) 
+            {
+                float s = frame[skip + i];
+                if (f32) 
+                {
+                    std::memcpy(out + i * sizeof(float), &s, sizeof(float));
+                }
+                else 
+                {
+                    int16_t v = static_cast<int16_t>(std::clamp(s * 32767.0f, -32768.0f, 32767.0f));
+                    std::memcpy(out + i * sizeof(int16_t), &v, sizeof(int16_t));
+                }
+            }
+            out_fill += keep * sample_bytes;
+            samples_out += keep;
+        };
+        
+        auto decode_hop = [&](const char* in, size_t samples) {
+            for (size_t i = 0; i < samples; ++i) 
+            {
+                if (f32) 
+                {
+                    std::memcpy(&frame[i], in + i * sizeof(float), sizeof(float));
+                }
+                else 
+                {
+                    int16_t v;
+                    std::memcpy(&v, in + i * sizeof(int16_t), sizeof(int16_t));
+                    frame[i] = v / 32768.0f;
+                }
+            }
+            std::fill(frame.begin() + samples, frame.end(), 0.0f);
+            samples_in += samples;
+        };
+        
+        cerr << "Piping " << options.format << " mono " << DeepFilterNet::SAMPLE_RATE
+             << " Hz from stdin to stdout...\n";
+        
+        auto t0 = std::chrono::steady_clock::now();
+        auto last_report = t0;
+        auto report = [&](const char* label) {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            double audio = static_cast<double>(samples_in) / DeepFilterNet::SAMPLE_RATE;
+            cerr << label << audio << " s audio in " << elapsed << " s | "
+                 << (elapsed > 0.0 ? audio / elapsed : 0.0) << "x realtime | "
+                 << (elapsed > 0.0 ? samples_in * sample_bytes / elapsed / (1024.0 * 1024.0) : 0.0) << " MiB/s\n";
+        };
+        
+        // Whole hops go through as soon as they arrive; each read's worth of
+        // output is written before blocking on the next read, so a live
+        // source is not held back waiting for a full buffer
+        while (!downstream_closed) 
+        {
+            ssize_t n = ::read(STDIN_FILENO, in_buffer.data() + in_fill, in_buffer.size() - in_fill);
+            if (n < 0) 
+            {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(string("read: ") + std::strerror(errno));
+            }
+            if (n == 0) break;
+            in_fill += static_cast<size_t>(n);
+            
+            size_t offset = 0;
+            for (; in_fill - offset >= hop_bytes; offset += hop_bytes) 
+            {
+                decode_hop(in_buffer.data() + offset, hop);
+                process_hop();
+            }
+            std::memmove(in_buffer.data(), in_buffer.data() + offset, in_fill - offset);
+            in_fill -= offset;
+            flush();
+            
+            if (std::chrono::steady_clock::now() - last_report >= std::chrono::seconds(10)) 
+            {
+                report("  ");
+                last_report = std::chrono::steady_clock::now();
+            }
+        }
         
+        // Last partial hop (a trailing partial sample is dropped), then
+        // silence until the delayed tail is out
+        if (!downstream_closed && in_fill >= sample_bytes) 
+        {
+            decode_hop(in_buffer.data(), in_fill / sample_bytes);
+            process_hop();
+        }
+        while (!downstream_closed && samples_out < samples_in) 
+        {
+            decode_hop(nullptr, 0);
+            process_hop();
+        }
+        flush();
+        
+        report(downstream_closed ? "✓ Downstream closed after " : "✓ Done: ");
+        cout.rdbuf(cout_buffer);
         return 0;
         
     } catch (const exception& e) 
     {
         cerr << "Error: " << e.what() << "\n";
+        cout.rdbuf(cout_buffer);
         return 1;
     }
 }
 
-static int run_realtime_mode() {
+struct RealtimeOptions {
+    string shm_name;        // --shm <name>
+    string control_socket;  // --control <path>
+    string graph;           // --graph <spec>
+    int hops = 0;           // --hops <K>
+    MemoryProfile memory;   // --memory default|low[:MiB]
+    string trace_dir;       // --trace <dir>: trace and dump around glitches
+    string record_prefix;   // --record <prefix>: raw and denoised WAVs
+    string engine;          // --engine dfn|gate|auto
+    string warm_state;      // --warm-state <name|path>
+    PipelineConfig pipeline; // --pipeline stage1.onnx,stage2.onnx[@cpu1,cpu2]
+};
+
+static bool parse_realtime_options(int argc, char* argv[], int first, RealtimeOptions& options) {
+    for (int i = first; i < argc; i += 2) 
+    {
+        string flag = argv[i];
+        if (i + 1 >= argc) 
+        {
+            cerr << "Missing value for " << flag << "\n";
+            return false;
+        }
+        
+        if (flag == "--shm") options.shm_name = argv[i + 1];
+        else if (flag == "--control") options.control_socket = argv[i + 1];
+        else if (flag == "--graph") options.graph = argv[i + 1];
+        else if (flag == "--hops") 
+        {
+            if (!parse_hops(argv[i + 1], options.hops)) return false;
+        }
+        else if (flag == "--trace") options.trace_dir = argv[i + 1];
+        else if (flag == "--record") options.record_prefix = argv[i + 1];
+        else if (flag == "--engine") options.engine = argv[i + 1];
+        else if (flag == "--warm-state") options.warm_state = argv[i + 1];
+        else if (flag == "--pipeline") 
+        {
+            if (!PipelineConfig::Available()) 
+            {
+                cerr << "Pipelined stages not built in (configure with -DNEURALMIC_STAGE_PIPELINE=ON)\n";
+                return false;
+            }
+            if (!PipelineConfig::Parse(argv[i + 1], options.pipeline)) 
+            {
+                cerr << "Invalid pipeline: " << argv[i + 1] << " (stage1.onnx,stage2.onnx[@cpu1,cpu2])\n";
+                return false;
+            }
+        }
+        else if (flag == "--memory") 
+        {
+            if (!MemoryProfile::Parse(argv[i + 1], options.memory)) 
+            {
+                cerr << "Unknown memory profile: " << argv[i + 1] << "\n";
+                return false;
+            }
+        }
+        else 
+        {
+            cerr << "Unknown option: " << flag << "\n";
+            return false;
+        }
+    }
+    // Pipelined stages keep their own state, which a warm state can't seed
+    if (options.pipeline.enabled() && !options.warm_state.empty()) 
+    {
+        cerr << "--warm-state can't be combined with --pipeline\n";
+        return false;
+    }
+    return true;
+}
+
+static int run_realtime_mode(const RealtimeOptions& options = {}) {
     try {
         RealtimeDenoiser denoiser;
         
-        // Load model
+        // Load and warm up the model in the background while the sound
+        // backend is connected and devices are probed and opened; audio
+        // passes through until it is ready
         const string model = "../assets/models/DeepFilterNetV3.onnx";
-        if (!denoiser.loadModel(model)) 
+        denoiser.setMemoryProfile(options.memory);
+        if (!options.warm_state.empty()) 
+        {
+            denoiser.setWarmState(warm_state_path(options.warm_state));
+        }
+        denoiser.setPipeline(options.pipeline);
+        if (!denoiser.loadModelAsync(model, options.hops)) 
         {
             return 1;
         }
@@ -156,6 +768,41 @@ static int run_realtime_mode() {
             denoiser.enableMonitoring(true);
         }
         
+        // Publish to other local processes
+        if (!options.shm_name.empty() && !denoiser.enableSharedOutput(options.shm_name)) 
+        {
+            return 1;
+        }
+        
+        // Runtime parameter control while streaming
+        if (!options.control_socket.empty() && !denoiser.enableControlSocket(options.control_socket)) 
+        {
+            return 1;
+        }
+        
+        if (!options.graph.empty() && !denoiser.setGraph(options.graph)) 
+        {
+            return 1;
+        }
+        
+        // Timeline of every hop, written out a second after any glitch
+        if (!options.trace_dir.empty()) 
+        {
+            Tracer::instance().enableAnomalyDumps(options.trace_dir);
+        }
+        
+        // Spectral gate instead of, or as a fallback for, the model
+        if (!options.engine.empty() && !denoiser.setEngineMode(options.engine)) 
+        {
+            return 1;
+        }
+        
+        // Input and output of the session, written off the audio thread
+        if (!options.record_prefix.empty() && !denoiser.startRecording(options.record_prefix)) 
+        {
+            return 1;
+        }
+        
         // Initialize and start
         if (!denoiser.initialize()) 
         {
@@ -219,30 +866,1180 @@ static int run_mic_test() {
     return 0;
 }
 
-static int run_audio_reader_test(const string& in_path, const string& out_path) {
-    try 
+static volatile std::sig_atomic_t monitor_running = 1;
+
+// Example consumer: follows a shared output ring and reports its health
+static int run_shm_monitor(const string& shm_name) {
+    ShmRingReader reader;
+    if (!reader.open(shm_name)) 
     {
-        AudioFile audio;
-        AudioIO::load(in_path, audio);
-        AudioUtils::normalize(audio);
-        AudioIO::save(out_path, audio);
-        return 0;
-    } catch (const exception& e) {
-        cerr << "Audio Reader error: " << e.what() << "\n";
         return 1;
     }
+    
+    cout << "Following " << shm_name << " (" << reader.sampleRate() << " Hz, "
+         << reader.frameSize() << " samples/frame). Press Ctrl+C to stop\n";
+    std::signal(SIGINT, [](int) { monitor_running = 0; });
+    
+    vector<int16_t> frame(reader.frameSize());
+    ShmFrameView view;
+    uint64_t frames = 0;
+    double latency_sum_ms = 0.0;
+    float peak = 0.0f;
+    auto last_report = std::chrono::steady_clock::now();
+    
+    while (monitor_running) 
+    {
+        if (!reader.readCopy(frame.data(), view)) 
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        } 
+        else 
+        {
+            auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            latency_sum_ms += (now_ns - static_cast<int64_t>(view.timestamp_ns)) / 1e6;
+            for (int16_t s : frame) 
+            {
+                peak = std::max(peak, std::abs(s) / 32768.0f);
+            }
+            frames++;
+        }
+        
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= std::chrono::seconds(1)) 
+        {
+            cout << "seq " << view.seq << " | frames/s " << frames
+                 << " | dropped " << reader.dropped()
+                 << " | avg delay " << (frames ? latency_sum_ms / frames : 0.0) << " ms"
+                 << " | peak " << peak << "\n";
+            frames = 0;
+            latency_sum_ms = 0.0;
+            peak = 0.0f;
+            last_report = now;
+        }
+    }
+    
+    return 0;
 }
 
-int main(int argc, char* argv[]) {
-    if (argc == 3) 
+static int run_daemon_mode(const string& socket_path, int workers, int max_clients, const MemoryProfile& memory,
+                           const string& warm_state) {
+    DenoiseServer server;
+    
+    const string model = "../assets/models/DeepFilterNetV3.onnx";
+    if (!server.loadModel(model, memory)) 
     {
-        // File mode: ./NeuralMic input.wav output.wav
-        return run_file_mode(argv[1], argv[2]);
-    } 
-    else if (argc == 2 && string(argv[1]) == "--realtime") 
+        return 1;
+    }
+    if (!warm_state.empty() && !server.loadWarmState(warm_state_path(warm_state))) 
+    {
+        return 1;
+    }
+    if (!server.start(socket_path, workers, max_clients)) 
+    {
+        return 1;
+    }
+    
+    server.run();
+    return 0;
+}
+
+struct MultiMicOptions {
+    vector<int> mics;        // --mics 0,2,3 (prompted for if empty)
+    int workers = 0;         // --workers <N>, defaults to the core count
+    string shm_prefix;       // --shm <prefix>: stream i publishes to <prefix>i
+    float strength = -75.0f; // --strength <dB>, -100 to 0
+    MemoryProfile memory;    // --memory default|low[:MiB]
+    string warm_state;       // --warm-state <name|path>
+};
+
+static bool parse_mic_list(const string& list, vector<int>& mics) {
+    size_t start = 0;
+    while (start <= list.size()) 
+    {
+        size_t comma = list.find(',', start);
+        string item = list.substr(start, comma == string::npos ? string::npos : comma - start);
+        int mic = 0;
+        if (item.empty() || !parse_int(item.c_str(), mic)) return false;
+        mics.push_back(mic);
+        if (comma == string::npos) break;
+        start = comma + 1;
+    }
+    return !mics.empty();
+}
+
+static bool parse_multi_mic_options(int argc, char* argv[], int first, MultiMicOptions& options) {
+    for (int i = first; i < argc; i += 2) 
+    {
+        string flag = argv[i];
+        if (i + 1 >= argc) 
+        {
+            cerr << "Missing value for " << flag << "\n";
+            return false;
+        }
+        
+        if (flag == "--workers") 
+        {
+            if (!parse_int(argv[i + 1], options.workers)) return false;
+        }
+        else if (flag == "--shm") options.shm_prefix = argv[i + 1];
+        else if (flag == "--strength") 
+        {
+            if (!parse_float(argv[i + 1], options.strength)) return false;
+        }
+        else if (flag == "--warm-state") options.warm_state = argv[i + 1];
+        else if (flag == "--mics") 
+        {
+            if (!parse_mic_list(argv[i + 1], options.mics)) 
+            {
+                cerr << "Invalid microphone list: " << argv[i + 1] << "\n";
+                return false;
+            }
+        }
+        else if (flag == "--memory") 
+        {
+            if (!MemoryProfile::Parse(argv[i + 1], options.memory)) 
+            {
+                cerr << "Unknown memory profile: " << argv[i + 1] << "\n";
+                return false;
+            }
+        }
+        else 
+        {
+            cerr << "Unknown option: " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static int run_multi_mic_mode(MultiMicOptions options) {
+    MultiMicEngine engine;
+    const string model = "../assets/models/DeepFilterNetV3.onnx";
+    int workers = options.workers > 0 ? options.workers : static_cast<int>(std::thread::hardware_concurrency());
+    if (!engine.loadModel(model, workers, options.memory)) 
+    {
+        return 1;
+    }
+    if (!options.warm_state.empty() && !engine.loadWarmState(warm_state_path(options.warm_state))) 
+    {
+        return 1;
+    }
+    engine.setNoiseSuppressionStrength(options.strength);
+    
+    auto mics = engine.listMicrophones();
+    if (mics.empty()) 
+    {
+        cerr << "No microphones found!\n";
+        return 1;
+    }
+    
+    if (options.mics.empty()) 
+    {
+        cout << "\nAvailable microphones:\n";
+        for (size_t i = 0; i < mics.size(); ++i) 
+        {
+            cout << "  [" << i << "] " << mics[i] << "\n";
+        }
+        cout << "Select microphones (comma-separated, e.g. 0,1,2): ";
+        string line;
+        std::getline(std::cin, line);
+        if (!parse_mic_list(line, options.mics)) 
+        {
+            cerr << "Invalid microphone list\n";
+            return 1;
+        }
+    }
+    
+    for (int index : options.mics) 
+    {
+        if (!engine.addMicrophone(index)) 
+        {
+            return 1;
+        }
+    }
+    
+    if (!options.shm_prefix.empty()) 
+    {
+        engine.enableSharedOutput(options.shm_prefix);
+    }
+    
+    if (!engine.initialize()) 
+    {
+        return 1;
+    }
+    engine.run();
+    return 0;
+}
+
+static int run_multi_mic_benchmark(int workers, int seconds, int max_streams) {
+    MultiMicEngine engine;
+    const string model = "../assets/models/DeepFilterNetV3.onnx";
+    if (!engine.loadModel(model, workers)) 
+    {
+        return 1;
+    }
+    return engine.benchmarkStreams(seconds, max_streams);
+}
+
+// Throughput of K-hop inference calls against single-hop calls on this
+// machine. Entries are "model.onnx[:K]"; K defaults to what the export fixes.
+static int run_hop_benchmark(int argc, char* argv[], int first) {
+    const int seconds = 10;
+    
+    // Same signal for every entry: a tone under white noise
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    vector<float> signal(seconds * DeepFilterNet::SAMPLE_RATE);
+    for (size_t i = 0; i < signal.size(); ++i) 
+    {
+        signal[i] = 0.2f * std::sin(2.0f * static_cast<float>(M_PI) * 300.0f * i / DeepFilterNet::SAMPLE_RATE) + noise(rng);
+    }
+    std::span<const float> warmup(signal.data(), DeepFilterNet::SAMPLE_RATE);
+    vector<float> enhanced(signal.size());   // allocated once, outside the timing
+    
+    struct Result { string name; int hops; double seconds; };
+    vector<Result> results;
+    
+    for (int i = first; i < argc; ++i) 
+    {
+        string entry = argv[i];
+        size_t colon = entry.rfind(':');
+        string path = colon == string::npos ? entry : entry.substr(0, colon);
+        int hops = 0;
+        if (colon != string::npos && !parse_hops(entry.substr(colon + 1).c_str(), hops)) 
+        {
+            return 1;
+        }
+        
+        try 
+        {
+            DeepFilterNet model(path, hops);
+            model.ApplyNoiseSuppression(warmup, std::span<float>(enhanced).first(warmup.size()));
+            model.reset();
+            
+            auto t0 = std::chrono::steady_clock::now();
+            model.ApplyNoiseSuppression(std::span<const float>(signal), std::span<float>(enhanced));
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            results.push_back({entry, model.HopsPerRun(), elapsed});
+        } catch (const exception& e) 
+        {
+            cerr << entry << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    
+    if (results.empty()) return 1;
+    
+    const double hops_total = static_cast<double>(signal.size()) / DeepFilterNet::HOP_SIZE;
+    cout << "\n=== Hops per Run (" << seconds << " s of audio) ===\n";
+    for (const auto& r : results) 
+    {
+        cout << "  " << r.name << " (K=" << r.hops << "): "
+             << r.seconds * 1e6 / hops_total << " us/hop, "
+             << seconds / r.seconds << "x realtime, "
+             << results.front().seconds / r.seconds << "x vs first, "
+             << "+" << (r.hops - 1) * 10 << " ms streaming latency\n";
+    }
+    return 0;
+}
+
+// Where the time inside Run() goes: N hops of speech-like input with ORT
+// profiling on, then the profile read back into per-op-type and per-node
+// tables against the 10 ms hop budget
+static int run_op_profile(int hops, int hops_per_run) {
+    try 
+    {
+        const string model_path = "../assets/models/DeepFilterNetV3.onnx";
+        DeepFilterNet model(model_path, hops_per_run, {}, "neuralmic-ops");
+        
+        std::mt19937 rng(1234);
+        std::normal_distribution<float> noise(0.0f, 0.05f);
+        vector<float> frame(DeepFilterNet::HOP_SIZE);
+        for (int h = 0; h < hops; ++h) 
+        {
+            for (size_t i = 0; i < frame.size(); ++i) 
+            {
+                size_t n = static_cast<size_t>(h) * frame.size() + i;
+                frame[i] = 0.2f * std::sin(2.0f * static_cast<float>(M_PI) * 300.0f * n / DeepFilterNet::SAMPLE_RATE) + noise(rng);
+            }
+            // AllocTracker only attributes allocations inside a realtime section
+            RealtimeScope realtime("op-profile hop");
+            model.ProcessRealtimeFrame(frame.data(), frame.data());
+        }
+        
+        string profile_path = model.EndProfiling();
+        cout << "Profile written to " << profile_path << "\n";
+        
+        // The first run is the constructor's warm-up
+        OrtProfileSummary summary;
+        if (!loadOrtProfile(profile_path, 1, summary)) 
+        {
+            return 1;
+        }
+        summary.print(summary.runs * model.HopsPerRun());
+        
+        if (AllocTracker::enabled()) 
+        {
+            AllocTracker::printReport();
+        }
+        return 0;
+        
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// Level of the quietest tenth of 20 ms frames, i.e. the noise floor
+static double noise_floor_db(const vector<float>& audio) {
+    const size_t frame = DeepFilterNet::SAMPLE_RATE / 50;
+    vector<double> levels;
+    for (size_t i = 0; i + frame <= audio.size(); i += frame) 
+    {
+        double energy = 0.0;
+        for (size_t j = i; j < i + frame; ++j) energy += static_cast<double>(audio[j]) * audio[j];
+        levels.push_back(10.0 * std::log10(energy / frame + 1e-12));
+    }
+    if (levels.empty()) return -120.0;
+    std::nth_element(levels.begin(), levels.begin() + levels.size() / 10, levels.end());
+    return levels[levels.size() / 10];
+}
+
+// Per-hop cost on the audio thread's critical path, the full model run
+// serially against the same model split into pipelined stages. Hops are
+// paced at real time as a device would deliver them, and the pipelined
+// output is checked against the serial one, a hop later.
+static int run_pipeline_benchmark(const string& spec, int seconds) {
+    if (!PipelineConfig::Available()) 
+    {
+        cerr << "Pipelined stages not built in (configure with -DNEURALMIC_STAGE_PIPELINE=ON)\n";
+        return 1;
+    }
+    PipelineConfig config;
+    if (!PipelineConfig::Parse(spec, config)) 
+    {
+        cerr << "Invalid pipeline: " << spec << " (stage1.onnx,stage2.onnx[@cpu1,cpu2])\n";
+        return 1;
+    }
+    
+    const size_t hop = DeepFilterNet::HOP_SIZE;
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    vector<float> signal(static_cast<size_t>(seconds) * DeepFilterNet::SAMPLE_RATE / hop * hop);
+    for (size_t i = 0; i < signal.size(); ++i) 
+    {
+        signal[i] = 0.2f * std::sin(2.0f * static_cast<float>(M_PI) * 300.0f * i / DeepFilterNet::SAMPLE_RATE) + noise(rng);
+    }
+    
+    struct Result { const char* name; vector<float> output; vector<uint64_t> call_ns; };
+    vector<Result> results;
+    
+    try 
+    {
+        const string model_path = "../assets/models/DeepFilterNetV3.onnx";
+        DeepFilterNet serial(model_path, 1);
+        DeepFilterNet pipelined(model_path, 1);
+        pipelined.EnablePipeline(config);
+        
+        for (DeepFilterNet* model : {&serial, &pipelined}) 
+        {
+            Result result{model == &serial ? "serial" : "pipelined", vector<float>(signal.size()), {}};
+            result.call_ns.reserve(signal.size() / hop);
+            model->reset();
+            
+            auto next = std::chrono::steady_clock::now();
+            for (size_t pos = 0; pos < signal.size(); pos += hop) 
+            {
+                std::this_thread::sleep_until(next);
+                next += std::chrono::microseconds(1000000 * hop / DeepFilterNet::SAMPLE_RATE);
+                
+                auto t0 = std::chrono::steady_clock::now();
+                model->ProcessRealtimeFrame(signal.data() + pos, result.output.data() + pos);
+                result.call_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - t0).count());
+            }
+            results.push_back(std::move(result));
+        }
+        
+        cout << "\n=== Pipelined Model (" << seconds << " s, paced) ===\n";
+        const double budget_ns = 1e9 * hop / DeepFilterNet::SAMPLE_RATE;
+        for (Result& r : results) 
+        {
+            vector<uint64_t> sorted = r.call_ns;
+            std::sort(sorted.begin(), sorted.end());
+            double avg = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+            size_t over = std::count_if(sorted.begin(), sorted.end(), [&](uint64_t ns) { return ns > budget_ns; });
+            cout << "  " << r.name << ": " << avg / 1000.0 << " us avg, "
+                 << sorted[sorted.size() * 99 / 100] / 1000.0 << " us p99, "
+                 << sorted.back() / 1000.0 << " us max, "
+                 << over << " of " << sorted.size() << " hops over budget\n";
+        }
+        pipelined.Pipeline()->printStats();
+        
+        // Same model split in two should give the same audio, one hop later
+        AudioDiff diff = compareAudio(results[0].output.data(), results[1].output.data() + hop, signal.size() - hop);
+        cout << "\n  " << (diff.snr_db >= 60.0 ? "✓" : "✗") << " pipelined vs serial: SNR " << diff.snr_db
+             << " dB, max err " << diff.max_abs_error << "\n";
+        return diff.snr_db >= 60.0 ? 0 : 1;
+    } catch (const exception& e) 
+    {
+        cerr << "Pipeline benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// Runs the start of a recording through the model and saves the state it
+// converges to, for --warm-state. Captures from speech in typical noise
+// make good starting points for live input.
+static int run_state_capture(const string& in_path, const string& spec, double seconds) {
+    try 
+    {
+        AudioFile input;
+        AudioIO::load(in_path, input);
+        // The model takes mono; interleaved stereo would also halve `seconds`
+        input = AudioUtils::stereoToMono(std::move(input));
+        size_t count = std::min(input.samples.size(), static_cast<size_t>(seconds * DeepFilterNet::SAMPLE_RATE));
+        vector<float> audio(count);
+        std::transform(input.samples.begin(), input.samples.begin() + count, audio.begin(),
+                       [](int16_t s) { return s / 32768.0f; });
+        
+        const string model_path = "../assets/models/DeepFilterNetV3.onnx";
+        DeepFilterNet model(model_path, 1);
+        model.SetNoiseSuppressionStrength(0.0f);
+        StreamState state = model.CaptureState(audio);
+        
+        string path = warm_state_path(spec);
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) std::filesystem::create_directories(parent);
+        state.save(path);
+        
+        cout << "✓ Captured state after " << static_cast<double>(count) / DeepFilterNet::SAMPLE_RATE
+             << " s of " << in_path << " -> " << path << " ("
+             << std::filesystem::file_size(path) / 1024 << " KiB)\n";
+        return 0;
+    } catch (const exception& e) 
+    {
+        cerr << "State capture failed: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// Stream handoff: one instance streams the first part of the file, saves
+// its state mid-stream, and a fresh instance restores it and streams the
+// rest. The output must match an uninterrupted run bit for bit. The split
+// falls on an odd hop, so K > 1 also hands over hops queued for a run.
+static int run_state_handoff_check(const string& in_path) {
+    const string model_path = "../assets/models/DeepFilterNetV3.onnx";
+    if (!std::filesystem::exists(model_path)) 
+    {
+        // CTest reads 77 as skipped rather than failed
+        cerr << "✗ Model not found: " << model_path << ", skipping handoff check\n";
+        return 77;
+    }
+    
+    try 
+    {
+        AudioFile input;
+        AudioIO::load(in_path, input);
+        input = AudioUtils::stereoToMono(std::move(input));
+        const size_t hop = DeepFilterNet::HOP_SIZE;
+        const size_t hops = input.samples.size() / hop;
+        if (hops < 8) 
+        {
+            cerr << "✗ " << in_path << " is too short for a handoff check\n";
+            return 1;
+        }
+        vector<float> audio(hops * hop);
+        std::transform(input.samples.begin(), input.samples.begin() + audio.size(), audio.begin(),
+                       [](int16_t s) { return s / 32768.0f; });
+        const size_t split = hops / 2 | 1;
+        
+        cout << "\n=== State Handoff (" << in_path << ", split at hop " << split << ") ===\n";
+        bool all_passed = true;
+        for (int k : {1, 4}) 
+        {
+            std::unique_ptr<DeepFilterNet> uninterrupted;
+            try 
+            {
+                uninterrupted = std::make_unique<DeepFilterNet>(model_path, k);
+            } catch (const exception& e) 
+            {
+                cout << "  K=" << k << ": skipped (" << e.what() << ")\n";
+                continue;
+            }
+            DeepFilterNet first(model_path, k);
+            DeepFilterNet second(model_path, k);
+            
+            vector<float> expected(audio.size());
+            vector<float> actual(audio.size());
+            for (size_t h = 0; h < hops; ++h) 
+            {
+                uninterrupted->ProcessRealtimeFrame(audio.data() + h * hop, expected.data() + h * hop);
+            }
+            for (size_t h = 0; h < split; ++h) 
+            {
+                first.ProcessRealtimeFrame(audio.data() + h * hop, actual.data() + h * hop);
+            }
+            std::stringstream checkpoint;
+            first.SaveState(checkpoint);
+            second.RestoreState(checkpoint);
+            for (size_t h = split; h < hops; ++h) 
+            {
+                second.ProcessRealtimeFrame(audio.data() + h * hop, actual.data() + h * hop);
+            }
+            
+            size_t mismatched = 0;
+            for (size_t i = 0; i < audio.size(); ++i) 
+            {
+                if (std::memcmp(&expected[i], &actual[i], sizeof(float)) != 0) ++mismatched;
+            }
+            bool passed = mismatched == 0;
+            all_passed = all_passed && passed;
+            cout << "  " << (passed ? "✓" : "✗") << " K=" << k << ": " << checkpoint.str().size() / 1024
+                 << " KiB checkpoint, " << mismatched << " of " << audio.size() << " samples differ\n";
+        }
+        return all_passed ? 0 : 1;
+    } catch (const exception& e) 
+    {
+        cerr << "Handoff check failed: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// CPU cost and output of each engine hop by hop over the same file, the
+// gate compared against the model's output since there is no clean reference
+static int run_gate_benchmark(const string& in_path) {
+    try 
+    {
+        AudioFile input;
+        AudioIO::load(in_path, input);
+        vector<float> samples(input.samples.size());
+        std::transform(input.samples.begin(), input.samples.end(), samples.begin(),
+                       [](int16_t s) { return s / 32768.0f; });
+        
+        const string model_path = "../assets/models/DeepFilterNetV3.onnx";
+        DeepFilterNet model(model_path, 1);
+        SpectralGate gate;
+        NoiseSuppressor* engines[] = {&model, &gate};
+        
+        struct Result { const char* name; double cpu_us_per_hop; vector<float> output; };
+        vector<Result> results;
+        
+        const size_t hop = DeepFilterNet::HOP_SIZE;
+        for (NoiseSuppressor* engine : engines) 
+        {
+            engine->reset();
+            engine->SetNoiseSuppressionStrength(0.0f);
+            const size_t delay = engine->StreamLatency();
+            size_t hops = (samples.size() + delay + hop - 1) / hop;
+            vector<float> padded(hops * hop, 0.0f);
+            std::copy(samples.begin(), samples.end(), padded.begin());
+            
+            // Thread CPU time, so a busy machine doesn't inflate the figure
+            timespec t0, t1;
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+            for (size_t i = 0; i < padded.size(); i += hop) 
+            {
+                engine->ProcessRealtimeFrame(padded.data() + i, padded.data() + i);
+            }
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+            double cpu_us = (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3;
+            
+            padded.erase(padded.begin(), padded.begin() + delay);
+            padded.resize(samples.size());
+            results.push_back({engine->EngineName(), cpu_us / hops, std::move(padded)});
+        }
+        
+        const double hop_us = 1e6 * hop / DeepFilterNet::SAMPLE_RATE;
+        const double floor_in = noise_floor_db(samples);
+        cout << "\n=== Engines on " << in_path << " (" << samples.size() / hop << " hops) ===\n";
+        cout << "  input noise floor: " << floor_in << " dBFS\n";
+        for (const Result& r : results) 
+        {
+            cout << "  " << r.name << ": " << r.cpu_us_per_hop << " us/hop CPU ("
+                 << 100.0 * r.cpu_us_per_hop / hop_us << "% of one core), noise floor "
+                 << noise_floor_db(r.output) - floor_in << " dB\n";
+        }
+        
+        AudioDiff diff = compareAudio(results[0].output.data(), results[1].output.data(), samples.size());
+        cout << "  gate vs model: SNR " << diff.snr_db << " dB, LSD " << diff.lsd_db
+             << " dB, cost " << results[1].cpu_us_per_hop / results[0].cpu_us_per_hop * 100.0 << "% of the model\n";
+        return 0;
+        
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// FLAC encode speed at 1..N threads on a file looped to a minute, to check
+// the archive writer keeps up with batch denoising
+static int run_flac_benchmark(const string& in_path, int max_threads) {
+    try 
+    {
+        AudioFile source;
+        AudioIO::load(in_path, source);
+        if (source.samples.empty()) 
+        {
+            cerr << "Empty input\n";
+            return 1;
+        }
+        
+        AudioFile audio = source;
+        while (audio.getDuration() < 60.0) 
+        {
+            audio.samples.insert(audio.samples.end(), source.samples.begin(), source.samples.end());
+        }
+        
+        const string out_path = (std::filesystem::temp_directory_path() / "neuralmic-bench.flac").string();
+        const double wav_bytes = audio.samples.size() * 2.0;
+        
+        cout << "\n=== FLAC Encode (" << audio.getDuration() << " s, " << audio.sampleRate << " Hz, "
+             << audio.channels << " ch) ===\n";
+        for (int threads = 1; threads <= max_threads; threads *= 2) 
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            FlacWriter writer(out_path, audio.sampleRate, audio.channels, threads);
+            writer.write(audio.samples.data(), audio.samples.size());
+            writer.close();
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            
+            double speed = audio.getDuration() / elapsed;
+            cout << "  " << threads << " thread(s): " << speed << "x realtime, "
+                 << speed / threads << "x per core, "
+                 << 100.0 * writer.bytesWritten() / wav_bytes << "% of WAV size\n";
+        }
+        std::filesystem::remove(out_path);
+        return 0;
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+// Loads N independent model instances under one profile and reports what
+// each one costs, to size how many fit on a machine
+static int run_memory_test(int instances, const MemoryProfile& memory) {
+    if (instances < 1) 
+    {
+        cerr << "Need at least one instance\n";
+        return 1;
+    }
+    const string model = "../assets/models/DeepFilterNetV3.onnx";
+    size_t rss_start = residentBytes();
+    
+    vector<std::unique_ptr<DeepFilterNet>> models;
+    try 
+    {
+        for (int i = 0; i < instances; ++i) 
+        {
+            models.push_back(std::make_unique<DeepFilterNet>(model, 0, memory));
+        }
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    // Run a second of audio through each so arenas reach their working size
+    vector<float> frame(DeepFilterNet::HOP_SIZE, 0.0f);
+    for (auto& m : models) 
+    {
+        for (int i = 0; i < 100; ++i) 
+        {
+            m->ProcessRealtimeFrame(frame.data(), frame.data());
+        }
+    }
+    size_t rss_busy = residentBytes();
+    
+    for (auto& m : models) 
+    {
+        m->ReleaseIdleMemory();
+    }
+    size_t rss_idle = residentBytes();
+    
+    MemoryReport report;
+    for (size_t i = 0; i < models.size(); ++i) 
+    {
+        ModelMemoryUsage usage = models[i]->GetMemoryUsage();
+        string name = "instance " + std::to_string(i);
+        report.add(name + " model", usage.model_bytes, true);
+        report.add(name + " arena", usage.arena_bytes, true);
+        report.add(name + " state", usage.state_bytes);
+    }
+    report.print("Memory test");
+    
+    const double mib = 1024.0 * 1024.0;
+    // RSS can drop below the starting point (pages reclaimed meanwhile), so clamp at 0
+    cout << "  Per instance: " << (std::max(rss_busy, rss_start) - rss_start) / mib / instances << " MiB streaming, "
+         << (std::max(rss_idle, rss_start) - rss_start) / mib / instances << " MiB after idle release\n";
+    return 0;
+}
+
+// Feeds a file hop by hop through the realtime processing path with every
+// hop marked as a realtime section. Fails if anything on our side of that
+// path touches the heap; needs a -DNEURALMIC_ALLOC_TRACKING=ON build.
+static int run_alloc_check(const string& in_path, const FileOptions& options, bool abort_on_alloc) {
+    if (!AllocTracker::enabled()) 
+    {
+        AllocTracker::printReport();
+        return 1;
+    }
+    AllocTracker::setPolicy(abort_on_alloc ? AllocPolicy::Abort : AllocPolicy::Report);
+    
+    const string model_path = "../assets/models/DeepFilterNetV3.onnx";
+    if (options.engine != "gate" && !std::filesystem::exists(model_path)) 
+    {
+        // CTest reads 77 as skipped rather than failed
+        cerr << "✗ Model not found: " << model_path << ", skipping allocation check\n";
+        return 77;
+    }
+    
+    try 
+    {
+        auto denoiser = make_engine(options);
+        
+        AudioFile audio;
+        AudioIO::load(in_path, audio);
+        
+        ProcessingGraph graph;
+        buildGraph(options.graph, graph, std::make_unique<DenoiserStage>(*denoiser));
+        graph.prepare(DeepFilterNet::SAMPLE_RATE, DeepFilterNet::HOP_SIZE);
+        graph.reset();
+        
+        vector<float> frame(DeepFilterNet::HOP_SIZE);
+        size_t hops = audio.samples.size() / DeepFilterNet::HOP_SIZE;
+        cout << "Checking " << hops << " hops through " << options.graph << "...\n";
+        
+        for (size_t h = 0; h < hops; ++h) 
+        {
+            RealtimeScope realtime("alloc-check hop");
+            const int16_t* in = audio.samples.data() + h * DeepFilterNet::HOP_SIZE;
+            for (size_t i = 0; i < frame.size(); ++i) 
+            {
+                frame[i] = in[i] / 32768.0f;
+            }
+            graph.process(frame.data(), frame.size());
+        }
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    
+    AllocTracker::printReport();
+    if (AllocTracker::violations() > 0) 
+    {
+        cerr << "✗ " << AllocTracker::violations() << " allocation(s) on the realtime path\n";
+        return 1;
+    }
+    cout << "✓ No allocations on the realtime path\n";
+    return 0;
+}
+
+// Golden-output check: the reference file through every processing path we
+// ship, compared against a known-good output. Each mode has its own
+// tolerance since they differ by design (int16 round trip, chunk warm-up).
+struct GoldenMode {
+    const char* name;
+    double min_snr_db;
+    double max_lsd_db;
+    double max_abs_error;
+};
+
+static const GoldenMode GOLDEN_MODES[] = {
+    {"offline",   40.0, 1.0, 0.002},
+    {"realtime",  40.0, 1.0, 0.002},   // hop by hop, int16 in and out
+    {"parallel",  20.0, 2.0, 0.25},    // chunks on threads, 1 s warm-up each
+};
+
+// Hop by hop the way RealtimeDenoiser runs it, with the stream delay removed
+static vector<float> golden_realtime(DeepFilterNet& model, const vector<int16_t>& input) {
+    const size_t hop = DeepFilterNet::HOP_SIZE;
+    const size_t delay = model.StreamLatency();
+    size_t hops = (input.size() + delay + hop - 1) / hop;
+    
+    vector<float> output;
+    output.reserve(hops * hop);
+    vector<float> frame(hop);
+    
+    for (size_t h = 0; h < hops; ++h) 
+    {
+        for (size_t i = 0; i < hop; ++i) 
+        {
+            size_t n = h * hop + i;
+            frame[i] = n < input.size() ? input[n] / 32768.0f : 0.0f;
+        }
+        model.ProcessRealtimeFrame(frame.data(), frame.data());
+        for (float s : frame) 
+        {
+            output.push_back(std::clamp(s * 32767.0f, -32768.0f, 32767.0f) / 32768.0f);
+        }
+    }
+    
+    output.erase(output.begin(), output.begin() + delay);
+    output.resize(input.size());
+    return output;
+}
+
+// Contiguous chunks on worker threads against one shared session. Each
+// chunk starts its own state a second early and discards that warm-up.
+static vector<float> golden_parallel(DeepFilterNet& model, const vector<float>& input, int threads) {
+    const size_t hop = DeepFilterNet::HOP_SIZE;
+    const size_t delay = DeepFilterNet::FFT_SIZE - DeepFilterNet::HOP_SIZE;
+    const size_t warmup_hops = DeepFilterNet::SAMPLE_RATE / hop;
+    
+    vector<float> padded = input;
+    padded.resize((input.size() + delay + hop - 1) / hop * hop, 0.0f);
+    vector<float> enhanced(padded.size());
+    size_t hops = padded.size() / hop;
+    size_t chunk = (hops + threads - 1) / threads;
+    
+    vector<std::thread> workers;
+    for (size_t first = 0; first < hops; first += chunk) 
+    {
+        workers.emplace_back([&, first] {
+            size_t last = std::min(first + chunk, hops);
+            size_t start = first > warmup_hops ? first - warmup_hops : 0;
+            StreamState state = model.CreateStreamState();
+            vector<float> scratch(hop);
+            
+            for (size_t h = start; h < last; ++h) 
+            {
+                float* out = h < first ? scratch.data() : enhanced.data() + h * hop;
+                model.ProcessStreamFrame(padded.data() + h * hop, out, state);
+            }
+        });
+    }
+    for (auto& worker : workers) 
+    {
+        worker.join();
+    }
+    
+    return vector<float>(enhanced.begin() + delay, enhanced.begin() + delay + input.size());
+}
+
+static int run_golden_check(const string& in_path, const string& ref_path, const string& log_path) {
+    try 
+    {
+        AudioFile input;
+        AudioFile reference;
+        AudioIO::load(in_path, input);
+        AudioIO::load(ref_path, reference);
+        
+        vector<float> input_float(input.samples.size());
+        vector<float> reference_float(reference.samples.size());
+        std::transform(input.samples.begin(), input.samples.end(), input_float.begin(),
+                       [](int16_t s) { return s / 32768.0f; });
+        std::transform(reference.samples.begin(), reference.samples.end(), reference_float.begin(),
+                       [](int16_t s) { return s / 32768.0f; });
+        
+        const string model_path = "../assets/models/DeepFilterNetV3.onnx";
+        if (!std::filesystem::exists(model_path)) 
+        {
+            // CTest reads 77 as skipped rather than failed
+            cerr << "✗ Model not found: " << model_path << ", skipping golden check\n";
+            return 77;
+        }
+        DeepFilterNet model(model_path, 1);
+        model.SetNoiseSuppressionStrength(0.0f);
+        
+        const int threads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, 8);
+        const double duration = input.getDuration();
+        bool all_passed = true;
+        
+        std::ofstream log;
+        if (!log_path.empty()) 
+        {
+            bool fresh = !std::filesystem::exists(log_path);
+            log.open(log_path, std::ios::app);
+            if (fresh) log << "time\tmode\tseconds\trealtime_factor\tmax_abs_error\tsnr_db\tlsd_db\tpassed\n";
+        }
+        
+        cout << "\n=== Golden Output (" << in_path << " vs " << ref_path << ") ===\n";
+        for (const GoldenMode& mode : GOLDEN_MODES) 
+        {
+            model.reset();
+            
+            auto t0 = std::chrono::steady_clock::now();
+            vector<float> output;
+            string name = mode.name;
+            if (name == "offline") output = model.ApplyNoiseSuppression(input_float);
+            else if (name == "realtime") output = golden_realtime(model, input.samples);
+            else output = golden_parallel(model, input_float, threads);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            
+            size_t count = std::min(output.size(), reference_float.size());
+            AudioDiff diff = compareAudio(reference_float.data(), output.data(), count);
+            bool passed = count >= input_float.size() &&
+                          diff.snr_db >= mode.min_snr_db &&
+                          diff.lsd_db <= mode.max_lsd_db &&
+                          diff.max_abs_error <= mode.max_abs_error;
+            all_passed = all_passed && passed;
+            
+            cout << "  " << (passed ? "✓ " : "✗ ") << mode.name << ": "
+                 << "max err " << diff.max_abs_error << " (<= " << mode.max_abs_error << "), "
+                 << "SNR " << diff.snr_db << " dB (>= " << mode.min_snr_db << "), "
+                 << "LSD " << diff.lsd_db << " dB (<= " << mode.max_lsd_db << "), "
+                 << elapsed * 1000.0 << " ms, " << duration / elapsed << "x realtime\n";
+            if (count < input_float.size()) 
+            {
+                cout << "    compared " << count << " of " << input_float.size() << " samples\n";
+            }
+            
+            if (log) 
+            {
+                log << std::time(nullptr) << "\t" << mode.name << "\t" << elapsed << "\t" << duration / elapsed
+                    << "\t" << diff.max_abs_error << "\t" << diff.snr_db << "\t" << diff.lsd_db
+                    << "\t" << (passed ? 1 : 0) << "\n";
+            }
+        }
+        
+        return all_passed ? 0 : 1;
+    } catch (const exception& e) 
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+static int run_audio_reader_test(const string& in_path, const string& out_path) {
+    try 
+    {
+        AudioFile audio;
+        AudioIO::load(in_path, audio);
+        AudioUtils::normalize(audio);
+        AudioIO::save(out_path, audio);
+        return 0;
+    } catch (const exception& e) {
+        cerr << "Audio Reader error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && string(argv[1]).rfind("--", 0) != 0) 
+    {
+        // File mode: ./NeuralMic input.wav output.wav [--graph highpass,denoise,limiter] [--hops K] [--memory low] [--engine gate] [--warm-state name]
+        FileOptions options;
+        if (!parse_file_options(argc, argv, 3, options)) 
+        {
+            return 1;
+        }
+        return run_file_mode(argv[1], argv[2], options);
+    } 
+    else if (argc >= 4 && string(argv[1]) == "--stream") 
+    {
+        // Bounded-memory file mode: ./NeuralMic --stream input.mp3 output.mp3 [--graph spec] [--hops K] [--memory low] [--engine gate] [--warm-state name]
+        FileOptions options;
+        if (!parse_file_options(argc, argv, 4, options)) 
+        {
+            return 1;
+        }
+        return run_stream_mode(argv[2], argv[3], options);
+    }
+    else if (argc >= 3 && string(argv[1]) == "--pipe") 
+    {
+        // Pipe mode: ffmpeg -i in.mp3 -f s16le -ac 1 -ar 48000 - | ./NeuralMic --pipe s16le [--strength dB] [--hops K] [--memory low] [--warm-state name] | ...
+        PipeOptions options;
+        options.format = argv[2];
+        if (options.format != "s16le" && options.format != "f32le") 
+        {
+            cerr << "Unknown sample format: " << options.format << " (s16le or f32le)\n";
+            return 1;
+        }
+        if (!parse_pipe_options(argc, argv, 3, options)) 
+        {
+            return 1;
+        }
+        return run_pipe_mode(options);
+    }
+    else if (argc >= 2 && string(argv[1]) == "--realtime") 
+    {
+        // Real-time mode: ./NeuralMic --realtime [--shm /neuralmic] [--control /tmp/neuralmic.ctl] [--graph spec] [--hops K] [--memory low] [--trace dir] [--record prefix] [--engine auto] [--warm-state name] [--pipeline enc.onnx,dec.onnx@2,3 (needs -DNEURALMIC_STAGE_PIPELINE=ON)]
+        RealtimeOptions options;
+        if (!parse_realtime_options(argc, argv, 2, options)) 
+        {
+            return 1;
+        }
+        return run_realtime_mode(options);
+    }
+    else if (argc == 3 && string(argv[1]) == "--shm-monitor") 
+    {
+        // Shared output consumer: ./NeuralMic --shm-monitor /neuralmic
+        return run_shm_monitor(argv[2]);
+    }
+    else if (argc >= 3 && string(argv[1]) == "--daemon") 
+    {
+        // Multi-client daemon: ./NeuralMic --daemon /tmp/neuralmic.sock [workers] [max_clients] [--memory low] [--warm-state name]
+        MemoryProfile memory;
+        string warm_state;
+        while (argc >= 5 && string(argv[argc - 2]).rfind("--", 0) == 0) 
+        {
+            string flag = argv[argc - 2];
+            if (flag == "--memory") 
+            {
+                if (!MemoryProfile::Parse(argv[argc - 1], memory)) 
+                {
+                    cerr << "Unknown memory profile: " << argv[argc - 1] << "\n";
+                    return 1;
+                }
+            }
+            else if (flag == "--warm-state") warm_state = argv[argc - 1];
+            else 
+            {
+                cerr << "Unknown option: " << flag << "\n";
+                return 1;
+            }
+            argc -= 2;
+        }
+        int workers = static_cast<int>(std::thread::hardware_concurrency());
+        int max_clients = 64;
+        if ((argc >= 4 && !parse_int(argv[3], workers)) || (argc >= 5 && !parse_int(argv[4], max_clients))) 
+        {
+            return 1;
+        }
+        return run_daemon_mode(argv[2], workers, max_clients, memory, warm_state);
+    }
+    else if ((argc == 3 || argc == 4) && string(argv[1]) == "--memory-test") 
+    {
+        // Footprint per instance: ./NeuralMic --memory-test 8 [default|low[:MiB]]
+        MemoryProfile memory;
+        if (argc == 4 && !MemoryProfile::Parse(argv[3], memory)) 
+        {
+            cerr << "Unknown memory profile: " << argv[3] << "\n";
+            return 1;
+        }
+        int instances = 0;
+        if (!parse_int(argv[2], instances)) 
+        {
+            return 1;
+        }
+        return run_memory_test(instances, memory);
+    }
+    else if (argc == 5 && string(argv[1]) == "--daemon-load-test") 
+    {
+        // Daemon load test: ./NeuralMic --daemon-load-test /tmp/neuralmic.sock <clients> <seconds>
+        int clients = 0;
+        int seconds = 0;
+        if (!parse_int(argv[3], clients) || !parse_int(argv[4], seconds)) 
+        {
+            return 1;
+        }
+        return runDenoiseLoadTest(argv[2], clients, seconds);
+    }
+    else if (argc >= 2 && string(argv[1]) == "--multi-mic") 
+    {
+        // Several microphones at once: ./NeuralMic --multi-mic [--mics 0,1,2] [--workers N] [--shm /neuralmic] [--strength dB] [--memory low] [--warm-state name]
+        MultiMicOptions options;
+        if (!parse_multi_mic_options(argc, argv, 2, options)) 
+        {
+            return 1;
+        }
+        return run_multi_mic_mode(options);
+    }
+    else if (argc >= 2 && argc <= 5 && string(argv[1]) == "--multi-mic-bench") 
+    {
+        // Streams per core: ./NeuralMic --multi-mic-bench [workers] [seconds] [max_streams]
+        int workers = static_cast<int>(std::thread::hardware_concurrency());
+        int seconds = 5;
+        int max_streams = 64;
+        if ((argc >= 3 && !parse_int(argv[2], workers)) ||
+            (argc >= 4 && !parse_int(argv[3], seconds)) ||
+            (argc >= 5 && !parse_int(argv[4], max_streams))) 
+        {
+            return 1;
+        }
+        return run_multi_mic_benchmark(workers, seconds, max_streams);
+    }
+    else if (argc >= 2 && argc <= 4 && string(argv[1]) == "--bench-flac") 
+    {
+        // FLAC encoder speed: ./NeuralMic --bench-flac [input.wav] [max_threads]
+        string in_path = argc >= 3 ? argv[2] : "../assets/tests/input.wav";
+        int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (argc >= 4 && !parse_int(argv[3], max_threads)) 
+        {
+            return 1;
+        }
+        return run_flac_benchmark(in_path, std::max(1, max_threads));
+    }
+    else if (argc >= 3 && string(argv[1]) == "--bench-hops") 
+    {
+        // Multi-hop benchmark: ./NeuralMic --bench-hops model.onnx model_k4.onnx dynamic.onnx:8
+        return run_hop_benchmark(argc, argv, 2);
+    }
+    else if ((argc == 3 || argc == 4) && string(argv[1]) == "--profile-ops") 
+    {
+        // Per-operator profile: ./NeuralMic --profile-ops 1000 [K]
+        int hops = 0;
+        int hops_per_run = 0;
+        if (!parse_int(argv[2], hops) || (argc == 4 && !parse_hops(argv[3], hops_per_run))) 
+        {
+            return 1;
+        }
+        return run_op_profile(hops, hops_per_run);
+    }
+    else if (argc >= 3 && string(argv[1]) == "--alloc-check") 
+    {
+        // Realtime allocation check: ./NeuralMic --alloc-check input.wav [--abort] [--graph spec] [--hops K] [--memory low]
+        bool abort_on_alloc = argc >= 4 && string(argv[3]) == "--abort";
+        FileOptions options;
+        if (!parse_file_options(argc, argv, abort_on_alloc ? 4 : 3, options)) 
+        {
+            return 1;
+        }
+        return run_alloc_check(argv[2], options, abort_on_alloc);
+    }
+    else if ((argc == 3 || argc == 4) && string(argv[1]) == "--bench-pipeline") 
+    {
+        // Pipelined stages against the full model (needs -DNEURALMIC_STAGE_PIPELINE=ON): ./NeuralMic --bench-pipeline enc.onnx,dec.onnx[@2,3] [seconds]
+        int seconds = 10;
+        if (argc == 4 && !parse_int(argv[3], seconds)) 
+        {
+            return 1;
+        }
+        return run_pipeline_benchmark(argv[2], seconds);
+    }
+    else if ((argc == 4 || argc == 5) && string(argv[1]) == "--capture-state") 
+    {
+        // Warm state for --warm-state: ./NeuralMic --capture-state speech.wav office [seconds]
+        float seconds = 10.0f;
+        if (argc == 5 && !parse_float(argv[4], seconds)) 
+        {
+            return 1;
+        }
+        return run_state_capture(argv[2], argv[3], seconds);
+    }
+    else if ((argc == 2 || argc == 3) && string(argv[1]) == "--bench-gate") 
+    {
+        // Fallback engine against the model: ./NeuralMic --bench-gate [input.wav]
+        return run_gate_benchmark(argc == 3 ? argv[2] : "../assets/tests/input.wav");
+    }
+    else if (argc >= 2 && string(argv[1]) == "--golden") 
+    {
+        // Regression check: ./NeuralMic --golden [input.wav reference.wav] [--log results.tsv]
+        string in_path = "../assets/tests/input.wav";
+        string ref_path = "../assets/tests/output.wav";
+        string log_path;
+        if (argc >= 4 && string(argv[2]).rfind("--", 0) != 0) 
+        {
+            in_path = argv[2];
+            ref_path = argv[3];
+        }
+        if (argc >= 4 && string(argv[argc - 2]) == "--log") 
+        {
+            log_path = argv[argc - 1];
+        }
+        return run_golden_check(in_path, ref_path, log_path);
+    }
+    else if ((argc == 2 || argc == 3) && string(argv[1]) == "--check-handoff") 
     {
-        // Real-time mode: ./NeuralMic --realtime
-        return run_realtime_mode();
+        // Save/restore round trip: ./NeuralMic --check-handoff [input.wav]
+        return run_state_handoff_check(argc == 3 ? argv[2] : "../assets/tests/input.wav");
     }
     else if (argc == 2 && string(argv[1]) == "--test-mic") {
         // Microphone test mode: ./NeuralMic --test-mic